@@ -17,6 +17,8 @@
 #include "LensSolverBlueprintAPI.h"
 #include "LensCalibrator.h"
 #include "LensSolver.h"
+#include "LensSolverPipelineLatency.h"
+#include "DistortionCorrectionVolumePacker.h"
 
 /* This method allows you to perform calibration using a set of folders each containing sets of
 images representing the calibration pattern at each zoom level. */
@@ -65,6 +67,16 @@ void ULensSolverBlueprintAPI::GenerateDistortionCorrectionMap(
 		distortionCorrectionMapGenerationParams);
 }
 
+void ULensSolverBlueprintAPI::GenerateDistortionCorrectionMaps(
+	TScriptInterface<ILensSolverEventReceiver> eventReceiver,
+	TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams)
+{
+	UDistortionProcessor* distortionProcessor = FLensCalibratorModule::Get().GetDistortionProcessor();
+	distortionProcessor->GenerateDistortionCorrectionMaps(
+		eventReceiver,
+		distortionCorrectionMapGenerationParams);
+}
+
 void ULensSolverBlueprintAPI::DistortTextureWithTexture(
 	TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 	FDistortTextureWithTextureParams distortionCorrectionParams)
@@ -95,6 +107,18 @@ void ULensSolverBlueprintAPI::DistortTextureWithCoefficients(
 		distortionCorrectionParams);
 }
 
+bool ULensSolverBlueprintAPI::GenerateDistortionCorrectionMapsIntoVolumeTexture(
+	TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+	bool generateUncorrectionMaps,
+	UVolumeTexture * volumeTexture)
+{
+	UDistortionProcessor* distortionProcessor = FLensCalibratorModule::Get().GetDistortionProcessor();
+	return distortionProcessor->GenerateDistortionCorrectionMapsIntoVolumeTexture(
+		distortionCorrectionMapGenerationParams,
+		generateUncorrectionMaps,
+		volumeTexture);
+}
+
 bool ULensSolverBlueprintAPI::PackArrayOfDistortionCorrectionMapsIntoVolumeTexture(
 		TArray<UTexture2D*> distortionCorrectionMaps,
 		UVolumeTexture * volumeTexture)
@@ -124,7 +148,13 @@ bool ULensSolverBlueprintAPI::PackArrayOfDistortionCorrectionMapsIntoVolumeTextu
 	{
 		if (distortionCorrectionMaps[i] == nullptr)
 		{
-			UE_LOG(LogTemp, Error, TEXT("The texture at index: %d within the input array is NULL."));
+			UE_LOG(LogTemp, Error, TEXT("The texture at index: %d within the input array is NULL."), i);
+			return false;
+		}
+
+		if (distortionCorrectionMaps[i]->GetPixelFormat() != EPixelFormat::PF_FloatRGBA)
+		{
+			UE_LOG(LogTemp, Error, TEXT("All textures in the input array should be half float RGBA distortion correction maps, the texture at index: %d is not."), i);
 			return false;
 		}
 
@@ -142,22 +172,25 @@ bool ULensSolverBlueprintAPI::PackArrayOfDistortionCorrectionMapsIntoVolumeTextu
 
 	UE_LOG(LogTemp, Log, TEXT("Attempting to pack: %d textures of size: (%d, %d) into volume texture."), distortionCorrectionMaps.Num(), width, height);
 
-	TArray<FFloat16Color*> dataArray;
+#if WITH_EDITOR
+	uint32 start = FPlatformTime::Cycles();
+
+	TArray<const FFloat16Color*> dataArray;
 	dataArray.SetNum(distortionCorrectionMaps.Num());
 	for (int i = 0; i < distortionCorrectionMaps.Num(); i++)
-		dataArray[i] = reinterpret_cast<FFloat16Color*>(distortionCorrectionMaps[i]->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_ONLY));
+		dataArray[i] = reinterpret_cast<const FFloat16Color*>(distortionCorrectionMaps[i]->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_ONLY));
 
-	bool success = volumeTexture->UpdateSourceFromFunction([width, height, dataArray](int ix, int iy, int iz, void* value)
-	{
-		FFloat16* const voxel = static_cast<FFloat16*>(value);
-		const FFloat16Color * data = dataArray[/*dataArray.Num() - 1 - */iz];
+	/* The volume texture would otherwise be rebuilt from the 2D texture it was created from. */
+	volumeTexture->Source2DTexture = nullptr;
+	volumeTexture->Source.Init(width, height, distortionCorrectionMaps.Num(), 1, TSF_RGBA16F);
 
-		voxel[0] = data[iy * width + ix].R;
-		voxel[1] = data[iy * width + ix].G;
-		voxel[2] = FFloat16(0.0f);
-		voxel[3] = FFloat16(0.0f);
+	FFloat16Color * voxels = reinterpret_cast<FFloat16Color*>(volumeTexture->Source.LockMip(0));
+	bool success = voxels != nullptr && !dataArray.Contains(nullptr);
+	if (success)
+		DistortionCorrectionVolumePacker::PackSlices(dataArray, width, height, voxels);
 
-	}, width, height, distortionCorrectionMaps.Num(), TSF_RGBA16F);
+	if (voxels != nullptr)
+		volumeTexture->Source.UnlockMip(0);
 
 	for (int i = 0; i < distortionCorrectionMaps.Num(); i++)
 		distortionCorrectionMaps[i]->PlatformData->Mips[0].BulkData.Unlock();
@@ -168,10 +201,21 @@ bool ULensSolverBlueprintAPI::PackArrayOfDistortionCorrectionMapsIntoVolumeTextu
 		return false;
 	}
 
+	float packMilliseconds = FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - start);
+	UE_LOG(LogTemp, Log, TEXT("Packed: %d slices in %f milliseconds (%f slices/sec)."),
+		distortionCorrectionMaps.Num(),
+		packMilliseconds,
+		packMilliseconds > 0.0f ? distortionCorrectionMaps.Num() * 1000.0f / packMilliseconds : 0.0f);
+
+	volumeTexture->PostEditChange();
 	volumeTexture->MarkPackageDirty();
 	UE_LOG(LogTemp, Log, TEXT("Successfully packed volume texture with: %d textures."), distortionCorrectionMaps.Num());
 
 	return true;
+#else
+	UE_LOG(LogTemp, Error, TEXT("Unable to update VolumeTexture source, volume texture source data only exists in the editor."));
+	return false;
+#endif
 }
 
 void ULensSolverBlueprintAPI::OverrideCompositingMaterialScalarParam(
@@ -212,8 +256,26 @@ void ULensSolverBlueprintAPI::StartBackgroundImageProcessors(
 		shutDownWorkersAfterCompletingTasks);
 }
 
+void ULensSolverBlueprintAPI::StartTaskGraphImageProcessors(
+	bool shutDownWorkersAfterCompletingTasks)
+{
+	ULensSolver* lensSolver = FLensCalibratorModule::Get().GetLensSolver();
+	lensSolver->StartTaskGraphImageProcessors(shutDownWorkersAfterCompletingTasks);
+}
+
 void ULensSolverBlueprintAPI::StopBackgroundImageprocessors()
 {
 	ULensSolver* lensSolver = FLensCalibratorModule::Get().GetLensSolver();
 	lensSolver->StopBackgroundImageprocessors();
 }
+
+void ULensSolverBlueprintAPI::GetPipelineLatencySnapshot(
+	FPipelineLatencySnapshot & outputSnapshot)
+{
+	LensSolverPipelineLatency::Get().GetSnapshot(outputSnapshot);
+}
+
+void ULensSolverBlueprintAPI::ResetPipelineLatency()
+{
+	LensSolverPipelineLatency::Get().Reset();
+}
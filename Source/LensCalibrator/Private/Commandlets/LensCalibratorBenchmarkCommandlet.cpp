@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensCalibratorBenchmarkCommandlet.h"
+
+#include "Containers/Ticker.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "LensCalibrator.h"
+#include "LensSolver.h"
+#include "LensSolverUtilities.h"
+#include "LensSolverPipelineLatency.h"
+
+ULensCalibratorBenchmarkCommandlet::ULensCalibratorBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+
+	jobFinished = false;
+}
+
+void ULensCalibratorBenchmarkCommandlet::OnFinishedJob(const FJobInfo & jobInfo)
+{
+	finishedJobInfo = jobInfo;
+	jobFinished = true;
+}
+
+void ULensCalibratorBenchmarkCommandlet::OnCalibrationResult(const FCalibrationResult & calibrationResult)
+{
+	/* Provisional results are superseded by the final result of the same calibration. */
+	if (!calibrationResult.provisional)
+		calibrationResults.Add(calibrationResult);
+}
+
+int32 ULensCalibratorBenchmarkCommandlet::Main(const FString & params)
+{
+	FString foldersString;
+	if (!FParse::Value(*params, TEXT("folders="), foldersString, false) || foldersString.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Missing \"-folders=\" argument, pass one or more image folders separated by \";\"."));
+		return 1;
+	}
+
+	TArray<FString> folderPaths;
+	foldersString.TrimQuotes().ParseIntoArray(folderPaths, TEXT(";"), true);
+
+	int findCornersWorkerCount = FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1, 1);
+	/* Each zoom level is calibrated independently, so by default solve them all in parallel with up to half the cores. */
+	int calibrateWorkerCount = FMath::Clamp(folderPaths.Num(), 1, FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 2, 1));
+	float timeoutSeconds = 1800.0f;
+	bool useTaskGraph = FParse::Param(*params, TEXT("taskGraph"));
+	FString outputPath;
+
+	FParse::Value(*params, TEXT("findCornersWorkers="), findCornersWorkerCount);
+	FParse::Value(*params, TEXT("calibrateWorkers="), calibrateWorkerCount);
+	FParse::Value(*params, TEXT("timeout="), timeoutSeconds);
+	FParse::Value(*params, TEXT("output="), outputPath);
+
+	FTextureSearchParameters textureSearchParameters;
+	FParse::Value(*params, TEXT("cornerCountX="), textureSearchParameters.checkerBoardCornerCount.X);
+	FParse::Value(*params, TEXT("cornerCountY="), textureSearchParameters.checkerBoardCornerCount.Y);
+	FParse::Value(*params, TEXT("squareSizeMM="), textureSearchParameters.checkerBoardSquareSizeMM);
+	FParse::Value(*params, TEXT("resolutionX="), textureSearchParameters.nativeFullResolution.X);
+	FParse::Value(*params, TEXT("resolutionY="), textureSearchParameters.nativeFullResolution.Y);
+	FParse::Value(*params, TEXT("resizePercentage="), textureSearchParameters.resizePercentage);
+	textureSearchParameters.resize = textureSearchParameters.resizePercentage > 0.0f && textureSearchParameters.resizePercentage < 1.0f;
+	textureSearchParameters.coarseToFineSearch = FParse::Param(*params, TEXT("coarseToFine"));
+	textureSearchParameters.prefilterImagesWithoutBoard = FParse::Param(*params, TEXT("prefilter"));
+
+	FCalibrationParameters calibrationParameters;
+	FParse::Value(*params, TEXT("maxViews="), calibrationParameters.maxCalibrationViewCount);
+
+	/* Spread the zoom levels evenly between 0 and 1 in the order the folders were passed in. */
+	TArray<FTextureFolderZoomPair> inputTextures;
+	int imageCount = 0;
+	for (int fi = 0; fi < folderPaths.Num(); fi++)
+	{
+		TArray<FString> imageFiles;
+		if (!LensSolverUtilities::GetImageFilesInFolder(folderPaths[fi], imageFiles) || imageFiles.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("(ERROR): No images in folder: \"%s\"."), *folderPaths[fi]);
+			return 1;
+		}
+
+		FTextureFolderZoomPair inputTexture;
+		inputTexture.absoluteFolderPath = folderPaths[fi];
+		inputTexture.zoomLevel = folderPaths.Num() > 1 ? fi / (float)(folderPaths.Num() - 1) : 0.0f;
+		inputTextures.Add(inputTexture);
+
+		imageCount += imageFiles.Num();
+	}
+
+	ULensSolver * lensSolver = FLensCalibratorModule::Get().GetLensSolver();
+	if (lensSolver == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Lens solver is unavailable."));
+		return 1;
+	}
+
+	FDelegateHandle finishedJobHandle = lensSolver->onFinishedJobNativeDel.AddUObject(this, &ULensCalibratorBenchmarkCommandlet::OnFinishedJob);
+	FDelegateHandle calibrationResultHandle = lensSolver->onCalibrationResultNativeDel.AddUObject(this, &ULensCalibratorBenchmarkCommandlet::OnCalibrationResult);
+
+	if (useTaskGraph)
+		lensSolver->StartTaskGraphImageProcessors(true);
+	else lensSolver->StartBackgroundImageProcessors(findCornersWorkerCount, calibrateWorkerCount, true);
+
+	LensSolverPipelineLatency::Get().Reset();
+	UE_LOG(LogTemp, Log, TEXT("(INFO): Benchmarking calibration of %d images in %d folders."), imageCount, folderPaths.Num());
+
+	const double startSeconds = FPlatformTime::Seconds();
+	FJobInfo jobInfo;
+	lensSolver->OneTimeProcessArrayOfTextureFolderZoomPairs(TScriptInterface<ILensSolverEventReceiver>(), inputTextures, textureSearchParameters, calibrationParameters, jobInfo);
+
+	/* There is no engine loop in a commandlet, so pump the core ticker that polls the lens solver ourselves. */
+	uint64 peakUsedPhysical = 0;
+	bool timedOut = false;
+	double lastTickSeconds = startSeconds;
+	while (!jobFinished && !jobInfo.jobID.IsEmpty())
+	{
+		const double currentSeconds = FPlatformTime::Seconds();
+		if (currentSeconds - startSeconds > timeoutSeconds)
+		{
+			timedOut = true;
+			break;
+		}
+
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTicker::GetCoreTicker().Tick((float)(currentSeconds - lastTickSeconds));
+		lastTickSeconds = currentSeconds;
+
+		peakUsedPhysical = FMath::Max(peakUsedPhysical, (uint64)FPlatformMemory::GetStats().UsedPhysical);
+		FPlatformProcess::Sleep(0.005f);
+	}
+
+	const double elapsedSeconds = FPlatformTime::Seconds() - startSeconds;
+	lensSolver->onFinishedJobNativeDel.Remove(finishedJobHandle);
+	lensSolver->onCalibrationResultNativeDel.Remove(calibrationResultHandle);
+	lensSolver->StopBackgroundImageprocessors();
+
+	if (jobFinished && finishedJobInfo.failed)
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Benchmark job: \"%s\" failed."), *finishedJobInfo.jobID);
+		return 1;
+	}
+
+	if (!jobFinished)
+	{
+		if (timedOut)
+		{
+			UE_LOG(LogTemp, Error, TEXT("(ERROR): Benchmark timed out after %f seconds."), timeoutSeconds);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("(ERROR): Unable to start the benchmark job."));
+		}
+		return 1;
+	}
+
+	FPipelineLatencySnapshot latencySnapshot;
+	LensSolverPipelineLatency::Get().GetSnapshot(latencySnapshot);
+
+	TSharedPtr<FJsonObject> obj = MakeShareable(new FJsonObject);
+	obj->SetStringField("jobID", finishedJobInfo.jobID);
+	obj->SetNumberField("imageCount", imageCount);
+	obj->SetNumberField("zoomLevelCount", folderPaths.Num());
+	obj->SetBoolField("taskGraph", useTaskGraph);
+	obj->SetNumberField("findCornersWorkers", useTaskGraph ? 0 : findCornersWorkerCount);
+	obj->SetNumberField("calibrateWorkers", useTaskGraph ? 0 : calibrateWorkerCount);
+	obj->SetNumberField("elapsedSeconds", elapsedSeconds);
+	obj->SetNumberField("imagesPerSecond", elapsedSeconds > 0.0 ? imageCount / elapsedSeconds : 0.0);
+	obj->SetNumberField("peakUsedPhysicalMB", peakUsedPhysical / (1024.0 * 1024.0));
+	obj->SetNumberField("processPeakUsedPhysicalMB", FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+
+	TSharedPtr<FJsonObject> searchObj = MakeShareable(new FJsonObject);
+	searchObj->SetBoolField("coarseToFine", textureSearchParameters.coarseToFineSearch);
+	searchObj->SetBoolField("prefilter", textureSearchParameters.prefilterImagesWithoutBoard);
+	searchObj->SetNumberField("resizePercentage", textureSearchParameters.resize ? textureSearchParameters.resizePercentage : 1.0f);
+	obj->SetObjectField("searchParameters", searchObj);
+
+	TSharedPtr<FJsonObject> solveTimesObj = MakeShareable(new FJsonObject);
+	for (const TPair<FString, float> & solveTime : finishedJobInfo.calibrationSolveTimesMS)
+		solveTimesObj->SetNumberField(solveTime.Key, solveTime.Value);
+	obj->SetObjectField("calibrationSolveTimesMS", solveTimesObj);
+
+	/* Sorted by zoom level so runs with different search settings line up when diffed. */
+	calibrationResults.Sort([](const FCalibrationResult & a, const FCalibrationResult & b) { return a.baseParameters.zoomLevel < b.baseParameters.zoomLevel; });
+
+	TArray<TSharedPtr<FJsonValue>> calibrationValues;
+	for (const FCalibrationResult & calibrationResult : calibrationResults)
+	{
+		TSharedPtr<FJsonObject> calibrationObj = MakeShareable(new FJsonObject);
+		calibrationObj->SetNumberField("zoomLevel", calibrationResult.baseParameters.zoomLevel);
+		calibrationObj->SetBoolField("success", calibrationResult.success);
+		calibrationObj->SetNumberField("viewCount", calibrationResult.imageCount);
+		calibrationObj->SetNumberField("fovX", calibrationResult.fovX);
+		calibrationObj->SetNumberField("fovY", calibrationResult.fovY);
+		calibrationObj->SetNumberField("focalLengthMM", calibrationResult.focalLengthMM);
+		calibrationObj->SetNumberField("principalPointX", calibrationResult.principalPixelPoint.X);
+		calibrationObj->SetNumberField("principalPointY", calibrationResult.principalPixelPoint.Y);
+		calibrationObj->SetNumberField("k1", calibrationResult.k1);
+		calibrationObj->SetNumberField("k2", calibrationResult.k2);
+		calibrationObj->SetNumberField("k3", calibrationResult.k3);
+		calibrationObj->SetNumberField("p1", calibrationResult.p1);
+		calibrationObj->SetNumberField("p2", calibrationResult.p2);
+		calibrationObj->SetNumberField("solveTimeMS", calibrationResult.solveTimeMS);
+		calibrationValues.Add(MakeShareable(new FJsonValueObject(calibrationObj)));
+	}
+	obj->SetArrayField("calibrations", calibrationValues);
+
+	TArray<TSharedPtr<FJsonValue>> stageValues;
+	for (const FPipelineStageLatency & stageLatency : latencySnapshot.stages)
+	{
+		TSharedPtr<FJsonObject> stageObj = MakeShareable(new FJsonObject);
+		stageObj->SetStringField("stage", StaticEnum<UPipelineStage>()->GetNameStringByValue((int64)stageLatency.stage.GetValue()));
+		stageObj->SetNumberField("sampleCount", stageLatency.sampleCount);
+		stageObj->SetNumberField("averageMS", stageLatency.averageMS);
+		stageObj->SetNumberField("minMS", stageLatency.minMS);
+		stageObj->SetNumberField("maxMS", stageLatency.maxMS);
+		stageObj->SetNumberField("p50MS", stageLatency.p50MS);
+		stageObj->SetNumberField("p95MS", stageLatency.p95MS);
+		stageObj->SetNumberField("p99MS", stageLatency.p99MS);
+		stageValues.Add(MakeShareable(new FJsonValueObject(stageObj)));
+	}
+	obj->SetArrayField("stages", stageValues);
+
+	FString outputString;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&outputString);
+	FJsonSerializer::Serialize(obj.ToSharedRef(), writer);
+
+	UE_LOG(LogTemp, Display, TEXT("%s"), *outputString);
+
+	if (!outputPath.IsEmpty() && !FFileHelper::SaveStringToFile(outputString, *outputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Unable to write benchmark results to file: \"%s\"."), *outputPath);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensCalibratorContentionBenchmarkCommandlet.h"
+
+#include "Async/Async.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/Atomic.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "LensSolverBoundedQueue.h"
+
+/* The capacity of a find corner worker's work queue. */
+static const uint32 workQueueCapacity = 1024;
+
+/* The deque guarded by the worker's critical section that find corner workers queued work units in before their queues 
+became lock free, GetWorkLoad took the same lock. Contended acquisitions are counted the same way the distributor does. */
+class FLockedWorkQueue
+{
+private:
+	FCriticalSection lock;
+	TArray<int64> deque;
+	int workUnitCount;
+	TAtomic<uint32> contentionCount;
+
+	void Lock()
+	{
+		if (!lock.TryLock())
+		{
+			contentionCount++;
+			lock.Lock();
+		}
+	}
+
+	void Unlock()
+	{
+		lock.Unlock();
+	}
+
+public:
+	FLockedWorkQueue()
+	{
+		deque.Reserve(workQueueCapacity);
+		workUnitCount = 0;
+		contentionCount = 0;
+	}
+
+	bool Enqueue(int64 workUnit)
+	{
+		Lock();
+		deque.Add(workUnit);
+		workUnitCount++;
+		Unlock();
+		return true;
+	}
+
+	bool Dequeue(int64 & outputWorkUnit)
+	{
+		Lock();
+		if (deque.Num() == 0)
+		{
+			Unlock();
+			return false;
+		}
+
+		outputWorkUnit = deque.Pop(false);
+		workUnitCount--;
+		Unlock();
+		return true;
+	}
+
+	int GetWorkLoad()
+	{
+		Lock();
+		int count = workUnitCount;
+		Unlock();
+		return count;
+	}
+
+	uint32 GetContentionCount() const
+	{
+		return contentionCount.Load();
+	}
+};
+
+/* The bounded queue and atomic work unit count find corner workers use now, nothing here ever blocks. */
+class FLockFreeWorkQueue
+{
+private:
+	TLensSolverBoundedQueue<int64> queue;
+	TAtomic<int32> workUnitCount;
+
+public:
+	FLockFreeWorkQueue() : queue(workQueueCapacity)
+	{
+		workUnitCount = 0;
+	}
+
+	bool Enqueue(int64 workUnit)
+	{
+		++workUnitCount;
+		if (!queue.Enqueue(MoveTemp(workUnit)))
+		{
+			--workUnitCount;
+			return false;
+		}
+		return true;
+	}
+
+	bool Dequeue(int64 & outputWorkUnit)
+	{
+		if (!queue.Dequeue(outputWorkUnit))
+			return false;
+		--workUnitCount;
+		return true;
+	}
+
+	int GetWorkLoad()
+	{
+		return workUnitCount.Load();
+	}
+
+	uint32 GetContentionCount() const
+	{
+		return 0;
+	}
+};
+
+/* The job table and worker registry of the work distributor while one critical section guarded all of it's state. */
+class FGlobalLockDistributor
+{
+private:
+	FCriticalSection lock;
+	TAtomic<uint32> contentionCount;
+
+	void Lock()
+	{
+		if (!lock.TryLock())
+		{
+			contentionCount++;
+			lock.Lock();
+		}
+	}
+
+public:
+	TArray<int> workLoads;
+	TArray<int> imageCounts;
+
+	FGlobalLockDistributor()
+	{
+		contentionCount = 0;
+	}
+
+	void LockJobs() { Lock(); }
+	void UnlockJobs() { lock.Unlock(); }
+	void ReadLockWorkers() { Lock(); }
+	void ReadUnlockWorkers() { lock.Unlock(); }
+
+	uint32 GetContentionCount() const
+	{
+		return contentionCount.Load();
+	}
+};
+
+/* The job table and worker registry of the work distributor in their own shards like they are now, the read mostly 
+worker registry behind a read write lock. Only the jobs lock can be tried, so only it's contentions are counted. */
+class FShardedDistributor
+{
+private:
+	FCriticalSection jobsLock;
+	FRWLock workersLock;
+	TAtomic<uint32> contentionCount;
+
+public:
+	TArray<int> workLoads;
+	TArray<int> imageCounts;
+
+	FShardedDistributor()
+	{
+		contentionCount = 0;
+	}
+
+	void LockJobs()
+	{
+		if (!jobsLock.TryLock())
+		{
+			contentionCount++;
+			jobsLock.Lock();
+		}
+	}
+
+	void UnlockJobs() { jobsLock.Unlock(); }
+	void ReadLockWorkers() { workersLock.ReadLock(); }
+	void ReadUnlockWorkers() { workersLock.ReadUnlock(); }
+
+	uint32 GetContentionCount() const
+	{
+		return contentionCount.Load();
+	}
+};
+
+/* Run the body on the given number of threads at once, returns the seconds until the last thread finished. */
+static double RunThreads(int threadCount, TFunction<void(int)> body)
+{
+	TAtomic<int32> readyThreadCount(0);
+	TAtomic<bool> start(false);
+
+	TArray<TFuture<void>> threads;
+	for (int threadIndex = 0; threadIndex < threadCount; threadIndex++)
+	{
+		threads.Add(Async(EAsyncExecution::Thread, [&body, &readyThreadCount, &start, threadIndex]()
+		{
+			readyThreadCount++;
+			while (!start.Load())
+				FPlatformProcess::Yield();
+
+			body(threadIndex);
+		}));
+	}
+
+	while (readyThreadCount.Load() < threadCount)
+		FPlatformProcess::Yield();
+
+	const double startSeconds = FPlatformTime::Seconds();
+	start = true;
+	for (TFuture<void> & thread : threads)
+		thread.Wait();
+	return FPlatformTime::Seconds() - startSeconds;
+}
+
+/* Run one thread per worker that, like the distributor, queues a work unit to the less loaded of two workers and then, 
+like the worker, dequeues from it's own queue. Returns the number of operations per second across all threads. */
+template<typename WorkQueueType>
+static double RunWorkQueueBenchmark(int threadCount, int operationCount, uint32 & outputContentionCount, uint32 & outputFullQueueCount)
+{
+	TArray<TUniquePtr<WorkQueueType>> queues;
+	for (int i = 0; i < threadCount; i++)
+		queues.Add(MakeUnique<WorkQueueType>());
+
+	TAtomic<uint32> fullQueueCount(0);
+
+	const double elapsedSeconds = RunThreads(threadCount, [&queues, &fullQueueCount, threadCount, operationCount](int threadIndex)
+	{
+		uint32 threadFullQueueCount = 0;
+		for (int i = 0; i < operationCount; i++)
+		{
+			WorkQueueType & a = *queues[(threadIndex + i) % threadCount];
+			WorkQueueType & b = *queues[(threadIndex + i * 7 + 1) % threadCount];
+			WorkQueueType & target = a.GetWorkLoad() <= b.GetWorkLoad() ? a : b;
+
+			if (!target.Enqueue(i))
+				threadFullQueueCount++;
+
+			int64 workUnit;
+			queues[threadIndex]->Dequeue(workUnit);
+		}
+
+		fullQueueCount += threadFullQueueCount;
+	});
+
+	outputContentionCount = 0;
+	for (int i = 0; i < threadCount; i++)
+		outputContentionCount += queues[i]->GetContentionCount();
+	outputFullQueueCount = fullQueueCount.Load();
+
+	return elapsedSeconds > 0.0 ? ((double)threadCount * operationCount) / elapsedSeconds : 0.0;
+}
+
+/* Run one thread per producer or worker callback that, like queuing a work unit and recording it's result, looks up the least 
+loaded of as many workers as there are threads and then counts an image of one of a handful of jobs. Returns the number of 
+operations per second across all threads. */
+template<typename DistributorType>
+static double RunDistributorBenchmark(int threadCount, int operationCount, uint32 & outputContentionCount)
+{
+	static const int jobCount = 4;
+
+	DistributorType distributor;
+	distributor.workLoads.Init(0, threadCount);
+	distributor.imageCounts.Init(0, jobCount);
+
+	/* The chosen workers are summed up so the look up can't be optimized away. */
+	TAtomic<int64> leastLoadedWorkerIndexSum(0);
+
+	const double elapsedSeconds = RunThreads(threadCount, [&distributor, &leastLoadedWorkerIndexSum, operationCount](int threadIndex)
+	{
+		int64 threadLeastLoadedWorkerIndexSum = 0;
+		for (int i = 0; i < operationCount; i++)
+		{
+			int leastLoadedWorkerIndex = 0;
+
+			distributor.ReadLockWorkers();
+			for (int workerIndex = 1; workerIndex < distributor.workLoads.Num(); workerIndex++)
+				if (distributor.workLoads[workerIndex] < distributor.workLoads[leastLoadedWorkerIndex])
+					leastLoadedWorkerIndex = workerIndex;
+			distributor.ReadUnlockWorkers();
+
+			threadLeastLoadedWorkerIndexSum += leastLoadedWorkerIndex;
+
+			distributor.LockJobs();
+			distributor.imageCounts[(threadIndex + i) % jobCount]++;
+			distributor.UnlockJobs();
+		}
+
+		leastLoadedWorkerIndexSum += threadLeastLoadedWorkerIndexSum;
+	});
+
+	outputContentionCount = distributor.GetContentionCount();
+	return elapsedSeconds > 0.0 ? ((double)threadCount * operationCount) / elapsedSeconds : 0.0;
+}
+
+static TSharedPtr<FJsonObject> ResultToJson(double operationsPerSecond, uint32 contentionCount)
+{
+	TSharedPtr<FJsonObject> resultObj = MakeShareable(new FJsonObject);
+	resultObj->SetNumberField("operationsPerSecond", operationsPerSecond);
+	resultObj->SetNumberField("lockContentions", contentionCount);
+	return resultObj;
+}
+
+ULensCalibratorContentionBenchmarkCommandlet::ULensCalibratorContentionBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULensCalibratorContentionBenchmarkCommandlet::Main(const FString & params)
+{
+	int maxThreadCount = 64;
+	int operationCount = 200000;
+	FString outputPath;
+
+	FParse::Value(*params, TEXT("threads="), maxThreadCount);
+	FParse::Value(*params, TEXT("operations="), operationCount);
+	FParse::Value(*params, TEXT("output="), outputPath);
+	maxThreadCount = FMath::Max(maxThreadCount, 1);
+	operationCount = FMath::Max(operationCount, 1);
+
+	TArray<int> threadCounts;
+	for (int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+		threadCounts.Add(threadCount);
+	threadCounts.Add(maxThreadCount);
+
+	TArray<TSharedPtr<FJsonValue>> workQueueValues;
+	for (int threadCount : threadCounts)
+	{
+		uint32 lockedContentionCount = 0, lockedFullQueueCount = 0;
+		const double lockedOperationsPerSecond = RunWorkQueueBenchmark<FLockedWorkQueue>(threadCount, operationCount, lockedContentionCount, lockedFullQueueCount);
+
+		uint32 lockFreeContentionCount = 0, lockFreeFullQueueCount = 0;
+		const double lockFreeOperationsPerSecond = RunWorkQueueBenchmark<FLockFreeWorkQueue>(threadCount, operationCount, lockFreeContentionCount, lockFreeFullQueueCount);
+
+		UE_LOG(LogTemp, Log, TEXT("(INFO): Work queues with %d threads, locked: %f operations per second with %u contentions, lock free: %f operations per second."),
+			threadCount, lockedOperationsPerSecond, lockedContentionCount, lockFreeOperationsPerSecond);
+
+		TSharedPtr<FJsonObject> lockFreeObj = ResultToJson(lockFreeOperationsPerSecond, lockFreeContentionCount);
+		lockFreeObj->SetNumberField("fullQueueCount", lockFreeFullQueueCount);
+
+		TSharedPtr<FJsonObject> threadCountObj = MakeShareable(new FJsonObject);
+		threadCountObj->SetNumberField("threads", threadCount);
+		threadCountObj->SetObjectField("locked", ResultToJson(lockedOperationsPerSecond, lockedContentionCount));
+		threadCountObj->SetObjectField("lockFree", lockFreeObj);
+		workQueueValues.Add(MakeShareable(new FJsonValueObject(threadCountObj)));
+	}
+
+	TArray<TSharedPtr<FJsonValue>> distributorValues;
+	for (int threadCount : threadCounts)
+	{
+		uint32 globalLockContentionCount = 0;
+		const double globalLockOperationsPerSecond = RunDistributorBenchmark<FGlobalLockDistributor>(threadCount, operationCount, globalLockContentionCount);
+
+		uint32 shardedContentionCount = 0;
+		const double shardedOperationsPerSecond = RunDistributorBenchmark<FShardedDistributor>(threadCount, operationCount, shardedContentionCount);
+
+		UE_LOG(LogTemp, Log, TEXT("(INFO): Distributor with %d threads, global lock: %f operations per second with %u contentions, sharded: %f operations per second with %u jobs lock contentions."),
+			threadCount, globalLockOperationsPerSecond, globalLockContentionCount, shardedOperationsPerSecond, shardedContentionCount);
+
+		TSharedPtr<FJsonObject> threadCountObj = MakeShareable(new FJsonObject);
+		threadCountObj->SetNumberField("threads", threadCount);
+		threadCountObj->SetObjectField("globalLock", ResultToJson(globalLockOperationsPerSecond, globalLockContentionCount));
+		threadCountObj->SetObjectField("sharded", ResultToJson(shardedOperationsPerSecond, shardedContentionCount));
+		distributorValues.Add(MakeShareable(new FJsonValueObject(threadCountObj)));
+	}
+
+	TSharedPtr<FJsonObject> obj = MakeShareable(new FJsonObject);
+	obj->SetNumberField("coreCount", FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	obj->SetNumberField("operationsPerThread", operationCount);
+	obj->SetArrayField("workQueues", workQueueValues);
+	obj->SetArrayField("distributor", distributorValues);
+
+	FString outputString;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&outputString);
+	FJsonSerializer::Serialize(obj.ToSharedRef(), writer);
+
+	UE_LOG(LogTemp, Display, TEXT("%s"), *outputString);
+
+	if (!outputPath.IsEmpty() && !FFileHelper::SaveStringToFile(outputString, *outputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Unable to write benchmark results to file: \"%s\"."), *outputPath);
+		return 1;
+	}
+
+	return 0;
+}
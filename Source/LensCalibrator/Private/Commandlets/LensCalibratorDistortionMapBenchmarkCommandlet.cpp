@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensCalibratorDistortionMapBenchmarkCommandlet.h"
+
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "DistortionCorrectionMapGenerator.h"
+#include "DistortionCorrectionVolumePacker.h"
+
+ULensCalibratorDistortionMapBenchmarkCommandlet::ULensCalibratorDistortionMapBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULensCalibratorDistortionMapBenchmarkCommandlet::Main(const FString & params)
+{
+	int iterationCount = 10;
+	int sliceCount = 64;
+	FString outputPath;
+
+	FParse::Value(*params, TEXT("iterations="), iterationCount);
+	FParse::Value(*params, TEXT("slices="), sliceCount);
+	FParse::Value(*params, TEXT("output="), outputPath);
+	iterationCount = FMath::Max(iterationCount, 1);
+	sliceCount = FMath::Max(sliceCount, 1);
+
+	/* A moderately barrel distorted lens with an off center principal point. */
+	FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams;
+	distortionCorrectionMapGenerationParams.k1 = -0.12f;
+	distortionCorrectionMapGenerationParams.k2 = 0.03f;
+	distortionCorrectionMapGenerationParams.k3 = -0.004f;
+
+	static const FIntPoint resolutions[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+
+	TArray<TSharedPtr<FJsonValue>> resolutionValues;
+	for (const FIntPoint & resolution : resolutions)
+	{
+		distortionCorrectionMapGenerationParams.sourceResolution = resolution;
+		distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint = FVector2D(resolution.X * 0.51f, resolution.Y * 0.49f);
+		distortionCorrectionMapGenerationParams.outputMapResolution = resolution;
+
+		TArray<FFloat16Color> pixels;
+
+		/* Warm up so the allocation of the output and waking the thread pool aren't measured. */
+		DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, false, pixels);
+
+		const double startSeconds = FPlatformTime::Seconds();
+		for (int i = 0; i < iterationCount; i++)
+		{
+			DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, false, pixels);
+			DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, true, pixels);
+		}
+		const double elapsedSeconds = FPlatformTime::Seconds() - startSeconds;
+
+		const int mapCount = iterationCount * 2;
+		UE_LOG(LogTemp, Log, TEXT("(INFO): Generated %d distortion correction maps of size: (%d, %d) in %f seconds."),
+			mapCount, resolution.X, resolution.Y, elapsedSeconds);
+
+		TSharedPtr<FJsonObject> resolutionObj = MakeShareable(new FJsonObject);
+		resolutionObj->SetNumberField("width", resolution.X);
+		resolutionObj->SetNumberField("height", resolution.Y);
+		resolutionObj->SetNumberField("mapCount", mapCount);
+		resolutionObj->SetNumberField("elapsedSeconds", elapsedSeconds);
+		resolutionObj->SetNumberField("mapsPerSecond", elapsedSeconds > 0.0 ? mapCount / elapsedSeconds : 0.0);
+		/* JSON has no infinity, so the error is left out when any pixel failed. */
+		int inverseFailedPixelCount = 0;
+		const float maxInverseRoundTripErrorPixels = DistortionCorrectionMapGenerator::MeasureInverseRoundTripError(distortionCorrectionMapGenerationParams, pixels, inverseFailedPixelCount);
+		resolutionObj->SetNumberField("inverseFailedPixelCount", inverseFailedPixelCount);
+		if (inverseFailedPixelCount == 0)
+			resolutionObj->SetNumberField("maxInverseRoundTripErrorPixels", maxInverseRoundTripErrorPixels);
+		resolutionValues.Add(MakeShareable(new FJsonValueObject(resolutionObj)));
+	}
+
+	/* Pack a 1080p zoom stack into volume texture slices, the slices are generated from a handful of zoom 
+	levels so the source maps don't fit in cache like they wouldn't in practice. */
+	const FIntPoint packResolution(1920, 1080);
+	const int64 sliceVoxelCount = (int64)packResolution.X * packResolution.Y;
+	const int sourceMapCount = FMath::Min(sliceCount, 8);
+
+	distortionCorrectionMapGenerationParams.sourceResolution = packResolution;
+	distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint = FVector2D(packResolution.X * 0.5f, packResolution.Y * 0.5f);
+	distortionCorrectionMapGenerationParams.outputMapResolution = packResolution;
+
+	TArray<TArray<FFloat16Color>> sourceMaps;
+	sourceMaps.SetNum(sourceMapCount);
+	for (int i = 0; i < sourceMapCount; i++)
+	{
+		distortionCorrectionMapGenerationParams.k1 = -0.12f * (i + 1) / sourceMapCount;
+		DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, false, sourceMaps[i]);
+	}
+
+	TArray<const FFloat16Color*> slices;
+	slices.SetNum(sliceCount);
+	for (int i = 0; i < sliceCount; i++)
+		slices[i] = sourceMaps[i % sourceMapCount].GetData();
+
+	TArray<FFloat16Color> voxels;
+	voxels.SetNumUninitialized(sliceVoxelCount * sliceCount);
+
+	/* Warm up so the first touch of the voxel memory isn't measured. */
+	DistortionCorrectionVolumePacker::PackSlices(slices, packResolution.X, packResolution.Y, voxels.GetData());
+
+	double startSeconds = FPlatformTime::Seconds();
+	DistortionCorrectionVolumePacker::PackSlices(slices, packResolution.X, packResolution.Y, voxels.GetData());
+	const double packSeconds = FPlatformTime::Seconds() - startSeconds;
+
+	/* The per voxel callback UVolumeTexture::UpdateSourceFromFunction packed with before, for comparison. */
+	TFunction<void(int, int, int, void*)> packVoxel = [&slices, packResolution](int ix, int iy, int iz, void* value)
+	{
+		FFloat16* const voxel = static_cast<FFloat16*>(value);
+		const FFloat16Color * data = slices[iz];
+
+		voxel[0] = data[iy * packResolution.X + ix].R;
+		voxel[1] = data[iy * packResolution.X + ix].G;
+		voxel[2] = FFloat16(0.0f);
+		voxel[3] = FFloat16(0.0f);
+	};
+
+	startSeconds = FPlatformTime::Seconds();
+	FFloat16Color * voxel = voxels.GetData();
+	for (int iz = 0; iz < sliceCount; iz++)
+		for (int iy = 0; iy < packResolution.Y; iy++)
+			for (int ix = 0; ix < packResolution.X; ix++)
+				packVoxel(ix, iy, iz, voxel++);
+	const double perVoxelPackSeconds = FPlatformTime::Seconds() - startSeconds;
+
+	UE_LOG(LogTemp, Log, TEXT("(INFO): Packed %d volume texture slices of size: (%d, %d) in %f seconds, %f seconds with a callback per voxel."),
+		sliceCount, packResolution.X, packResolution.Y, packSeconds, perVoxelPackSeconds);
+
+	TSharedPtr<FJsonObject> packObj = MakeShareable(new FJsonObject);
+	packObj->SetNumberField("width", packResolution.X);
+	packObj->SetNumberField("height", packResolution.Y);
+	packObj->SetNumberField("sliceCount", sliceCount);
+	packObj->SetNumberField("elapsedSeconds", packSeconds);
+	packObj->SetNumberField("slicesPerSecond", packSeconds > 0.0 ? sliceCount / packSeconds : 0.0);
+	packObj->SetNumberField("perVoxelElapsedSeconds", perVoxelPackSeconds);
+	packObj->SetNumberField("perVoxelSlicesPerSecond", perVoxelPackSeconds > 0.0 ? sliceCount / perVoxelPackSeconds : 0.0);
+
+	TSharedPtr<FJsonObject> obj = MakeShareable(new FJsonObject);
+	obj->SetNumberField("threadCount", FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	obj->SetArrayField("resolutions", resolutionValues);
+	obj->SetObjectField("volumePacking", packObj);
+
+	FString outputString;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&outputString);
+	FJsonSerializer::Serialize(obj.ToSharedRef(), writer);
+
+	UE_LOG(LogTemp, Display, TEXT("%s"), *outputString);
+
+	if (!outputPath.IsEmpty() && !FFileHelper::SaveStringToFile(outputString, *outputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("(ERROR): Unable to write benchmark results to file: \"%s\"."), *outputPath);
+		return 1;
+	}
+
+	return 0;
+}
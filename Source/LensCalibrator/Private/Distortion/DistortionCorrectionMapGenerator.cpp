@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DistortionCorrectionMapGenerator.h"
+
+#include <limits>
+
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+#include "LensCalibratorStats.h"
+
+/* Newton's method stops once every lane of a block moved the radius scale less than this. Seeded from the 
+previous block of the row it usually takes two iterations, the first block of a row takes a few more. */
+static const float inverseConvergenceThreshold = 1e-6f;
+static const int inverseMaxIterationCount = 16;
+
+/* Keeps the Newton step finite past the radius where a strongly distorted lens model folds over itself. */
+static const float inverseMinimumDerivative = 1e-3f;
+
+/* A solution is only accepted if it solves the lens model to within this, past the fold there is no solution and Newton's method 
+wanders off. Such pixels keep their own UV and are flagged with an alpha of 0, the same as in DistortionCorrectionMapGeneration.usf. */
+static const float inverseMaximumResidual = 1e-4f;
+
+/* Like the shader only the radial terms are applied, the tangential terms are disabled there. */
+static float RadialDistortion(float r2, float k1, float k2, float k3)
+{
+	return r2 * (k1 + r2 * (k2 + r2 * k3));
+}
+
+/* Solve s * (1 + k1 * r^2 * s^2 + k2 * r^4 * s^4 + k3 * r^6 * s^6) = 1 for the scale s that takes the distorted 
+offset from the principal point back to the undistorted one, q is the squared length of the distorted offset. */
+static float SolveInverseScale(float q, float k1, float k2, float k3, float seed, bool & outputConverged)
+{
+	const float a = k1 * q;
+	const float b = k2 * q * q;
+	const float e = k3 * q * q * q;
+
+	float s = seed;
+	for (int i = 0; i < inverseMaxIterationCount; i++)
+	{
+		const float w = s * s;
+		const float f = s * (1.0f + w * (a + w * (b + w * e))) - 1.0f;
+		const float df = FMath::Max(1.0f + w * (3.0f * a + w * (5.0f * b + w * 7.0f * e)), inverseMinimumDerivative);
+		const float step = f / df;
+
+		s -= step;
+		if (FMath::Abs(step) < inverseConvergenceThreshold)
+			break;
+	}
+
+	const float w = s * s;
+	const float residual = s * (1.0f + w * (a + w * (b + w * e))) - 1.0f;
+	outputConverged = s > 0.0f && FMath::Abs(residual) <= inverseMaximumResidual;
+
+	return s;
+}
+
+static void GenerateRow(
+	FFloat16Color * rowPixels,
+	int width,
+	float uvy,
+	float ppx,
+	float ppy,
+	float k1,
+	float k2,
+	float k3)
+{
+	const float invWidth = 1.0f / width;
+	const float cy = uvy - ppy;
+	const float cy2 = cy * cy;
+
+	const VectorRegister laneOffsets = MakeVectorRegister(0.5f, 1.5f, 2.5f, 3.5f);
+	const VectorRegister invWidthV = VectorSetFloat1(invWidth);
+	const VectorRegister ppxV = VectorSetFloat1(ppx);
+	const VectorRegister uvyV = VectorSetFloat1(uvy);
+	const VectorRegister cyV = VectorSetFloat1(cy);
+	const VectorRegister cy2V = VectorSetFloat1(cy2);
+	const VectorRegister k1V = VectorSetFloat1(k1);
+	const VectorRegister k2V = VectorSetFloat1(k2);
+	const VectorRegister k3V = VectorSetFloat1(k3);
+
+	const FFloat16 zero(0.0f);
+	const FFloat16 one(1.0f);
+
+	int x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		const VectorRegister uvx = VectorMultiply(VectorAdd(VectorSetFloat1((float)x), laneOffsets), invWidthV);
+		const VectorRegister cx = VectorSubtract(uvx, ppxV);
+		const VectorRegister r2 = VectorAdd(VectorMultiply(cx, cx), cy2V);
+
+		const VectorRegister radial = VectorMultiply(r2, VectorAdd(k1V, VectorMultiply(r2, VectorAdd(k2V, VectorMultiply(r2, k3V)))));
+
+		float outputX[4], outputY[4];
+		VectorStore(VectorAdd(uvx, VectorMultiply(cx, radial)), outputX);
+		VectorStore(VectorAdd(uvyV, VectorMultiply(cyV, radial)), outputY);
+
+		for (int i = 0; i < 4; i++)
+		{
+			FFloat16Color & pixel = rowPixels[x + i];
+			pixel.R = FFloat16(outputX[i]);
+			pixel.G = FFloat16(outputY[i]);
+			pixel.B = zero;
+			pixel.A = one;
+		}
+	}
+
+	for (; x < width; x++)
+	{
+		const float uvx = (x + 0.5f) * invWidth;
+		const float cx = uvx - ppx;
+		const float radial = RadialDistortion(cx * cx + cy2, k1, k2, k3);
+
+		FFloat16Color & pixel = rowPixels[x];
+		pixel.R = FFloat16(uvx + cx * radial);
+		pixel.G = FFloat16(uvy + cy * radial);
+		pixel.B = zero;
+		pixel.A = one;
+	}
+}
+
+static void GenerateInverseRow(
+	FFloat16Color * rowPixels,
+	int width,
+	float uvy,
+	float ppx,
+	float ppy,
+	float k1,
+	float k2,
+	float k3)
+{
+	const float invWidth = 1.0f / width;
+	const float cy = uvy - ppy;
+	const float cy2 = cy * cy;
+
+	const VectorRegister laneOffsets = MakeVectorRegister(0.5f, 1.5f, 2.5f, 3.5f);
+	const VectorRegister invWidthV = VectorSetFloat1(invWidth);
+	const VectorRegister ppxV = VectorSetFloat1(ppx);
+	const VectorRegister ppyV = VectorSetFloat1(ppy);
+	const VectorRegister cyV = VectorSetFloat1(cy);
+	const VectorRegister cy2V = VectorSetFloat1(cy2);
+	const VectorRegister k1V = VectorSetFloat1(k1);
+	const VectorRegister k2V = VectorSetFloat1(k2);
+	const VectorRegister k3V = VectorSetFloat1(k3);
+	const VectorRegister threeV = VectorSetFloat1(3.0f);
+	const VectorRegister fiveV = VectorSetFloat1(5.0f);
+	const VectorRegister sevenV = VectorSetFloat1(7.0f);
+	const VectorRegister minimumDerivativeV = VectorSetFloat1(inverseMinimumDerivative);
+	const VectorRegister thresholdV = VectorSetFloat1(inverseConvergenceThreshold);
+
+	const FFloat16 zero(0.0f);
+	const FFloat16 one(1.0f);
+
+	/* Neighbouring pixels have almost the same scale, so each block starts from the last solution. */
+	float seed = 1.0f;
+
+	int x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		const VectorRegister uvx = VectorMultiply(VectorAdd(VectorSetFloat1((float)x), laneOffsets), invWidthV);
+		const VectorRegister cx = VectorSubtract(uvx, ppxV);
+		const VectorRegister q = VectorAdd(VectorMultiply(cx, cx), cy2V);
+		const VectorRegister q2 = VectorMultiply(q, q);
+
+		const VectorRegister a = VectorMultiply(k1V, q);
+		const VectorRegister b = VectorMultiply(k2V, q2);
+		const VectorRegister e = VectorMultiply(k3V, VectorMultiply(q2, q));
+
+		const VectorRegister a3 = VectorMultiply(a, threeV);
+		const VectorRegister b5 = VectorMultiply(b, fiveV);
+		const VectorRegister e7 = VectorMultiply(e, sevenV);
+
+		VectorRegister s = VectorSetFloat1(seed);
+		for (int i = 0; i < inverseMaxIterationCount; i++)
+		{
+			const VectorRegister w = VectorMultiply(s, s);
+			const VectorRegister f = VectorSubtract(VectorMultiply(s, VectorAdd(VectorOne(), VectorMultiply(w, VectorAdd(a, VectorMultiply(w, VectorAdd(b, VectorMultiply(w, e))))))), VectorOne());
+			const VectorRegister df = VectorMax(VectorAdd(VectorOne(), VectorMultiply(w, VectorAdd(a3, VectorMultiply(w, VectorAdd(b5, VectorMultiply(w, e7)))))), minimumDerivativeV);
+			const VectorRegister step = VectorDivide(f, df);
+
+			s = VectorSubtract(s, step);
+			if (!VectorAnyGreaterThan(VectorAbs(step), thresholdV))
+				break;
+		}
+
+		const VectorRegister w = VectorMultiply(s, s);
+		const VectorRegister residual = VectorSubtract(VectorMultiply(s, VectorAdd(VectorOne(), VectorMultiply(w, VectorAdd(a, VectorMultiply(w, VectorAdd(b, VectorMultiply(w, e))))))), VectorOne());
+
+		float outputX[4], outputY[4], scales[4], residuals[4], uvxs[4];
+		VectorStore(VectorAdd(ppxV, VectorMultiply(cx, s)), outputX);
+		VectorStore(VectorAdd(ppyV, VectorMultiply(cyV, s)), outputY);
+		VectorStore(s, scales);
+		VectorStore(residual, residuals);
+		VectorStore(uvx, uvxs);
+
+		for (int i = 0; i < 4; i++)
+		{
+			/* Written this way round so NaNs fail the test. */
+			const bool converged = scales[i] > 0.0f && FMath::Abs(residuals[i]) <= inverseMaximumResidual;
+
+			FFloat16Color & pixel = rowPixels[x + i];
+			pixel.R = FFloat16(converged ? outputX[i] : uvxs[i]);
+			pixel.G = FFloat16(converged ? outputY[i] : uvy);
+			pixel.B = zero;
+			pixel.A = converged ? one : zero;
+
+			/* Don't seed the next block from a lane that wandered off. */
+			if (converged)
+				seed = scales[i];
+		}
+	}
+
+	for (; x < width; x++)
+	{
+		const float uvx = (x + 0.5f) * invWidth;
+		const float cx = uvx - ppx;
+		bool converged;
+		const float s = SolveInverseScale(cx * cx + cy2, k1, k2, k3, seed, converged);
+		if (converged)
+			seed = s;
+
+		FFloat16Color & pixel = rowPixels[x];
+		pixel.R = FFloat16(converged ? ppx + cx * s : uvx);
+		pixel.G = FFloat16(converged ? ppy + cy * s : uvy);
+		pixel.B = zero;
+		pixel.A = converged ? one : zero;
+	}
+}
+
+void DistortionCorrectionMapGenerator::GenerateMap(
+	const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+	bool generateInverseMap,
+	TArray<FFloat16Color> & outputPixels)
+{
+	const int width = distortionCorrectionMapGenerationParams.outputMapResolution.X;
+	const int height = distortionCorrectionMapGenerationParams.outputMapResolution.Y;
+
+	if (width <= 0 || height <= 0)
+	{
+		outputPixels.Empty();
+		return;
+	}
+
+	outputPixels.SetNumUninitialized(width * height);
+	GenerateMap(distortionCorrectionMapGenerationParams, generateInverseMap, outputPixels.GetData());
+}
+
+void DistortionCorrectionMapGenerator::GenerateMap(
+	const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+	bool generateInverseMap,
+	FFloat16Color * outputPixels)
+{
+	uint32 start = FPlatformTime::Cycles();
+
+	const int width = distortionCorrectionMapGenerationParams.outputMapResolution.X;
+	const int height = distortionCorrectionMapGenerationParams.outputMapResolution.Y;
+
+	if (width <= 0 || height <= 0)
+		return;
+
+	const float ppx = distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint.X / (float)distortionCorrectionMapGenerationParams.sourceResolution.X;
+	const float ppy = distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint.Y / (float)distortionCorrectionMapGenerationParams.sourceResolution.Y;
+
+	const float k1 = distortionCorrectionMapGenerationParams.k1;
+	const float k2 = distortionCorrectionMapGenerationParams.k2;
+	const float k3 = distortionCorrectionMapGenerationParams.k3;
+
+	const float invHeight = 1.0f / height;
+	FFloat16Color * pixels = outputPixels;
+
+	ParallelFor(height, [=](int32 row)
+	{
+		/* The vertex shader doesn't flip the quad, so the first row read back from the render target is V = 1. */
+		const float uvy = (height - row - 0.5f) * invHeight;
+		FFloat16Color * rowPixels = pixels + (int64)row * width;
+
+		if (generateInverseMap)
+			GenerateInverseRow(rowPixels, width, uvy, ppx, ppy, k1, k2, k3);
+		else GenerateRow(rowPixels, width, uvy, ppx, ppy, k1, k2, k3);
+	});
+
+	INC_DWORD_STAT(STAT_LensCalibratorCPUDistortionMapsGenerated);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCPUDistortionMapGenerationTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - start));
+}
+
+float DistortionCorrectionMapGenerator::MeasureInverseRoundTripError(
+	const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+	const TArray<FFloat16Color> & inversePixels,
+	int & outputFailedPixelCount)
+{
+	outputFailedPixelCount = 0;
+
+	const int width = distortionCorrectionMapGenerationParams.outputMapResolution.X;
+	const int height = distortionCorrectionMapGenerationParams.outputMapResolution.Y;
+
+	if (width <= 0 || height <= 0 || inversePixels.Num() != width * height)
+		return 0.0f;
+
+	const float ppx = distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint.X / (float)distortionCorrectionMapGenerationParams.sourceResolution.X;
+	const float ppy = distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint.Y / (float)distortionCorrectionMapGenerationParams.sourceResolution.Y;
+
+	const float k1 = distortionCorrectionMapGenerationParams.k1;
+	const float k2 = distortionCorrectionMapGenerationParams.k2;
+	const float k3 = distortionCorrectionMapGenerationParams.k3;
+
+	TArray<float> rowErrors;
+	rowErrors.SetNumZeroed(height);
+
+	TArray<int> rowFailedPixelCounts;
+	rowFailedPixelCounts.SetNumZeroed(height);
+
+	const FFloat16Color * pixels = inversePixels.GetData();
+	float * rowErrorsData = rowErrors.GetData();
+	int * rowFailedPixelCountsData = rowFailedPixelCounts.GetData();
+
+	ParallelFor(height, [=](int32 row)
+	{
+		const float uvy = (height - row - 0.5f) / height;
+		const FFloat16Color * rowPixels = pixels + (int64)row * width;
+
+		float maxError = 0.0f;
+		int failedPixelCount = 0;
+		for (int x = 0; x < width; x++)
+		{
+			/* Pixels without an inverse are flagged with an alpha of 0 by the generators. */
+			if (rowPixels[x].A.GetFloat() == 0.0f)
+			{
+				failedPixelCount++;
+				continue;
+			}
+
+			const float uvx = (x + 0.5f) / width;
+			const float undistortedX = rowPixels[x].R.GetFloat();
+			const float undistortedY = rowPixels[x].G.GetFloat();
+
+			const float cx = undistortedX - ppx;
+			const float cy = undistortedY - ppy;
+			const float radial = RadialDistortion(cx * cx + cy * cy, k1, k2, k3);
+
+			const float errorX = (undistortedX + cx * radial - uvx) * width;
+			const float errorY = (undistortedY + cy * radial - uvy) * height;
+			const float error = FMath::Sqrt(errorX * errorX + errorY * errorY);
+
+			if (!FMath::IsFinite(error))
+			{
+				failedPixelCount++;
+				continue;
+			}
+
+			maxError = FMath::Max(maxError, error);
+		}
+
+		rowErrorsData[row] = maxError;
+		rowFailedPixelCountsData[row] = failedPixelCount;
+	});
+
+	for (int row = 0; row < height; row++)
+		outputFailedPixelCount += rowFailedPixelCounts[row];
+
+	if (outputFailedPixelCount > 0)
+		return std::numeric_limits<float>::infinity();
+
+	return FMath::Max(rowErrors);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DistortionCorrectionVolumePacker.h"
+
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+static_assert(sizeof(FFloat16Color) == sizeof(uint64), "Voxels are copied as 64 bit words.");
+static_assert(PLATFORM_LITTLE_ENDIAN, "R and G are expected in the low 32 bits of each voxel.");
+
+void DistortionCorrectionVolumePacker::PackSlices(
+	const TArray<const FFloat16Color*> & slices,
+	int width,
+	int height,
+	FFloat16Color * outputVoxels)
+{
+	const int64 sliceVoxelCount = (int64)width * height;
+
+	ParallelFor(slices.Num(), [&slices, sliceVoxelCount, outputVoxels](int32 slice)
+	{
+		const FFloat16Color * source = slices[slice];
+		FFloat16Color * destination = outputVoxels + slice * sliceVoxelCount;
+
+		/* A register holds two voxels, keep the R and G halves of each and clear B and A. */
+		const VectorRegister rgMask = MakeVectorRegister((uint32)0xFFFFFFFF, (uint32)0, (uint32)0xFFFFFFFF, (uint32)0);
+
+		int64 i = 0;
+		for (; i + 4 <= sliceVoxelCount; i += 4)
+		{
+			const VectorRegister first = VectorLoad(reinterpret_cast<const float*>(source + i));
+			const VectorRegister second = VectorLoad(reinterpret_cast<const float*>(source + i + 2));
+
+			VectorStore(VectorBitwiseAnd(first, rgMask), reinterpret_cast<float*>(destination + i));
+			VectorStore(VectorBitwiseAnd(second, rgMask), reinterpret_cast<float*>(destination + i + 2));
+		}
+
+		const uint64 * sourceWords = reinterpret_cast<const uint64*>(source);
+		uint64 * destinationWords = reinterpret_cast<uint64*>(destination);
+		for (; i < sliceVoxelCount; i++)
+			destinationWords[i] = sourceWords[i] & 0x00000000FFFFFFFFull;
+	});
+}
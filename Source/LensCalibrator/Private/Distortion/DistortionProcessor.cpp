@@ -26,9 +26,12 @@
 #include "ImagePixelData.h"
 #include "LensSolverUtilities.h"
 #include "RenderTargetPool.h"
+#include "Async/Async.h"
+#include "Misc/App.h"
 
 #include "DistortionCorrectionMapGenerationShader.h"
 #include "DistortionCorrectionShader.h"
+#include "DistortionCorrectionMapGenerator.h"
 
 void UDistortionProcessor::GenerateDistortionCorrectionMapRenderThread(
 	FRHICommandListImmediate& RHICmdList,
@@ -182,10 +185,16 @@ void UDistortionProcessor::GenerateDistortionCorrectionMapRenderThread(
 
 	UE_LOG(LogTemp, Log, TEXT("Wrote inverse distortion correction map to path: \"%s\"."), *inverseCorrectionFilePath);
 
+	int inverseFailedPixelCount = 0;
+	float maxInverseRoundTripErrorPixels = DistortionCorrectionMapGenerator::MeasureInverseRoundTripError(distortionCorrectionMapGenerationParams, inverseDistortionCorrectionPixels, inverseFailedPixelCount);
+	UE_LOG(LogTemp, Log, TEXT("Max inverse distortion correction map round trip error: %f pixels with %d failed pixels."), maxInverseRoundTripErrorPixels, inverseFailedPixelCount);
+
 	FDistortionCorrectionMapGenerationResults distortionCorrectionMapGenerationResults;
 	distortionCorrectionMapGenerationResults.id = distortionCorrectionMapGenerationParams.id;
 	distortionCorrectionMapGenerationResults.distortionCorrectionPixels = distortionCorrectionPixels;
 	distortionCorrectionMapGenerationResults.inverseDistortionCorrectionPixels = inverseDistortionCorrectionPixels;
+	distortionCorrectionMapGenerationResults.maxInverseRoundTripErrorPixels = maxInverseRoundTripErrorPixels;
+	distortionCorrectionMapGenerationResults.inverseFailedPixelCount = inverseFailedPixelCount;
 	distortionCorrectionMapGenerationResults.width = width;
 	distortionCorrectionMapGenerationResults.height = height;
 	distortionCorrectionMapGenerationResults.k1 = distortionCorrectionMapGenerationParams.k1;
@@ -198,6 +207,81 @@ void UDistortionProcessor::GenerateDistortionCorrectionMapRenderThread(
 	queuedDistortionCorrectionMapResults.Enqueue(distortionCorrectionMapGenerationResults);
 }
 
+void UDistortionProcessor::GenerateDistortionCorrectionMapResultsCPU(
+	const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+	const FString & correctionFilePath,
+	const FString & inverseCorrectionFilePath,
+	FDistortionCorrectionMapGenerationResults & outputResults)
+{
+	int width = distortionCorrectionMapGenerationParams.outputMapResolution.X;
+	int height = distortionCorrectionMapGenerationParams.outputMapResolution.Y;
+
+	DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, false, outputResults.distortionCorrectionPixels);
+	DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, true, outputResults.inverseDistortionCorrectionPixels);
+
+	outputResults.maxInverseRoundTripErrorPixels = DistortionCorrectionMapGenerator::MeasureInverseRoundTripError(distortionCorrectionMapGenerationParams, outputResults.inverseDistortionCorrectionPixels, outputResults.inverseFailedPixelCount);
+	UE_LOG(LogTemp, Log, TEXT("Max inverse distortion correction map round trip error: %f pixels with %d failed pixels."), outputResults.maxInverseRoundTripErrorPixels, outputResults.inverseFailedPixelCount);
+
+	outputResults.id = distortionCorrectionMapGenerationParams.id;
+	outputResults.width = width;
+	outputResults.height = height;
+	outputResults.k1 = distortionCorrectionMapGenerationParams.k1;
+	outputResults.k2 = distortionCorrectionMapGenerationParams.k2;
+	outputResults.p1 = distortionCorrectionMapGenerationParams.p1;
+	outputResults.p2 = distortionCorrectionMapGenerationParams.p2;
+	outputResults.k3 = distortionCorrectionMapGenerationParams.k3;
+	outputResults.zoomLevel = distortionCorrectionMapGenerationParams.zoomLevel;
+	outputResults.correctionFilePath = correctionFilePath;
+	outputResults.inverseCorrectionFilePath = inverseCorrectionFilePath;
+}
+
+void UDistortionProcessor::GenerateDistortionCorrectionMapCPU(
+	const FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams,
+	const FString correctionFilePath,
+	const FString inverseCorrectionFilePath)
+{
+	FDistortionCorrectionMapGenerationResults distortionCorrectionMapGenerationResults;
+
+	GenerateDistortionCorrectionMapResultsCPU(
+		distortionCorrectionMapGenerationParams,
+		correctionFilePath,
+		inverseCorrectionFilePath,
+		distortionCorrectionMapGenerationResults);
+
+	queuedDistortionCorrectionMapResults.Enqueue(distortionCorrectionMapGenerationResults);
+}
+
+void UDistortionProcessor::GenerateDistortionCorrectionMapBatchCPU(
+	const FString id,
+	const TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+	const TArray<FString> correctionFilePaths,
+	const TArray<FString> inverseCorrectionFilePaths)
+{
+	uint32 start = FPlatformTime::Cycles();
+
+	FDistortionCorrectionMapBatchGenerationResults batchResults;
+	batchResults.id = id;
+	batchResults.results.SetNum(distortionCorrectionMapGenerationParams.Num());
+
+	/* Each map is already generated across all cores, so the maps themselves are generated one after the other. */
+	for (int i = 0; i < distortionCorrectionMapGenerationParams.Num(); i++)
+	{
+		GenerateDistortionCorrectionMapResultsCPU(
+			distortionCorrectionMapGenerationParams[i],
+			correctionFilePaths[i],
+			inverseCorrectionFilePaths[i],
+			batchResults.results[i]);
+
+		batchResults.results[i].id = id;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Generated batch of %d distortion correction maps in %f milliseconds."),
+		distortionCorrectionMapGenerationParams.Num(),
+		FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - start));
+
+	queuedDistortionCorrectionMapBatchResults.Enqueue(batchResults);
+}
+
 void UDistortionProcessor::UndistortImageRenderThread(
 	FRHICommandListImmediate& RHICmdList, 
 	const FDistortTextureWithTextureParams distortionCorrectionParams, 
@@ -279,6 +363,79 @@ void UDistortionProcessor::UndistortImageRenderThread(
 	queuedCorrectedDistortedImageResults.Enqueue(correctedDistortedImageResults);
 }
 
+bool UDistortionProcessor::CreateDistortionCorrectionTextureContainers(
+	const FDistortionCorrectionMapGenerationResults & result,
+	FDistortionCorrectionTextureContainer & outputCorrectionTextureContainer,
+	FDistortionCorrectionTextureContainer & outputUncorrectionTextureContainer)
+{
+	UTexture2D* correctionMap = nullptr;
+	UTexture2D* unCorrectionMap = nullptr;
+	if (!LensSolverUtilities::CreateTexture2D((void*)result.distortionCorrectionPixels.GetData(), result.width, result.height, false, true, correctionMap, EPixelFormat::PF_FloatRGBA) ||
+		!LensSolverUtilities::CreateTexture2D((void*)result.inverseDistortionCorrectionPixels.GetData(), result.width, result.height, false, true, unCorrectionMap, EPixelFormat::PF_FloatRGBA))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unable to create textures for distortion correction maps."));
+		return false;
+	}
+
+	bool isPinCushion = result.k1 < 0.0f;
+	outputCorrectionTextureContainer.distortionMap = isPinCushion ? correctionMap : unCorrectionMap;
+	outputCorrectionTextureContainer.distortionMultiplier = 1.0f;
+	outputCorrectionTextureContainer.zoomLevel = result.zoomLevel;
+	outputCorrectionTextureContainer.invertDistortion = false;
+
+	outputUncorrectionTextureContainer.distortionMap = isPinCushion ? unCorrectionMap : correctionMap;
+	outputUncorrectionTextureContainer.distortionMultiplier = 1.0f;
+	outputUncorrectionTextureContainer.zoomLevel = result.zoomLevel;
+	outputUncorrectionTextureContainer.invertDistortion = false;
+
+	return true;
+}
+
+void UDistortionProcessor::WriteDistortionCorrectionMapFiles(FDistortionCorrectionMapGenerationResults & result)
+{
+	FIntPoint size(result.width, result.height);
+
+	if (!result.correctionFilePath.IsEmpty())
+	{
+		TUniquePtr<TImagePixelData<FFloat16Color>> pixelData = MakeUnique<TImagePixelData<FFloat16Color>>(size, MoveTemp(result.distortionCorrectionPixels));
+		check(pixelData->IsDataWellFormed());
+		pendingFileWrites.Add(LensSolverUtilities::WriteTexture16Async(result.correctionFilePath, result.width, result.height, MoveTemp(pixelData)));
+	}
+
+	if (!result.inverseCorrectionFilePath.IsEmpty())
+	{
+		TUniquePtr<TImagePixelData<FFloat16Color>> pixelData = MakeUnique<TImagePixelData<FFloat16Color>>(size, MoveTemp(result.inverseDistortionCorrectionPixels));
+		check(pixelData->IsDataWellFormed());
+		pendingFileWrites.Add(LensSolverUtilities::WriteTexture16Async(result.inverseCorrectionFilePath, result.width, result.height, MoveTemp(pixelData)));
+	}
+}
+
+/* Log how many of the completed map writes failed, writes that are still in the image write queue are checked on a later tick. */
+void UDistortionProcessor::PollFileWrites()
+{
+	int completedWriteCount = 0;
+	int failedWriteCount = 0;
+	for (int i = pendingFileWrites.Num() - 1; i >= 0; i--)
+	{
+		if (pendingFileWrites[i].IsValid() && !pendingFileWrites[i].IsReady())
+			continue;
+
+		failedWriteCount += !pendingFileWrites[i].IsValid() || !pendingFileWrites[i].Get();
+		completedWriteCount++;
+		pendingFileWrites.RemoveAtSwap(i);
+	}
+
+	if (failedWriteCount > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unable to write %d of %d distortion correction maps to file."), failedWriteCount, completedWriteCount);
+	}
+
+	else if (completedWriteCount > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Wrote %d distortion correction maps generated on the CPU to file."), completedWriteCount);
+	}
+}
+
 void UDistortionProcessor::PollDistortionCorrectionMapGenerationResults()
 {
 	bool isQueued = queuedDistortionCorrectionMapResults.IsEmpty() == false;
@@ -293,41 +450,86 @@ void UDistortionProcessor::PollDistortionCorrectionMapGenerationResults()
 		DistortionJob* job = cachedEvents.Find(result.id);
 		if (job != nullptr)
 		{
-			UTexture2D* correctionMap = nullptr;
-			UTexture2D* unCorrectionMap = nullptr;
-			if (LensSolverUtilities::CreateTexture2D(result.distortionCorrectionPixels.GetData(), result.width, result.height, false, true, correctionMap, EPixelFormat::PF_FloatRGBA) &&
-				LensSolverUtilities::CreateTexture2D(result.inverseDistortionCorrectionPixels.GetData(), result.width, result.height, false, true, unCorrectionMap, EPixelFormat::PF_FloatRGBA))
+			FDistortionCorrectionTextureContainer distortionCorrectionTextureContainer;
+			FDistortionCorrectionTextureContainer distortionUncorrectionTextureContainer;
+			if (CreateDistortionCorrectionTextureContainers(result, distortionCorrectionTextureContainer, distortionUncorrectionTextureContainer))
 			{
-				bool isPinCushion = result.k1 < 0.0f;
-				FDistortionCorrectionTextureContainer distortionCorrectionTextureContainer;
-				distortionCorrectionTextureContainer.distortionMap = isPinCushion ? correctionMap : unCorrectionMap;
-				distortionCorrectionTextureContainer.distortionMultiplier = 1.0f;
-				distortionCorrectionTextureContainer.zoomLevel = result.zoomLevel;
-				distortionCorrectionTextureContainer.invertDistortion = false;
-
-				FDistortionCorrectionTextureContainer distortionUncorrectionTextureContainer;
-				distortionUncorrectionTextureContainer.distortionMap = isPinCushion ? unCorrectionMap : correctionMap;
-				distortionUncorrectionTextureContainer.distortionMultiplier = 1.0f;
-				distortionUncorrectionTextureContainer.zoomLevel = result.zoomLevel;
-				distortionCorrectionTextureContainer.invertDistortion = false;
-
-				if (job->eventReceiver.GetObject()->IsValidLowLevel())
+				if (job->eventReceiver.GetObject() != nullptr && job->eventReceiver.GetObject()->IsValidLowLevel())
 					ILensSolverEventReceiver::Execute_OnGeneratedDistortionMaps(job->eventReceiver.GetObject(), distortionCorrectionTextureContainer, distortionUncorrectionTextureContainer);
 			}
-
-			else
-				UE_LOG(LogTemp, Error, TEXT("Unable to create textures for distortion correction maps."));
 		}
 
 		else
 			UE_LOG(LogTemp, Error, TEXT("(INFO): No cached event interface for distortion job id: \"%s\"."), 
 				*result.id);
 
+		WriteDistortionCorrectionMapFiles(result);
+
 		cachedEvents.Remove(result.id);
 		isQueued = queuedDistortionCorrectionMapResults.IsEmpty() == false;
 	}
 }
 
+void UDistortionProcessor::PollDistortionCorrectionMapBatchGenerationResults()
+{
+	bool isQueued = queuedDistortionCorrectionMapBatchResults.IsEmpty() == false;
+	while (isQueued)
+	{
+		FDistortionCorrectionMapBatchGenerationResults batchResults;
+		queuedDistortionCorrectionMapBatchResults.Dequeue(batchResults);
+
+		UE_LOG(LogTemp, Log, TEXT("(INFO): Dequeued batch of %d distortion results of id: \"%s\"."), 
+			batchResults.results.Num(),
+			*batchResults.id);
+
+		DistortionJob* job = cachedEvents.Find(batchResults.id);
+		if (job != nullptr)
+		{
+			TArray<FDistortionCorrectionTextureContainer> distortionCorrectionTextureContainers;
+			TArray<FDistortionCorrectionTextureContainer> distortionUncorrectionTextureContainers;
+			distortionCorrectionTextureContainers.Reserve(batchResults.results.Num());
+			distortionUncorrectionTextureContainers.Reserve(batchResults.results.Num());
+
+			/* Results whose textures couldn't be created are left out rather than passed on with null maps, the remaining containers carry their zoom levels. */
+			for (int i = 0; i < batchResults.results.Num(); i++)
+			{
+				FDistortionCorrectionTextureContainer distortionCorrectionTextureContainer;
+				FDistortionCorrectionTextureContainer distortionUncorrectionTextureContainer;
+				if (!CreateDistortionCorrectionTextureContainers(batchResults.results[i], distortionCorrectionTextureContainer, distortionUncorrectionTextureContainer))
+				{
+					UE_LOG(LogTemp, Error, TEXT("(ERROR): Leaving the distortion correction maps of zoom level %f out of batch: \"%s\"."),
+						batchResults.results[i].zoomLevel,
+						*batchResults.id);
+					continue;
+				}
+
+				distortionCorrectionTextureContainers.Add(distortionCorrectionTextureContainer);
+				distortionUncorrectionTextureContainers.Add(distortionUncorrectionTextureContainer);
+			}
+
+			if (distortionCorrectionTextureContainers.Num() == 0)
+			{
+				UE_LOG(LogTemp, Error, TEXT("(ERROR): Unable to create any of the %d distortion correction maps of batch: \"%s\"."),
+					batchResults.results.Num(),
+					*batchResults.id);
+			}
+
+			else if (job->eventReceiver.GetObject() != nullptr && job->eventReceiver.GetObject()->IsValidLowLevel())
+				ILensSolverEventReceiver::Execute_OnGeneratedDistortionMapBatch(job->eventReceiver.GetObject(), distortionCorrectionTextureContainers, distortionUncorrectionTextureContainers);
+		}
+
+		else
+			UE_LOG(LogTemp, Error, TEXT("(INFO): No cached event interface for distortion job id: \"%s\"."), 
+				*batchResults.id);
+
+		for (int i = 0; i < batchResults.results.Num(); i++)
+			WriteDistortionCorrectionMapFiles(batchResults.results[i]);
+
+		cachedEvents.Remove(batchResults.id);
+		isQueued = queuedDistortionCorrectionMapBatchResults.IsEmpty() == false;
+	}
+}
+
 void UDistortionProcessor::PollCorrectedDistortedImageResults()
 {
 	bool isQueued = queuedCorrectedDistortedImageResults.IsEmpty() == false;
@@ -345,7 +547,7 @@ void UDistortionProcessor::PollCorrectedDistortedImageResults()
 			UTexture2D* map = nullptr;
 			if (LensSolverUtilities::CreateTexture2D(result.pixels.GetData(), result.width, result.height, true, false, map))
 			{
-				if (job->eventReceiver.GetObject()->IsValidLowLevel())
+				if (job->eventReceiver.GetObject() != nullptr && job->eventReceiver.GetObject()->IsValidLowLevel())
 					ILensSolverEventReceiver::Execute_OnDistortedImageCorrected(job->eventReceiver.GetObject(), map);
 			}
 
@@ -445,7 +647,9 @@ void UDistortionProcessor::DistortTextureWithCoefficients(
 void UDistortionProcessor::Poll()
 {
 	PollDistortionCorrectionMapGenerationResults();
+	PollDistortionCorrectionMapBatchGenerationResults();
 	PollCorrectedDistortedImageResults();
+	PollFileWrites();
 }
 
 void UDistortionProcessor::GenerateDistortionCorrectionMap(
@@ -485,6 +689,24 @@ void UDistortionProcessor::GenerateDistortionCorrectionMap(
 	UDistortionProcessor * distortionProcessor = this;
 	const FDistortionCorrectionMapGenerationParameters temp = distortionCorrectionMapGenerationParams;
 
+	/* Without a GPU there is nothing to render with, so fall back to generating the maps on the CPU. */
+	if (distortionCorrectionMapGenerationParams.generateOnCPU || GUsingNullRHI || !FApp::CanEverRender())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Generating distortion correction map of size: (%d, %d) on the CPU."),
+			distortionCorrectionMapGenerationParams.outputMapResolution.X,
+			distortionCorrectionMapGenerationParams.outputMapResolution.Y);
+
+		Async(EAsyncExecution::ThreadPool, [distortionProcessor, temp, correctionOutputPath, inverseCorrectionOutputPath]()
+		{
+			distortionProcessor->GenerateDistortionCorrectionMapCPU(
+				temp,
+				correctionOutputPath,
+				inverseCorrectionOutputPath);
+		});
+
+		return;
+	}
+
 	UE_LOG(LogTemp, Log, TEXT("Queuing render command to generate distortion correction map of size: (%d, %d)."),
 		distortionCorrectionMapGenerationParams.outputMapResolution.X,
 		distortionCorrectionMapGenerationParams.outputMapResolution.Y);
@@ -515,3 +737,150 @@ void UDistortionProcessor::GenerateDistortionCorrectionMap(
 	);
 }
 
+
+void UDistortionProcessor::GenerateDistortionCorrectionMaps(
+	TScriptInterface<ILensSolverEventReceiver> eventReceiver,
+	TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams)
+{
+	if (distortionCorrectionMapGenerationParams.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot generate distortion correction maps, no distortion correction map parameters."));
+		return;
+	}
+
+	static const FString backupOutputPath = LensSolverUtilities::GenerateGenericDistortionCorrectionMapOutputPath(FString("DistortionCorrectionMaps/"));
+
+	TArray<FString> correctionOutputPaths;
+	TArray<FString> inverseCorrectionOutputPaths;
+	correctionOutputPaths.SetNum(distortionCorrectionMapGenerationParams.Num());
+	inverseCorrectionOutputPaths.SetNum(distortionCorrectionMapGenerationParams.Num());
+
+	for (int i = 0; i < distortionCorrectionMapGenerationParams.Num(); i++)
+	{
+		const FDistortionCorrectionMapGenerationParameters & params = distortionCorrectionMapGenerationParams[i];
+		if (params.outputMapResolution.X <= 3 || params.outputMapResolution.Y <= 3)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot generate distortion correction maps, the map resolution of DistortionCorrectionMapParameter: %d is <= 3 pixels on the X or Y axis."), i);
+			return;
+		}
+
+		/* None of the files exist until the batch is written, so the generated file names need to differ by 
+		their index in the batch instead of relying on the next free index on disk. */
+		correctionOutputPaths[i] = params.correctionOutputPath;
+		if (!LensSolverUtilities::ValidateFilePath(correctionOutputPaths[i], backupOutputPath, FString::Printf(TEXT("DistortionCorrectionMap-%d"), i), FString("exr")))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot generate distortion correction map, unable to create folder path: \"%s\"."), *correctionOutputPaths[i]);
+			return;
+		}
+
+		inverseCorrectionOutputPaths[i] = params.inverseCorrectionOutputPath;
+		if (!LensSolverUtilities::ValidateFilePath(inverseCorrectionOutputPaths[i], backupOutputPath, FString::Printf(TEXT("DistortionUncorrectionMap-%d"), i), FString("exr")))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot generate inverse distortion correction map, unable to create folder path: \"%s\"."), *inverseCorrectionOutputPaths[i]);
+			return;
+		}
+	}
+
+	FString guid = FGuid::NewGuid().ToString();
+
+	DistortionJob job;
+	job.eventReceiver = eventReceiver;
+	job.id = guid;
+
+	cachedEvents.Add(guid, job);
+
+	UDistortionProcessor * distortionProcessor = this;
+
+	UE_LOG(LogTemp, Log, TEXT("Generating batch of %d distortion correction maps on the CPU."), distortionCorrectionMapGenerationParams.Num());
+
+	Async(EAsyncExecution::ThreadPool, [distortionProcessor, guid, distortionCorrectionMapGenerationParams, correctionOutputPaths, inverseCorrectionOutputPaths]()
+	{
+		distortionProcessor->GenerateDistortionCorrectionMapBatchCPU(
+			guid,
+			distortionCorrectionMapGenerationParams,
+			correctionOutputPaths,
+			inverseCorrectionOutputPaths);
+	});
+}
+
+bool UDistortionProcessor::GenerateDistortionCorrectionMapsIntoVolumeTexture(
+	TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+	bool generateUncorrectionMaps,
+	UVolumeTexture * volumeTexture)
+{
+#if WITH_EDITOR
+	if (distortionCorrectionMapGenerationParams.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot generate distortion correction maps, no distortion correction map parameters."));
+		return false;
+	}
+
+	if (volumeTexture == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Input VolumeTexture is NULL."));
+		return false;
+	}
+
+	const int width = distortionCorrectionMapGenerationParams[0].outputMapResolution.X;
+	const int height = distortionCorrectionMapGenerationParams[0].outputMapResolution.Y;
+	const int sliceCount = distortionCorrectionMapGenerationParams.Num();
+
+	if (width <= 3 || height <= 3)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot generate distortion correction maps, the map resolution DistortionCorrectionMapParameter member is <= 3 pixels on the X or Y axis."));
+		return false;
+	}
+
+	for (int i = 1; i < sliceCount; i++)
+	{
+		if (distortionCorrectionMapGenerationParams[i].outputMapResolution != distortionCorrectionMapGenerationParams[0].outputMapResolution)
+		{
+			UE_LOG(LogTemp, Error, TEXT("All distortion correction maps packed into a volume texture should have the same resolution, the map at index: %d has a resolution of: (%d, %d). The expected resolution is: (%d, %d)."),
+				i,
+				distortionCorrectionMapGenerationParams[i].outputMapResolution.X,
+				distortionCorrectionMapGenerationParams[i].outputMapResolution.Y,
+				width,
+				height);
+			return false;
+		}
+	}
+
+	uint32 start = FPlatformTime::Cycles();
+
+	/* The volume texture would otherwise be rebuilt from the 2D texture it was created from. */
+	volumeTexture->Source2DTexture = nullptr;
+	volumeTexture->Source.Init(width, height, sliceCount, 1, TSF_RGBA16F);
+
+	/* TSF_RGBA16F voxels have the same layout as FFloat16Color, so each slice is generated in place. */
+	FFloat16Color * voxels = reinterpret_cast<FFloat16Color*>(volumeTexture->Source.LockMip(0));
+	if (voxels == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unable to lock VolumeTexture source."));
+		return false;
+	}
+
+	/* As in CreateDistortionCorrectionTextureContainers, whether the forward or the inverse map corrects a slice depends 
+	on the sign of it's k1, so a zoom stack that crosses from barrel to pin cushion distortion mixes both. */
+	for (int i = 0; i < sliceCount; i++)
+	{
+		bool isPinCushion = distortionCorrectionMapGenerationParams[i].k1 < 0.0f;
+		bool generateInverseMap = generateUncorrectionMaps == isPinCushion;
+		DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams[i], generateInverseMap, voxels + (int64)i * width * height);
+	}
+
+	volumeTexture->Source.UnlockMip(0);
+	volumeTexture->PostEditChange();
+	volumeTexture->MarkPackageDirty();
+
+	UE_LOG(LogTemp, Log, TEXT("Generated: %d distortion correction maps of size: (%d, %d) into volume texture in %f milliseconds."),
+		sliceCount,
+		width,
+		height,
+		FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - start));
+
+	return true;
+#else
+	UE_LOG(LogTemp, Error, TEXT("Volume texture source data can only be generated in the editor."));
+	return false;
+#endif
+}
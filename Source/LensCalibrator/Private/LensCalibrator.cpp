@@ -158,6 +158,13 @@ void FLensCalibratorModule::StartupModule()
 
 	// Debug the plugin.
 	IConsoleManager::Get().RegisterConsoleVariable(TEXT("LensCalibrator.Debug"), 0, TEXT("Output more log information for debugging."));
+
+	// Read media stream snapshots back from the GPU without stalling the render thread, set to 0 to use the blocking readback.
+	IConsoleManager::Get().RegisterConsoleVariable(TEXT("LensCalibrator.AsyncSnapshotReadback"), 1, TEXT("Read media stream snapshots back from the GPU asynchronously."));
+
+	// Number of texture files to read into memory ahead of the workers, set to 0 to let the workers read the files themselves. The decode stage
+	// area averages downscaled images while the wrapper resizes them itself, so 0 also restores the wrapper's resize.
+	IConsoleManager::Get().RegisterConsoleVariable(TEXT("LensCalibrator.FilePrefetchCount"), 8, TEXT("Number of texture files to read and decode ahead of the find corner workers, downscales are area averaged. 0 lets the workers read, decode and resize the files themselves through the wrapper."));
 }
 
 // We don't currently unreference the handles to our DLLs, maybe we should?
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensCalibratorStats.h"
+
+DEFINE_STAT(STAT_LensCalibratorWorkerWakeupLatency);
+DEFINE_STAT(STAT_LensCalibratorWorkerWakeups);
+DEFINE_STAT(STAT_LensCalibratorFindCornersWorkUnitsProcessed);
+DEFINE_STAT(STAT_LensCalibratorWorkUnitsStolen);
+DEFINE_STAT(STAT_LensCalibratorFindCornersWorkUnitsDropped);
+DEFINE_STAT(STAT_LensCalibratorFindCornersQueueFullWaits);
+DEFINE_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+DEFINE_STAT(STAT_LensCalibratorJobsLockContentions);
+DEFINE_STAT(STAT_LensCalibratorStreamsLockContentions);
+DEFINE_STAT(STAT_LensCalibratorWorkersLockWaitTime);
+DEFINE_STAT(STAT_LensCalibratorMediaStreamSnapshotsInFlight);
+DEFINE_STAT(STAT_LensCalibratorMediaStreamFramesDropped);
+DEFINE_STAT(STAT_LensCalibratorAsyncSnapshotReadbacks);
+DEFINE_STAT(STAT_LensCalibratorBlockingSnapshotReadbacks);
+DEFINE_STAT(STAT_LensCalibratorPixelBufferAllocations);
+DEFINE_STAT(STAT_LensCalibratorPixelBufferCopies);
+DEFINE_STAT(STAT_LensCalibratorPixelBufferPoolHits);
+DEFINE_STAT(STAT_LensCalibratorPixelBufferPoolMisses);
+DEFINE_STAT(STAT_LensCalibratorPixelBufferPoolHighWaterMark);
+DEFINE_STAT(STAT_LensCalibratorFilesPrefetched);
+DEFINE_STAT(STAT_LensCalibratorFilePrefetchStallTime);
+DEFINE_STAT(STAT_LensCalibratorFolderScanTime);
+
+DEFINE_STAT(STAT_LensCalibratorFileReadTime);
+DEFINE_STAT(STAT_LensCalibratorFilesDecoded);
+DEFINE_STAT(STAT_LensCalibratorDecodeTime);
+DEFINE_STAT(STAT_LensCalibratorCornerDetections);
+DEFINE_STAT(STAT_LensCalibratorCornerDetectionTime);
+
+DEFINE_STAT(STAT_LensCalibratorCoarseToFineSearches);
+DEFINE_STAT(STAT_LensCalibratorCornerRefinementTime);
+DEFINE_STAT(STAT_LensCalibratorCornersRefined);
+DEFINE_STAT(STAT_LensCalibratorCornersNotRefined);
+DEFINE_STAT(STAT_LensCalibratorCoarseToFineFallbacks);
+
+DEFINE_STAT(STAT_LensCalibratorSnapshotsTracked);
+DEFINE_STAT(STAT_LensCalibratorCornerTrackingFailures);
+DEFINE_STAT(STAT_LensCalibratorCornerTrackingTime);
+
+DEFINE_STAT(STAT_LensCalibratorPrefilterRejected);
+DEFINE_STAT(STAT_LensCalibratorPrefilterPassed);
+DEFINE_STAT(STAT_LensCalibratorPrefilterTime);
+
+DEFINE_STAT(STAT_LensCalibratorViewsSelected);
+DEFINE_STAT(STAT_LensCalibratorViewsDiscarded);
+DEFINE_STAT(STAT_LensCalibratorViewSelectionTime);
+
+DEFINE_STAT(STAT_LensCalibratorProvisionalSolves);
+DEFINE_STAT(STAT_LensCalibratorProvisionalSolvesSkipped);
+DEFINE_STAT(STAT_LensCalibratorProvisionalSolveTime);
+
+DEFINE_STAT(STAT_LensCalibratorCalibrationSolveTime);
+
+DEFINE_STAT(STAT_LensCalibratorCPUDistortionMapsGenerated);
+DEFINE_STAT(STAT_LensCalibratorCPUDistortionMapGenerationTime);
+
+DEFINE_STAT(STAT_LensCalibratorReadAndDecodeLatency);
+DEFINE_STAT(STAT_LensCalibratorQueueWaitLatency);
+DEFINE_STAT(STAT_LensCalibratorCornerDetectionLatency);
+DEFINE_STAT(STAT_LensCalibratorLatchWaitLatency);
+DEFINE_STAT(STAT_LensCalibratorCalibrateQueueWaitLatency);
+DEFINE_STAT(STAT_LensCalibratorSolveLatency);
+DEFINE_STAT(STAT_LensCalibratorDeliveryLatency);
+DEFINE_STAT(STAT_LensCalibratorEndToEndLatency);
+DEFINE_STAT(STAT_LensCalibratorCalibrationsDelivered);
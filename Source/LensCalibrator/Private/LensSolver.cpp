@@ -31,7 +31,13 @@
 #include "ImageWriteTask.h"
 #include "ImageWriteQueue.h"
 
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+
 #include "LensSolverUtilities.h"
+#include "LensSolverFilePrefetcher.h"
+#include "LensCalibratorStats.h"
+#include "LensSolverPipelineLatency.h"
 #include "BlitShader.h"
 #include "WorkerRegistry.h"
 
@@ -114,13 +120,13 @@ void ULensSolver::OneTimeProcessArrayOfTextureFolderZoomPairs(
 		return;
 	}
 
-	if (LensSolverWorkDistributor::GetInstance().GetFindCornerWorkerCount() <= 0 || LensSolverWorkDistributor::GetInstance().GetCalibrateCount() <= 0)
+	if (!LensSolverWorkDistributor::GetInstance().WorkersAvailable())
 	{
-		UE_LOG(LogTemp, Error, TEXT("No workers available, make sure you start both background \"FindCorner\" & \"Calibrate\" workers."));
+		UE_LOG(LogTemp, Error, TEXT("No workers available, make sure you start both background \"FindCorner\" & \"Calibrate\" workers or the task graph image processors."));
 		return;
 	}
 
-	int useCount = 0, useIndex = 0, offset = 0;
+	int useCount = 0, useIndex = 0;
 	/* Initially loop through all the texture folders to determine
 	if any of the zoom levels are disabled/enabled and count the
 	enabled ones so that we can pre-allocate our arrays with
@@ -128,87 +134,133 @@ void ULensSolver::OneTimeProcessArrayOfTextureFolderZoomPairs(
 	for (int ti = 0; ti < inputTextures.Num(); ti++)
 		useCount += inputTextures[ti].use;
 
-	TArray<TArray<FString>> imageFiles;
-	TArray<int> expectedImageCounts;
+	TArray<FString> folderPaths;
 	TArray<float> zoomLevels;
 
 	/* Preallocate our arrays. */
-	imageFiles.SetNum(useCount);
-	expectedImageCounts.SetNum(useCount);
+	folderPaths.SetNum(useCount);
 	zoomLevels.SetNum(useCount);
 
-	/* Loop through folders each containing sets of textures representing a 
-	particular zoom level of the calibration pattern. */
+	/* Skip disabled folders so the index is consistent with the calibration IDs. */
 	for (int ti = 0; ti < inputTextures.Num(); ti++)
 	{
-		/* If we are skipping a folder, then shift the index so we can
-		keep the index consistent. */
-		useIndex = ti - offset;
-
-		TArray<FString> imagesInDirectory;
-		TArray<UTexture2D*> textures;
-
 		if (!inputTextures[ti].use)
-		{
-			offset++;
 			continue;
-		}
+
+		folderPaths[useIndex] = inputTextures[ti].absoluteFolderPath;
+		zoomLevels[useIndex] = inputTextures[ti].zoomLevel;
+		useIndex++;
+	}
+
+	/* The image counts are not known until the folders are scanned, so register the job with 
+	placeholder counts that can't be reached and set the real ones once the scan is finished. */
+	TArray<int> placeholderImageCounts;
+	placeholderImageCounts.Init(MAX_int32, useCount);
+
+	LensSolverWorkDistributor::GetInstance().SetCalibrateWorkerParameters(calibrationParameters);
+	ouptutJobInfo = LensSolverWorkDistributor::GetInstance().RegisterJob(eventReceiver, placeholderImageCounts, useCount, UJobType::OneTime);
+
+	/* Setup debug output texture paths, these are the same for every work unit. */
+	const FString cornerVisualizationTextureOutputPath = PrepareDebugOutputPath(textureSearchParameters.cornerVisualizationTextureOutputPath);
+	const FString preCornerDetectionTextureOutputPath = PrepareDebugOutputPath(textureSearchParameters.preCornerDetectionTextureOutputPath);
+
+	/* Scan the folders and read the files off the game thread, with large amounts of zoom levels on
+	network attached storage this would otherwise hitch the editor. */
+	Async(EAsyncExecution::ThreadPool, [
+		jobInfo = ouptutJobInfo, 
+		folderPaths = MoveTemp(folderPaths), 
+		zoomLevels = MoveTemp(zoomLevels), 
+		textureSearchParameters, 
+		cornerVisualizationTextureOutputPath, 
+		preCornerDetectionTextureOutputPath]()
+	{
+		const int folderCount = folderPaths.Num();
+
+		TArray<TArray<FString>> imageFiles;
+		TArray<int> expectedImageCounts;
+		TArray<bool> scanned;
+
+		imageFiles.SetNum(folderCount);
+		expectedImageCounts.SetNum(folderCount);
+		scanned.SetNum(folderCount);
 
 		/* Fill imageFiles array at each zoom level with absolute file path to texture. */
-		if (!LensSolverUtilities::GetImageFilesInFolder(inputTextures[ti].absoluteFolderPath, imageFiles[useIndex]))
-			return;
+		uint32 scanStartCycles = FPlatformTime::Cycles();
+		ParallelFor(folderCount, [&folderPaths, &imageFiles, &scanned](int32 ci)
+		{
+			scanned[ci] = LensSolverUtilities::GetImageFilesInFolder(folderPaths[ci], imageFiles[ci]);
+		});
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorFolderScanTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - scanStartCycles));
 
-		if (imageFiles[useIndex].Num() == 0)
+		for (int ci = 0; ci < folderCount; ci++)
 		{
-			UE_LOG(LogTemp, Error, TEXT("No textures in directory: \"%s\", canceled job."), *inputTextures[ti].absoluteFolderPath);
-			return;
+			if (!scanned[ci] || imageFiles[ci].Num() == 0)
+			{
+				UE_LOG(LogTemp, Error, TEXT("No textures in directory: \"%s\", canceled job."), *folderPaths[ci]);
+				LensSolverWorkDistributor::GetInstance().FailJob(jobInfo.jobID);
+				return;
+			}
+
+			/* Store the expected number of images for calibration. */
+			expectedImageCounts[ci] = imageFiles[ci].Num();
 		}
 
-		/* Store the expected number of images and zoom level for calibration. */
-		expectedImageCounts[useIndex] = imageFiles[useIndex].Num();
-		zoomLevels[useIndex] = inputTextures[ti].zoomLevel;
-	}
+		if (!LensSolverWorkDistributor::GetInstance().SetExpectedImageCounts(jobInfo.jobID, expectedImageCounts))
+			return;
 
-	LensSolverWorkDistributor::GetInstance().SetCalibrateWorkerParameters(calibrationParameters);
-	ouptutJobInfo = LensSolverWorkDistributor::GetInstance().RegisterJob(eventReceiver, expectedImageCounts, useCount, UJobType::OneTime);
+		TArray<FLensSolverTextureFileWorkUnit> workUnits;
 
-	/* Loop through zoom levels. */
-	for (int ci = 0; ci < useCount; ci++)
-	{
-		/* Loop through images for zoom level, build work unit and 
-		queue that work unit to be consumed by the workers. */
-		for (int ii = 0; ii < imageFiles[ci].Num(); ii++)
+		/* Loop through zoom levels. */
+		for (int ci = 0; ci < folderCount; ci++)
 		{
-			FLensSolverTextureFileWorkUnit workUnit;
-			workUnit.baseParameters.jobID						= ouptutJobInfo.jobID;
-			workUnit.baseParameters.calibrationID				= ouptutJobInfo.calibrationIDs[ci];
-			workUnit.baseParameters.zoomLevel					= zoomLevels[ci];
-			workUnit.baseParameters.friendlyName				= FPaths::GetBaseFilename(imageFiles[ci][ii]);
-
-			/* Ugly */
-			workUnit.textureSearchParameters.nativeFullResolutionX					= textureSearchParameters.nativeFullResolution.X;
-			workUnit.textureSearchParameters.nativeFullResolutionY					= textureSearchParameters.nativeFullResolution.Y;
-			workUnit.textureSearchParameters.resizePercentage						= textureSearchParameters.resizePercentage;
-			workUnit.textureSearchParameters.resize									= textureSearchParameters.resize;
-			workUnit.textureSearchParameters.flipX									= textureSearchParameters.flipX,
-			workUnit.textureSearchParameters.flipY									= textureSearchParameters.flipY;
-			workUnit.textureSearchParameters.exhaustiveSearch						= textureSearchParameters.exhaustiveSearch;
-			workUnit.textureSearchParameters.checkerBoardSquareSizeMM				= textureSearchParameters.checkerBoardSquareSizeMM;
-			workUnit.textureSearchParameters.checkerBoardCornerCountX				= textureSearchParameters.checkerBoardCornerCount.X,
-			workUnit.textureSearchParameters.checkerBoardCornerCountY				= textureSearchParameters.checkerBoardCornerCount.Y;
-
-			workUnit.textureFileParameters.absoluteFilePath							= imageFiles[ci][ii];
-
-			/* Setup debug output texture paths. */
-			workUnit.textureSearchParameters.writeCornerVisualizationTextureToFile	= textureSearchParameters.writeCornerVisualizationTextureToFile;
-			FillCharArrayFromFString(workUnit.textureSearchParameters.cornerVisualizationTextureOutputPath, PrepareDebugOutputPath(textureSearchParameters.cornerVisualizationTextureOutputPath));
-			workUnit.textureSearchParameters.writePreCornerDetectionTextureToFile	= textureSearchParameters.writePreCornerDetectionTextureToFile;
-			FillCharArrayFromFString(workUnit.textureSearchParameters.preCornerDetectionTextureOutputPath, PrepareDebugOutputPath(textureSearchParameters.preCornerDetectionTextureOutputPath));
-
-			/* Queue the work unit to be consumed by the workers. */
-			LensSolverWorkDistributor::GetInstance().QueueTextureFileWorkUnit(ouptutJobInfo.jobID, workUnit);
+			/* Loop through images for zoom level and build work units to be consumed by the workers. */
+			for (int ii = 0; ii < imageFiles[ci].Num(); ii++)
+			{
+				FLensSolverTextureFileWorkUnit workUnit;
+				workUnit.baseParameters.jobID						= jobInfo.jobID;
+				workUnit.baseParameters.calibrationID				= jobInfo.calibrationIDs[ci];
+				workUnit.baseParameters.zoomLevel					= zoomLevels[ci];
+				workUnit.baseParameters.friendlyName				= FPaths::GetBaseFilename(imageFiles[ci][ii]);
+
+				/* Ugly */
+				workUnit.textureSearchParameters.nativeFullResolutionX					= textureSearchParameters.nativeFullResolution.X;
+				workUnit.textureSearchParameters.nativeFullResolutionY					= textureSearchParameters.nativeFullResolution.Y;
+				workUnit.textureSearchParameters.resizePercentage						= textureSearchParameters.resizePercentage;
+				workUnit.textureSearchParameters.resize									= textureSearchParameters.resize;
+				workUnit.textureSearchParameters.flipX									= textureSearchParameters.flipX,
+				workUnit.textureSearchParameters.flipY									= textureSearchParameters.flipY;
+				workUnit.textureSearchParameters.exhaustiveSearch						= textureSearchParameters.exhaustiveSearch;
+				workUnit.textureSearchParameters.checkerBoardSquareSizeMM				= textureSearchParameters.checkerBoardSquareSizeMM;
+				workUnit.textureSearchParameters.checkerBoardCornerCountX				= textureSearchParameters.checkerBoardCornerCount.X,
+				workUnit.textureSearchParameters.checkerBoardCornerCountY				= textureSearchParameters.checkerBoardCornerCount.Y;
+
+				workUnit.textureFileParameters.absoluteFilePath							= imageFiles[ci][ii];
+
+				/* The coarse to fine search does it's own downscaling, so the image is decoded at full resolution. */
+				if (textureSearchParameters.coarseToFineSearch)
+				{
+					workUnit.textureSearchParameters.resize								= false;
+					workUnit.cornerSearchParameters.coarseToFine						= true;
+					workUnit.cornerSearchParameters.coarseSearchPercentage				= textureSearchParameters.resizePercentage;
+					workUnit.cornerSearchParameters.windowRadius						= textureSearchParameters.cornerRefinementWindowRadius;
+				}
+
+				workUnit.cornerSearchParameters.prefilter								= textureSearchParameters.prefilterImagesWithoutBoard;
+
+				/* Setup debug output texture paths. */
+				workUnit.textureSearchParameters.writeCornerVisualizationTextureToFile	= textureSearchParameters.writeCornerVisualizationTextureToFile;
+				FillCharArrayFromFString(workUnit.textureSearchParameters.cornerVisualizationTextureOutputPath, cornerVisualizationTextureOutputPath);
+				workUnit.textureSearchParameters.writePreCornerDetectionTextureToFile	= textureSearchParameters.writePreCornerDetectionTextureToFile;
+				FillCharArrayFromFString(workUnit.textureSearchParameters.preCornerDetectionTextureOutputPath, preCornerDetectionTextureOutputPath);
+
+				workUnits.Add(MoveTemp(workUnit));
+			}
 		}
-	}
+
+		/* Read the files a few ahead of the workers and queue the work units to be consumed by the workers. */
+		TSharedPtr<FLensSolverFilePrefetcher, ESPMode::ThreadSafe> prefetcher = MakeShared<FLensSolverFilePrefetcher, ESPMode::ThreadSafe>(FLensSolverFilePrefetcher::GetPrefetchCountSetting());
+		prefetcher->QueueWorkUnits(workUnits);
+	});
 }
 
 /* Start calibration from a media stream and pass in corner search parameters, calibration 
@@ -221,9 +273,9 @@ void ULensSolver::StartMediaStreamCalibration(
 	FMediaStreamParameters mediaStreamParameters,
 	FJobInfo& ouptutJobInfo)
 {
-	if (LensSolverWorkDistributor::GetInstance().GetFindCornerWorkerCount() <= 0 || LensSolverWorkDistributor::GetInstance().GetCalibrateCount() <= 0)
+	if (!LensSolverWorkDistributor::GetInstance().WorkersAvailable())
 	{
-		UE_LOG(LogTemp, Error, TEXT("No workers available, make sure you start both background \"FindCorner\" & \"Calibrate\" workers."));
+		UE_LOG(LogTemp, Error, TEXT("No workers available, make sure you start both background \"FindCorner\" & \"Calibrate\" workers or the task graph image processors."));
 		return;
 	}
 
@@ -278,6 +330,19 @@ void ULensSolver::StartMediaStreamCalibration(
 	workUnit.mediaStreamParameters												= mediaStreamParameters;
 	workUnit.mediaStreamParameters.currentStreamSnapshotCount					= 0;
 
+	/* The coarse to fine search does it's own downscaling, so snapshots are taken at full resolution. */
+	if (textureSearchParameters.coarseToFineSearch)
+	{
+		workUnit.textureSearchParameters.resize									= false;
+		workUnit.cornerSearchParameters.coarseToFine							= true;
+		workUnit.cornerSearchParameters.coarseSearchPercentage					= textureSearchParameters.resizePercentage;
+		workUnit.cornerSearchParameters.windowRadius							= textureSearchParameters.cornerRefinementWindowRadius;
+	}
+
+	workUnit.cornerSearchParameters.trackCorners								= mediaStreamParameters.trackCorners;
+	workUnit.cornerSearchParameters.maxConsecutiveTrackedSnapshots				= mediaStreamParameters.maxConsecutiveTrackedSnapshots;
+	workUnit.cornerSearchParameters.prefilter									= textureSearchParameters.prefilterImagesWithoutBoard;
+
 	/* Setup debug output texture paths. */
 	workUnit.textureSearchParameters.writeCornerVisualizationTextureToFile		= textureSearchParameters.writeCornerVisualizationTextureToFile;
 	FillCharArrayFromFString(workUnit.textureSearchParameters.cornerVisualizationTextureOutputPath, PrepareDebugOutputPath(textureSearchParameters.cornerVisualizationTextureOutputPath));
@@ -298,6 +363,26 @@ void ULensSolver::StartBackgroundImageProcessors(int findCornersWorkerCount, int
 		return;
 	}
 
+	ConfigureWorkDistributor(shutDownWorkersAfterCompletingTasks);
+	LensSolverWorkDistributor::GetInstance().PrepareWorkers(findCornersWorkerCount, calibrateWorkerCount);
+}
+
+/* Start processing images and calibrating as tasks on the engine's task graph instead of a fixed number of background workers. */
+void ULensSolver::StartTaskGraphImageProcessors(bool shutDownWorkersAfterCompletingTasks)
+{
+	if (WorkerRegistry::Get().WorkersRunning())
+	{
+		UE_LOG(LogTemp, Error, TEXT("You already have workers running, stop them before starting more."));
+		return;
+	}
+
+	ConfigureWorkDistributor(shutDownWorkersAfterCompletingTasks);
+	LensSolverWorkDistributor::GetInstance().PrepareTaskGraph();
+}
+
+/* Bind the delegates that LensSolverWorkDistributor uses to pass logs and finished jobs back to this class. */
+void ULensSolver::ConfigureWorkDistributor(bool shutDownWorkersAfterCompletingTasks)
+{
 	LensSolverWorkDistributor::GetInstance().Configure(queueLogOutputDel, queueFinishedJobOutputDel, shutDownWorkersAfterCompletingTasks);
 
 	if (queueLogOutputDel->IsBound())
@@ -313,8 +398,6 @@ void ULensSolver::StartBackgroundImageProcessors(int findCornersWorkerCount, int
 	queueFinishedJobOutputDel->BindUObject(this, &ULensSolver::QueueFinishedJob);
 
 	UE_LOG(LogTemp, Log, TEXT("Binded finished queue."));
-
-	LensSolverWorkDistributor::GetInstance().PrepareWorkers(findCornersWorkerCount, calibrateWorkerCount);
 }
 
 void ULensSolver::StopBackgroundImageprocessors()
@@ -347,8 +430,21 @@ void ULensSolver::PollCalibrationResults()
 			*queueContainer.calibrationResult.baseParameters.calibrationID, 
 			*queueContainer.calibrationResult.baseParameters.jobID);
 
-		if (queueContainer.eventReceiver.GetObject()->IsValidLowLevel())
-			ILensSolverEventReceiver::Execute_OnReceiveCalibrationResult(queueContainer.eventReceiver.GetObject(), queueContainer.calibrationResult);
+		/* Provisional results are delivered before the calibration is finished, so only final results count towards the end to end latency. */
+		FPipelineTimestamps & pipelineTimestamps = queueContainer.calibrationResult.baseParameters.pipelineTimestamps;
+		pipelineTimestamps.delivered = FPlatformTime::Seconds();
+		LensSolverPipelineLatency::Get().Record(UPipelineStage::Delivery, pipelineTimestamps.solved, pipelineTimestamps.delivered);
+		if (!queueContainer.calibrationResult.provisional)
+			LensSolverPipelineLatency::Get().Record(UPipelineStage::EndToEnd, pipelineTimestamps.queued, pipelineTimestamps.delivered);
+
+		if (queueContainer.eventReceiver.GetObject() != nullptr && queueContainer.eventReceiver.GetObject()->IsValidLowLevel())
+		{
+			if (queueContainer.calibrationResult.provisional)
+				ILensSolverEventReceiver::Execute_OnReceiveProvisionalCalibrationResult(queueContainer.eventReceiver.GetObject(), queueContainer.calibrationResult);
+			else
+				ILensSolverEventReceiver::Execute_OnReceiveCalibrationResult(queueContainer.eventReceiver.GetObject(), queueContainer.calibrationResult);
+		}
+		onCalibrationResultNativeDel.Broadcast(queueContainer.calibrationResult);
 
 		isQueued = LensSolverWorkDistributor::GetInstance().CalibrationResultIsQueued();
 	}
@@ -361,10 +457,18 @@ void ULensSolver::PollFinishedJobs()
 	{
 		FinishedJobQueueContainer queueContainer;
 		DequeuedFinishedJob(queueContainer);
-		UE_LOG(LogTemp, Log, TEXT("Completed job: \"%s\", job will be unregistered."), *queueContainer.jobInfo.jobID);
+		if (queueContainer.jobInfo.failed)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed job: \"%s\", job was unregistered."), *queueContainer.jobInfo.jobID);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Completed job: \"%s\", job will be unregistered."), *queueContainer.jobInfo.jobID);
+		}
 
-		if (queueContainer.eventReceiver.GetObject()->IsValidLowLevel())
+		if (queueContainer.eventReceiver.GetObject() != nullptr && queueContainer.eventReceiver.GetObject()->IsValidLowLevel())
 			ILensSolverEventReceiver::Execute_OnFinishedJob(queueContainer.eventReceiver.GetObject(), queueContainer.jobInfo);
+		onFinishedJobNativeDel.Broadcast(queueContainer.jobInfo);
 
 		isQueued = queuedFinishedJobs.IsEmpty() == false;
 	}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensSolverBoardPrefilter.h"
+
+#include "LensSolverUtilities.h"
+
+/* The image is reduced to a grid at least this many samples wide regardless of it's resolution, 
+the grid is made finer for boards with many squares, see prefilterMinimumBoardFraction. */
+static const int prefilterSampleWidth = 320;
+
+/* Each grid sample averages this many by this many taps spread evenly over the block of pixels it covers. 
+A fixed tap count keeps the cost independent of the image resolution, while averaging a few taps 
+still keeps texture finer than the grid from aliasing into corner like noise. */
+static const int prefilterTapsPerSample = 2;
+
+/* The smallest board the prefilter is expected to pass spans this fraction of the image's width. */
+static const float prefilterMinimumBoardFraction = 0.25f;
+
+/* Radius in grid samples of the ring of 16 samples the corner response is measured on, it is scaled to half 
+the width of the smallest expected square so the ring stays inside the four squares around a corner. */
+static const int prefilterMinimumRingRadius = 3;
+static const int prefilterMaximumRingRadius = 5;
+
+/* An ideal corner with a contrast of C between it's squares responds with 8 * C. */
+static const int prefilterMinimumResponse = 64;
+
+/* Fraction of the board's corners that have to respond, blur and perspective hide some of them. */
+static const float prefilterMinimumCornerFraction = 0.5f;
+
+/* Average prefilterTapsPerSample squared taps per grid sample, BGRA pixels are converted to luma with the same weights 
+as the blit shader and the rest of the pipeline. */
+static void SampleGrid(
+	const uint8 * pixels,
+	int width,
+	int height,
+	int stride,
+	int step,
+	uint8 * outputGrid,
+	int gridWidth,
+	int gridHeight)
+{
+	const int tapCount = prefilterTapsPerSample * prefilterTapsPerSample;
+
+	/* The luma weights in 8 bit fixed point, so the taps are summed as integers. */
+	const FVector & lumaWeights = LensSolverUtilities::blitShaderLumaWeights;
+	const uint32 weightR = FMath::RoundToInt(lumaWeights.X * 256.0f);
+	const uint32 weightG = FMath::RoundToInt(lumaWeights.Y * 256.0f);
+	const uint32 weightB = 256 - weightR - weightG;
+
+	/* Tap offsets inside a block of step pixels, centered in equal sub blocks. */
+	int tapOffsets[prefilterTapsPerSample];
+	for (int i = 0; i < prefilterTapsPerSample; i++)
+		tapOffsets[i] = FMath::Min((2 * i + 1) * step / (2 * prefilterTapsPerSample), step - 1);
+
+	/* Byte offsets of the tap columns of every grid sample, the same for every row. */
+	TArray<int> columnOffsets;
+	columnOffsets.SetNumUninitialized(gridWidth * prefilterTapsPerSample);
+	for (int x = 0; x < gridWidth; x++)
+		for (int tx = 0; tx < prefilterTapsPerSample; tx++)
+			columnOffsets[x * prefilterTapsPerSample + tx] = FMath::Min(x * step + tapOffsets[tx], width - 1) * stride;
+
+	for (int y = 0; y < gridHeight; y++)
+	{
+		const uint8 * tapRows[prefilterTapsPerSample];
+		for (int ty = 0; ty < prefilterTapsPerSample; ty++)
+			tapRows[ty] = pixels + (int64)FMath::Min(y * step + tapOffsets[ty], height - 1) * width * stride;
+
+		const int * columnOffset = columnOffsets.GetData();
+		uint8 * outputRow = outputGrid + (int64)y * gridWidth;
+
+		for (int x = 0; x < gridWidth; x++, columnOffset += prefilterTapsPerSample)
+		{
+			uint32 sum = 0;
+			for (int ty = 0; ty < prefilterTapsPerSample; ty++)
+			{
+				for (int tx = 0; tx < prefilterTapsPerSample; tx++)
+				{
+					const uint8 * pixel = tapRows[ty] + columnOffset[tx];
+					sum += stride == 1 ? pixel[0] * 256u : pixel[2] * weightR + pixel[1] * weightG + pixel[0] * weightB;
+				}
+			}
+
+			outputRow[x] = (uint8)((sum + tapCount * 128) / (tapCount * 256));
+		}
+	}
+}
+
+bool LensSolverBoardPrefilter::MayContainBoard(
+	const uint8 * pixels,
+	int width,
+	int height,
+	int stride,
+	int cornerCountX,
+	int cornerCountY,
+	int & outputCornerResponseCount)
+{
+	outputCornerResponseCount = 0;
+
+	/* The board may be rotated, so assume it's longest side lies along the image's width. */
+	const int squaresAcross = FMath::Max(cornerCountX, cornerCountY) + 1;
+	const int minimumSampleWidth = FMath::CeilToInt(squaresAcross * prefilterMinimumRingRadius * 2 / prefilterMinimumBoardFraction);
+
+	const int step = FMath::Max(width / FMath::Max(prefilterSampleWidth, minimumSampleWidth), 1);
+	const int gridWidth = width / step;
+	const int gridHeight = height / step;
+
+	const float squareSamples = gridWidth * prefilterMinimumBoardFraction / squaresAcross;
+	const int ringRadius = FMath::Clamp(FMath::FloorToInt(squareSamples * 0.5f), prefilterMinimumRingRadius, prefilterMaximumRingRadius);
+
+	/* Too small to judge, let the full search decide. */
+	if (gridWidth <= ringRadius * 2 + 2 || gridHeight <= ringRadius * 2 + 2)
+		return true;
+
+	TArray<uint8> grid;
+	grid.SetNumUninitialized(gridWidth * gridHeight);
+	SampleGrid(pixels, width, height, stride, step, grid.GetData(), gridWidth, gridHeight);
+
+	/* Ring of 16 offsets at the prefilter radius, ordered around the circle, as offsets into the grid. */
+	static const float ringAngles = 2.0f * PI / 16.0f;
+	int ringOffsets[16];
+	for (int i = 0; i < 16; i++)
+	{
+		const int ringX = FMath::RoundToInt(FMath::Cos(i * ringAngles) * ringRadius);
+		const int ringY = FMath::RoundToInt(FMath::Sin(i * ringAngles) * ringRadius);
+		ringOffsets[i] = ringY * gridWidth + ringX;
+	}
+
+	TArray<int> responses;
+	responses.SetNumZeroed(gridWidth * gridHeight);
+
+	const int firstX = ringRadius;
+	const int endX = gridWidth - ringRadius;
+
+	int maxResponse = 0;
+	for (int y = ringRadius; y < gridHeight - ringRadius; y++)
+	{
+		const uint8 * gridRow = grid.GetData() + y * gridWidth;
+		int * responseRow = responses.GetData() + y * gridWidth;
+
+		for (int x = firstX; x < endX; x++)
+		{
+			const uint8 * center = gridRow + x;
+
+			int ring[16];
+			int ringSum = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				ring[i] = center[ringOffsets[i]];
+				ringSum += ring[i];
+			}
+
+			/* Opposite samples on a chessboard corner match while samples a quarter turn apart differ, edges 
+			have differing opposite samples and a blob's center differs from the ring around it. */
+			int sumResponse = 0, differenceResponse = 0;
+			for (int i = 0; i < 4; i++)
+				sumResponse += FMath::Abs(ring[i] + ring[i + 8] - ring[i + 4] - ring[i + 12]);
+			for (int i = 0; i < 8; i++)
+				differenceResponse += FMath::Abs(ring[i] - ring[i + 8]);
+
+			/* As in ChESS the center is the mean of the sample and it's four neighbours, a single sample that 
+			lands right on a corner takes the value of one square. This is 16 * |local mean - ring mean|. */
+			const int localSum = center[0] + center[-1] + center[1] + center[-gridWidth] + center[gridWidth];
+			const int meanResponse = FMath::Abs(16 * localSum - 5 * ringSum) / 5;
+
+			const int response = sumResponse - differenceResponse - meanResponse;
+			responseRow[x] = response;
+			maxResponse = FMath::Max(maxResponse, response);
+		}
+	}
+
+	const int threshold = FMath::Max(prefilterMinimumResponse, maxResponse / 4);
+
+	/* Count each corner once by only counting local maxima. */
+	for (int y = ringRadius; y < gridHeight - ringRadius; y++)
+	{
+		for (int x = firstX; x < endX; x++)
+		{
+			const int response = responses[y * gridWidth + x];
+			if (response < threshold)
+				continue;
+
+			/* Ties go to the first sample in scan order, so a plateau counts once. */
+			bool isMaximum = true;
+			for (int ny = -1; ny <= 1 && isMaximum; ny++)
+			{
+				for (int nx = -1; nx <= 1 && isMaximum; nx++)
+				{
+					if (nx == 0 && ny == 0)
+						continue;
+
+					const int neighbour = responses[(y + ny) * gridWidth + (x + nx)];
+					const bool isBefore = ny < 0 || (ny == 0 && nx < 0);
+					if (neighbour > response || (isBefore && neighbour == response))
+						isMaximum = false;
+				}
+			}
+
+			if (isMaximum)
+				outputCornerResponseCount++;
+		}
+	}
+
+	return outputCornerResponseCount >= FMath::CeilToInt(cornerCountX * cornerCountY * prefilterMinimumCornerFraction);
+}
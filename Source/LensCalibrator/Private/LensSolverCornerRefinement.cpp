@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensSolverCornerRefinement.h"
+
+static const int maxRefinementIterations = 40;
+static const float refinementEpsilon = 0.01f;
+
+int LensSolverCornerRefinement::RefineCorners(
+	const uint8 * pixels,
+	int width,
+	int height,
+	float * corners,
+	int cornerCount,
+	int windowRadius)
+{
+	if (pixels == nullptr || corners == nullptr || windowRadius <= 0)
+		return 0;
+
+	/* Gaussian weights over the window so pixels near the estimate count the most. */
+	const int windowSize = windowRadius * 2 + 1;
+	const float sigma = FMath::Max(windowRadius * 0.5f, 1.0f);
+
+	TArray<float> weights;
+	weights.SetNumUninitialized(windowSize * windowSize);
+	for (int y = -windowRadius; y <= windowRadius; y++)
+		for (int x = -windowRadius; x <= windowRadius; x++)
+			weights[(y + windowRadius) * windowSize + (x + windowRadius)] = FMath::Exp(-(x * x + y * y) / (2.0f * sigma * sigma));
+
+	int refinedCount = 0;
+	for (int i = 0; i < cornerCount; i++)
+	{
+		float cornerX = corners[i * 2];
+		float cornerY = corners[i * 2 + 1];
+
+		if (!RefineCorner(pixels, width, height, weights, windowRadius, cornerX, cornerY))
+			continue;
+
+		corners[i * 2] = cornerX;
+		corners[i * 2 + 1] = cornerY;
+		refinedCount++;
+	}
+
+	return refinedCount;
+}
+
+float LensSolverCornerRefinement::MinCornerSpacing(
+	const float * corners,
+	int cornerCountX,
+	int cornerCountY)
+{
+	float minimumSpacing = MAX_flt;
+
+	/* Corners are ordered row by row, so compare each corner with it's neighbour in the row and the column. */
+	for (int y = 0; y < cornerCountY; y++)
+	{
+		for (int x = 0; x < cornerCountX; x++)
+		{
+			int i = y * cornerCountX + x;
+			if (x > 0)
+				minimumSpacing = FMath::Min(minimumSpacing, FVector2D::Distance(FVector2D(corners[i * 2], corners[i * 2 + 1]), FVector2D(corners[(i - 1) * 2], corners[(i - 1) * 2 + 1])));
+			if (y > 0)
+				minimumSpacing = FMath::Min(minimumSpacing, FVector2D::Distance(FVector2D(corners[i * 2], corners[i * 2 + 1]), FVector2D(corners[(i - cornerCountX) * 2], corners[(i - cornerCountX) * 2 + 1])));
+		}
+	}
+
+	return minimumSpacing;
+}
+
+int LensSolverCornerRefinement::MaxWindowRadius(
+	const float * corners,
+	int cornerCountX,
+	int cornerCountY)
+{
+	float minimumSpacing = MinCornerSpacing(corners, cornerCountX, cornerCountY);
+	if (minimumSpacing == MAX_flt)
+		return MAX_int32;
+
+	return FMath::Max(FMath::FloorToInt(minimumSpacing * 0.5f) - 1, 1);
+}
+
+bool LensSolverCornerRefinement::RefineCorner(
+	const uint8 * pixels,
+	int width,
+	int height,
+	const TArray<float> & weights,
+	int windowRadius,
+	float & cornerX,
+	float & cornerY)
+{
+	auto sample = [pixels, width, height](float x, float y)
+	{
+		x = FMath::Clamp(x, 0.0f, width - 1.0f);
+		y = FMath::Clamp(y, 0.0f, height - 1.0f);
+
+		int x0 = FMath::FloorToInt(x), y0 = FMath::FloorToInt(y);
+		int x1 = FMath::Min(x0 + 1, width - 1), y1 = FMath::Min(y0 + 1, height - 1);
+		float fractionX = x - x0, fractionY = y - y0;
+
+		return FMath::Lerp(
+			FMath::Lerp((float)pixels[(int64)y0 * width + x0], (float)pixels[(int64)y0 * width + x1], fractionX),
+			FMath::Lerp((float)pixels[(int64)y1 * width + x0], (float)pixels[(int64)y1 * width + x1], fractionX),
+			fractionY);
+	};
+
+	const int windowSize = windowRadius * 2 + 1;
+	const float initialX = cornerX, initialY = cornerY;
+
+	float x = cornerX, y = cornerY;
+	bool converged = false;
+	for (int iteration = 0; iteration < maxRefinementIterations; iteration++)
+	{
+		/* At the corner, the image gradient at every point around it is orthogonal to the vector from 
+		the corner to that point, so the corner is the least squares solution of sum(g * g^T) * q = sum(g * g^T * p). */
+		float a = 0.0f, b = 0.0f, c = 0.0f, bx = 0.0f, by = 0.0f;
+
+		for (int wy = -windowRadius; wy <= windowRadius; wy++)
+		{
+			for (int wx = -windowRadius; wx <= windowRadius; wx++)
+			{
+				float px = x + wx, py = y + wy;
+				float gradientX = (sample(px + 1.0f, py) - sample(px - 1.0f, py)) * 0.5f;
+				float gradientY = (sample(px, py + 1.0f) - sample(px, py - 1.0f)) * 0.5f;
+
+				float weight = weights[(wy + windowRadius) * windowSize + (wx + windowRadius)];
+				float gxx = gradientX * gradientX * weight;
+				float gxy = gradientX * gradientY * weight;
+				float gyy = gradientY * gradientY * weight;
+
+				a += gxx;
+				b += gxy;
+				c += gyy;
+
+				bx += gxx * px + gxy * py;
+				by += gxy * px + gyy * py;
+			}
+		}
+
+		/* A flat or single edge window has no unique solution. */
+		float determinant = a * c - b * b;
+		if (FMath::Abs(determinant) <= KINDA_SMALL_NUMBER * FMath::Max(a * c, 1.0f))
+			return false;
+
+		float nextX = (c * bx - b * by) / determinant;
+		float nextY = (a * by - b * bx) / determinant;
+
+		float shift = FMath::Square(nextX - x) + FMath::Square(nextY - y);
+		x = nextX;
+		y = nextY;
+
+		if (shift <= refinementEpsilon * refinementEpsilon)
+		{
+			converged = true;
+			break;
+		}
+	}
+
+	/* Still moving after the last iteration, the window is oscillating between solutions. */
+	if (!converged)
+		return false;
+
+	/* Reject corners that wandered out of their window, they likely locked on to a neighbour. */
+	if (FMath::Abs(x - initialX) > windowRadius || FMath::Abs(y - initialY) > windowRadius)
+		return false;
+
+	cornerX = x;
+	cornerY = y;
+	return true;
+}
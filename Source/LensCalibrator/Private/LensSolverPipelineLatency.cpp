@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensSolverPipelineLatency.h"
+
+#include "LensCalibratorStats.h"
+
+static const float firstBucketUpperBoundMS = 0.25f;
+
+LensSolverPipelineLatency::LensSolverPipelineLatency()
+{
+	Reset();
+}
+
+void LensSolverPipelineLatency::Record(UPipelineStage stage, double startSeconds, double endSeconds)
+{
+	if (startSeconds <= 0.0 || endSeconds < startSeconds)
+		return;
+
+	float milliseconds = (float)((endSeconds - startSeconds) * 1000.0);
+
+	switch (stage)
+	{
+	case UPipelineStage::ReadAndDecode:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorReadAndDecodeLatency, milliseconds);
+		break;
+	case UPipelineStage::QueueWait:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorQueueWaitLatency, milliseconds);
+		break;
+	case UPipelineStage::CornerDetection:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerDetectionLatency, milliseconds);
+		break;
+	case UPipelineStage::LatchWait:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorLatchWaitLatency, milliseconds);
+		break;
+	case UPipelineStage::CalibrateQueueWait:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorCalibrateQueueWaitLatency, milliseconds);
+		break;
+	case UPipelineStage::Solve:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorSolveLatency, milliseconds);
+		break;
+	case UPipelineStage::Delivery:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorDeliveryLatency, milliseconds);
+		break;
+	case UPipelineStage::EndToEnd:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorEndToEndLatency, milliseconds);
+		INC_DWORD_STAT(STAT_LensCalibratorCalibrationsDelivered);
+		break;
+	case UPipelineStage::Prefilter:
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorPrefilterTime, milliseconds);
+		break;
+	}
+
+	int bucket = GetBucket(milliseconds);
+
+	latencyLock.Lock();
+	FStageHistogram & histogram = histograms[(int)stage];
+	histogram.minMS = histogram.sampleCount == 0 ? milliseconds : FMath::Min(histogram.minMS, milliseconds);
+	histogram.maxMS = histogram.sampleCount == 0 ? milliseconds : FMath::Max(histogram.maxMS, milliseconds);
+	histogram.sampleCount++;
+	histogram.sumMS += milliseconds;
+	histogram.buckets[bucket]++;
+	latencyLock.Unlock();
+}
+
+void LensSolverPipelineLatency::GetSnapshot(FPipelineLatencySnapshot & outputSnapshot)
+{
+	latencyLock.Lock();
+	FStageHistogram stageHistograms[stageCount];
+	FMemory::Memcpy(stageHistograms, histograms, sizeof(histograms));
+	double snapshotResetSeconds = resetSeconds;
+	latencyLock.Unlock();
+
+	outputSnapshot.stages.SetNum(stageCount);
+	outputSnapshot.histogramBucketUpperBoundsMS.SetNum(bucketCount);
+	outputSnapshot.secondsSinceReset = (float)(FPlatformTime::Seconds() - snapshotResetSeconds);
+
+	for (int bucket = 0; bucket < bucketCount; bucket++)
+		outputSnapshot.histogramBucketUpperBoundsMS[bucket] = GetBucketUpperBound(bucket);
+
+	for (int stage = 0; stage < stageCount; stage++)
+	{
+		const FStageHistogram & histogram = stageHistograms[stage];
+		FPipelineStageLatency & stageLatency = outputSnapshot.stages[stage];
+
+		stageLatency.stage			= (UPipelineStage)stage;
+		stageLatency.sampleCount	= histogram.sampleCount;
+		stageLatency.averageMS		= histogram.sampleCount > 0 ? (float)(histogram.sumMS / histogram.sampleCount) : 0.0f;
+		stageLatency.minMS			= histogram.minMS;
+		stageLatency.maxMS			= histogram.maxMS;
+		stageLatency.p50MS			= GetPercentile(histogram, 0.5f);
+		stageLatency.p95MS			= GetPercentile(histogram, 0.95f);
+		stageLatency.p99MS			= GetPercentile(histogram, 0.99f);
+		stageLatency.histogram		= TArray<int>(histogram.buckets, bucketCount);
+	}
+}
+
+void LensSolverPipelineLatency::Reset()
+{
+	latencyLock.Lock();
+	FMemory::Memzero(histograms, sizeof(histograms));
+	resetSeconds = FPlatformTime::Seconds();
+	latencyLock.Unlock();
+}
+
+int LensSolverPipelineLatency::GetBucket(float milliseconds)
+{
+	if (milliseconds < firstBucketUpperBoundMS)
+		return 0;
+
+	int bucket = FMath::FloorToInt(FMath::Log2(milliseconds / firstBucketUpperBoundMS)) + 1;
+	return FMath::Clamp(bucket, 0, bucketCount - 1);
+}
+
+float LensSolverPipelineLatency::GetBucketUpperBound(int bucket)
+{
+	return firstBucketUpperBoundMS * (float)(1 << bucket);
+}
+
+float LensSolverPipelineLatency::GetPercentile(const FStageHistogram & histogram, float percentile)
+{
+	if (histogram.sampleCount == 0)
+		return 0.0f;
+
+	int rank = FMath::Max(FMath::CeilToInt(histogram.sampleCount * percentile), 1);
+	int cumulativeCount = 0;
+
+	for (int bucket = 0; bucket < bucketCount; bucket++)
+	{
+		cumulativeCount += histogram.buckets[bucket];
+		if (cumulativeCount < rank)
+			continue;
+
+		/* The last bucket has no upper bound and no bucket bound is more useful than the largest sample. */
+		if (bucket == bucketCount - 1)
+			return histogram.maxMS;
+
+		return FMath::Clamp(GetBucketUpperBound(bucket), histogram.minMS, histogram.maxMS);
+	}
+
+	return histogram.maxMS;
+}
@@ -360,6 +360,172 @@ bool LensSolverUtilities::LoadTexture16(FString absoluteTexturePath, UTexture2D*
 	return true;
 }
 
+bool LensSolverUtilities::DecodeImage(
+	const TArray<uint8> & fileData,
+	const FString & absoluteFilePath,
+	TArray64<uint8> & outputPixels,
+	int & outputWidth,
+	int & outputHeight)
+{
+	IImageWrapperModule& imageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	EImageFormat format = imageWrapperModule.DetectImageFormat(fileData.GetData(), fileData.Num());
+	if (format == EImageFormat::Invalid)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unrecognized image file format in file: \"%s\"."), *absoluteFilePath);
+		return false;
+	}
+
+	TSharedPtr<IImageWrapper> imageWrapper = imageWrapperModule.CreateImageWrapper(format);
+	if (!imageWrapper.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create image wrapper for file: \"%s\"."), *absoluteFilePath);
+		return false;
+	}
+
+	if (!imageWrapper->SetCompressed(fileData.GetData(), fileData.Num()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to decompress image data in file: \"%s\"."), *absoluteFilePath);
+		return false;
+	}
+
+	if (!imageWrapper->GetRaw(ERGBFormat::BGRA, 8, outputPixels))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to get raw data in file: \"%s\"."), *absoluteFilePath);
+		return false;
+	}
+
+	outputWidth = imageWrapper->GetWidth();
+	outputHeight = imageWrapper->GetHeight();
+
+	if (outputWidth <= 0 || outputHeight <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Image width or height is <= 0 in file: \"%s\"."), *absoluteFilePath);
+		return false;
+	}
+
+	return true;
+}
+
+const FVector LensSolverUtilities::blitShaderLumaWeights(0.21f, 0.72f, 0.07f);
+const FVector LensSolverUtilities::openCVLumaWeights(0.299f, 0.587f, 0.114f);
+
+void LensSolverUtilities::ResampleToGrayscale(
+	const uint8 * sourcePixels,
+	int sourceWidth,
+	int sourceHeight,
+	uint8 * outputPixels,
+	int outputWidth,
+	int outputHeight,
+	bool flipX,
+	bool flipY,
+	const FVector & lumaWeights)
+{
+	auto luminance = [sourcePixels, sourceWidth, &lumaWeights](int x, int y)
+	{
+		const uint8 * pixel = sourcePixels + ((int64)y * sourceWidth + x) * 4;
+		return pixel[2] * lumaWeights.X + pixel[1] * lumaWeights.Y + pixel[0] * lumaWeights.Z;
+	};
+
+	bool resize = sourceWidth != outputWidth || sourceHeight != outputHeight;
+	float scaleX = sourceWidth / (float)outputWidth;
+	float scaleY = sourceHeight / (float)outputHeight;
+
+	/* Average the block of source pixels each output pixel covers, the same way as DownsampleGrayscale. */
+	if (resize && outputWidth <= sourceWidth && outputHeight <= sourceHeight)
+	{
+		for (int y = 0; y < outputHeight; y++)
+		{
+			uint8 * outputRow = outputPixels + (int64)(flipY ? outputHeight - 1 - y : y) * outputWidth;
+
+			int startY = (int)((int64)y * sourceHeight / outputHeight);
+			int endY = FMath::Max((int)((int64)(y + 1) * sourceHeight / outputHeight), startY + 1);
+
+			for (int x = 0; x < outputWidth; x++)
+			{
+				int startX = (int)((int64)x * sourceWidth / outputWidth);
+				int endX = FMath::Max((int)((int64)(x + 1) * sourceWidth / outputWidth), startX + 1);
+
+				float sum = 0.0f;
+				for (int sy = startY; sy < endY; sy++)
+					for (int sx = startX; sx < endX; sx++)
+						sum += luminance(sx, sy);
+
+				float gray = sum / ((endY - startY) * (endX - startX));
+				outputRow[flipX ? outputWidth - 1 - x : x] = (uint8)FMath::Clamp(FMath::RoundToInt(gray), 0, 255);
+			}
+		}
+
+		return;
+	}
+
+	for (int y = 0; y < outputHeight; y++)
+	{
+		uint8 * outputRow = outputPixels + (int64)(flipY ? outputHeight - 1 - y : y) * outputWidth;
+
+		/* Sample the source at the center of the output pixel. */
+		float sourceY = FMath::Clamp((y + 0.5f) * scaleY - 0.5f, 0.0f, sourceHeight - 1.0f);
+		int y0 = FMath::FloorToInt(sourceY);
+		int y1 = FMath::Min(y0 + 1, sourceHeight - 1);
+		float fractionY = sourceY - y0;
+
+		for (int x = 0; x < outputWidth; x++)
+		{
+			float gray = 0.0f;
+			if (!resize)
+				gray = luminance(x, y);
+
+			else
+			{
+				float sourceX = FMath::Clamp((x + 0.5f) * scaleX - 0.5f, 0.0f, sourceWidth - 1.0f);
+				int x0 = FMath::FloorToInt(sourceX);
+				int x1 = FMath::Min(x0 + 1, sourceWidth - 1);
+				float fractionX = sourceX - x0;
+
+				gray = FMath::Lerp(
+					FMath::Lerp(luminance(x0, y0), luminance(x1, y0), fractionX),
+					FMath::Lerp(luminance(x0, y1), luminance(x1, y1), fractionX),
+					fractionY);
+			}
+
+			outputRow[flipX ? outputWidth - 1 - x : x] = (uint8)FMath::Clamp(FMath::RoundToInt(gray), 0, 255);
+		}
+	}
+}
+
+void LensSolverUtilities::DownsampleGrayscale(
+	const uint8 * sourcePixels,
+	int sourceWidth,
+	int sourceHeight,
+	uint8 * outputPixels,
+	int outputWidth,
+	int outputHeight)
+{
+	for (int y = 0; y < outputHeight; y++)
+	{
+		/* The block of source rows covered by this output row, at least one row. */
+		int startY = (int)((int64)y * sourceHeight / outputHeight);
+		int endY = FMath::Max((int)((int64)(y + 1) * sourceHeight / outputHeight), startY + 1);
+
+		for (int x = 0; x < outputWidth; x++)
+		{
+			int startX = (int)((int64)x * sourceWidth / outputWidth);
+			int endX = FMath::Max((int)((int64)(x + 1) * sourceWidth / outputWidth), startX + 1);
+
+			uint32 sum = 0;
+			for (int sy = startY; sy < endY; sy++)
+			{
+				const uint8 * sourceRow = sourcePixels + (int64)sy * sourceWidth;
+				for (int sx = startX; sx < endX; sx++)
+					sum += sourceRow[sx];
+			}
+
+			uint32 count = (endY - startY) * (endX - startX);
+			outputPixels[(int64)y * outputWidth + x] = (uint8)((sum + count / 2) / count);
+		}
+	}
+}
+
 /* Load normal texture from file. */
 bool LensSolverUtilities::LoadTexture(FString absoluteTexturePath, UTexture2D*& texture)
 {
@@ -453,13 +619,27 @@ bool LensSolverUtilities::WriteTexture16(
 	int width,
 	int height,
 	TUniquePtr<TImagePixelData<FFloat16Color>> data)
+{
+	TFuture<bool> dispatchedTask = WriteTexture16Async(absoluteTexturePath, width, height, MoveTemp(data));
+	if (!dispatchedTask.IsValid())
+		return false;
+
+	dispatchedTask.Wait();
+	return true;
+}
+
+TFuture<bool> LensSolverUtilities::WriteTexture16Async(
+	FString absoluteTexturePath,
+	int width,
+	int height,
+	TUniquePtr<TImagePixelData<FFloat16Color>> data)
 {
 	/* Texture writing is in a separate module and we need to get a handle to it. */
 	IImageWriteQueueModule* imageWriteQueueModule = FModuleManager::Get().GetModulePtr<IImageWriteQueueModule>("ImageWriteQueue");
 	if (imageWriteQueueModule == nullptr)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Unable to retrieve ImageWriteQueue."));
-		return false;
+		return TFuture<bool>();
 	}
 
 	TUniquePtr<FImageWriteTask> imageTask = MakeUnique<FImageWriteTask>();
@@ -472,11 +652,6 @@ bool LensSolverUtilities::WriteTexture16(
 	imageTask->PixelData = MoveTemp(data);
 
 	/* Enqueue texture write to file. */
-	TFuture<bool> dispatchedTask = imageWriteQueueModule->GetWriteQueue().Enqueue(MoveTemp(imageTask));
-
-	if (dispatchedTask.IsValid())
-		dispatchedTask.Wait();
-
-	return true;
+	return imageWriteQueueModule->GetWriteQueue().Enqueue(MoveTemp(imageTask));
 }
 
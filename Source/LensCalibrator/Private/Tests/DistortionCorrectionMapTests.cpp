@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#include "DistortionCorrectionMapGenerator.h"
+#include "DistortionCorrectionVolumePacker.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/* An off center principal point and a width that isn't a multiple of four, so both the SIMD blocks and the scalar tail of each row are covered. */
+static FDistortionCorrectionMapGenerationParameters MakeTestMapParameters(float k1, float k2, float k3)
+{
+	FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams;
+	distortionCorrectionMapGenerationParams.sourceResolution = FIntPoint(1920, 1080);
+	distortionCorrectionMapGenerationParams.sourcePrincipalPixelPoint = FVector2D(864.0f, 594.0f);
+	distortionCorrectionMapGenerationParams.outputMapResolution = FIntPoint(66, 50);
+	distortionCorrectionMapGenerationParams.k1 = k1;
+	distortionCorrectionMapGenerationParams.k2 = k2;
+	distortionCorrectionMapGenerationParams.k3 = k3;
+	return distortionCorrectionMapGenerationParams;
+}
+
+/* Distorting every pixel of the Newton's method inverse map lands it back where it came from, for both pin cushion and barrel distortion. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDistortionCorrectionInverseMapRoundTripTest, "LensCalibrator.DistortionCorrection.InverseMapRoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDistortionCorrectionInverseMapRoundTripTest::RunTest(const FString & Parameters)
+{
+	const FDistortionCorrectionMapGenerationParameters lensModels[] =
+	{
+		MakeTestMapParameters(-0.2f, 0.05f, 0.0f),
+		MakeTestMapParameters(0.15f, 0.02f, 0.01f)
+	};
+
+	for (const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams : lensModels)
+	{
+		TArray<FFloat16Color> inversePixels;
+		DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, true, inversePixels);
+		TestEqual(TEXT("Inverse map pixel count"), inversePixels.Num(), 66 * 50);
+
+		/* Half floats hold UVs to about 1/2048, a few hundredths of an output pixel at this size. */
+		int failedPixelCount = 0;
+		const float maxError = DistortionCorrectionMapGenerator::MeasureInverseRoundTripError(distortionCorrectionMapGenerationParams, inversePixels, failedPixelCount);
+		TestEqual(TEXT("Inverse map failed pixel count"), failedPixelCount, 0);
+		TestTrue(FString::Printf(TEXT("Round trip error of k1: %f is below 0.05 pixels, the largest error is: %f"), distortionCorrectionMapGenerationParams.k1, maxError), maxError < 0.05f);
+	}
+
+	return true;
+}
+
+/* Without distortion the correction map is the identity, each pixel holds it's own UV. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDistortionCorrectionIdentityMapTest, "LensCalibrator.DistortionCorrection.IdentityMap", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDistortionCorrectionIdentityMapTest::RunTest(const FString & Parameters)
+{
+	const FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams = MakeTestMapParameters(0.0f, 0.0f, 0.0f);
+	const int width = distortionCorrectionMapGenerationParams.outputMapResolution.X;
+	const int height = distortionCorrectionMapGenerationParams.outputMapResolution.Y;
+
+	TArray<FFloat16Color> pixels;
+	DistortionCorrectionMapGenerator::GenerateMap(distortionCorrectionMapGenerationParams, false, pixels);
+
+	/* The first row is read back from the top of the render target, V = 1. */
+	float maxError = 0.0f;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			const FFloat16Color & pixel = pixels[y * width + x];
+			maxError = FMath::Max(maxError, FMath::Abs(pixel.R.GetFloat() - (x + 0.5f) / width));
+			maxError = FMath::Max(maxError, FMath::Abs(pixel.G.GetFloat() - (height - y - 0.5f) / height));
+		}
+	}
+
+	TestTrue(FString::Printf(TEXT("Identity map matches the pixel UVs, the largest error is: %f"), maxError), maxError < 1e-3f);
+	return true;
+}
+
+/* Packing keeps the R and G channels of every voxel of every slice in slice order and clears B and A, including the voxels past the last SIMD block. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDistortionCorrectionPackSlicesTest, "LensCalibrator.DistortionCorrection.PackSlices", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDistortionCorrectionPackSlicesTest::RunTest(const FString & Parameters)
+{
+	const int width = 5;
+	const int height = 3;
+	const int sliceCount = 3;
+	const int sliceVoxelCount = width * height;
+
+	TArray<TArray<FFloat16Color>> sliceData;
+	sliceData.SetNum(sliceCount);
+
+	TArray<const FFloat16Color*> slices;
+	for (int slice = 0; slice < sliceCount; slice++)
+	{
+		sliceData[slice].SetNum(sliceVoxelCount);
+		for (int i = 0; i < sliceVoxelCount; i++)
+		{
+			FFloat16Color & voxel = sliceData[slice][i];
+			voxel.R = FFloat16(slice + i * 0.01f);
+			voxel.G = FFloat16(-slice - i * 0.02f);
+			voxel.B = FFloat16(0.5f);
+			voxel.A = FFloat16(1.0f);
+		}
+
+		slices.Add(sliceData[slice].GetData());
+	}
+
+	TArray<FFloat16Color> voxels;
+	voxels.SetNumUninitialized(sliceCount * sliceVoxelCount);
+	DistortionCorrectionVolumePacker::PackSlices(slices, width, height, voxels.GetData());
+
+	bool channelsMatch = true;
+	for (int slice = 0; slice < sliceCount; slice++)
+	{
+		for (int i = 0; i < sliceVoxelCount; i++)
+		{
+			const FFloat16Color & source = sliceData[slice][i];
+			const FFloat16Color & voxel = voxels[slice * sliceVoxelCount + i];
+
+			channelsMatch &= voxel.R.Encoded == source.R.Encoded && voxel.G.Encoded == source.G.Encoded;
+			channelsMatch &= voxel.B.Encoded == 0 && voxel.A.Encoded == 0;
+		}
+	}
+
+	TestTrue(TEXT("Every voxel keeps R and G and clears B and A"), channelsMatch);
+	return true;
+}
+
+#endif
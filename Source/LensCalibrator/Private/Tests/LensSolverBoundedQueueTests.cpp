@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
+
+#include "LensSolverBoundedQueue.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/* The capacity is rounded up to a power of two, elements come out in the order they went in and the queue 
+reports full and empty instead of blocking, also after the positions have wrapped around the cells many times. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverBoundedQueueOrderTest, "LensCalibrator.BoundedQueue.Order", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverBoundedQueueOrderTest::RunTest(const FString & Parameters)
+{
+	TLensSolverBoundedQueue<int> queue(3);
+	TestEqual(TEXT("Capacity"), (int32)queue.Capacity(), 4);
+	TestTrue(TEXT("Empty after construction"), queue.IsEmpty());
+
+	int item = 0;
+	TestFalse(TEXT("Dequeue from an empty queue"), queue.Dequeue(item));
+
+	int next = 0, expected = 0;
+	for (int round = 0; round < 100; round++)
+	{
+		for (int i = 0; i < 4; i++)
+			TestTrue(TEXT("Enqueue below capacity"), queue.Enqueue(next++));
+		TestFalse(TEXT("Enqueue into a full queue"), queue.Enqueue(next));
+
+		for (int i = 0; i < 4; i++)
+		{
+			TestTrue(TEXT("Dequeue from a non empty queue"), queue.Dequeue(item));
+			TestEqual(TEXT("Dequeued in order"), item, expected++);
+		}
+
+		TestTrue(TEXT("Empty after dequeuing everything"), queue.IsEmpty());
+		TestFalse(TEXT("Dequeue from an emptied queue"), queue.Dequeue(item));
+	}
+
+	return true;
+}
+
+/* Every element enqueued by concurrent producers is dequeued exactly once by concurrent consumers. Each task both 
+produces and consumes, so the test can't stall when the task graph runs fewer tasks at once than were queued. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverBoundedQueueConcurrencyTest, "LensCalibrator.BoundedQueue.Concurrency", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverBoundedQueueConcurrencyTest::RunTest(const FString & Parameters)
+{
+	const int taskCount = 8;
+	const int itemsPerTask = 20000;
+	const int64 itemCount = (int64)taskCount * itemsPerTask;
+
+	TLensSolverBoundedQueue<int64> queue(64);
+
+	TArray<int64> dequeuedCounts, dequeuedSums;
+	dequeuedCounts.SetNumZeroed(taskCount + 1);
+	dequeuedSums.SetNumZeroed(taskCount + 1);
+
+	ParallelFor(taskCount, [&queue, &dequeuedCounts, &dequeuedSums, itemsPerTask](int32 task)
+	{
+		int64 item;
+		for (int i = 0; i < itemsPerTask; i++)
+		{
+			/* Items are numbered from 1 so the sum of everything dequeued is known. */
+			while (!queue.Enqueue((int64)task * itemsPerTask + i + 1))
+			{
+				if (queue.Dequeue(item))
+				{
+					dequeuedCounts[task]++;
+					dequeuedSums[task] += item;
+				}
+			}
+
+			if (queue.Dequeue(item))
+			{
+				dequeuedCounts[task]++;
+				dequeuedSums[task] += item;
+			}
+		}
+	});
+
+	int64 item;
+	while (queue.Dequeue(item))
+	{
+		dequeuedCounts[taskCount]++;
+		dequeuedSums[taskCount] += item;
+	}
+
+	int64 dequeuedCount = 0, dequeuedSum = 0;
+	for (int i = 0; i <= taskCount; i++)
+	{
+		dequeuedCount += dequeuedCounts[i];
+		dequeuedSum += dequeuedSums[i];
+	}
+
+	TestEqual(TEXT("Dequeued item count"), dequeuedCount, itemCount);
+	TestEqual(TEXT("Dequeued item sum"), dequeuedSum, itemCount * (itemCount + 1) / 2);
+	TestTrue(TEXT("Empty after draining"), queue.IsEmpty());
+
+	return true;
+}
+
+#endif
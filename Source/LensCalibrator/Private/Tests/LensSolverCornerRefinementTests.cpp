@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#include "LensSolverCornerRefinement.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int refinementTestImageSize = 200;
+static const float refinementTestSquareSize = 20.0f;
+
+/* Render an anti aliased chessboard with squares of refinementTestSquareSize pixels whose corners sit at offset plus 
+multiples of the square size, pixel centers are at integer coordinates like the corners refined by OpenCV. */
+static void RenderTestChessboard(FVector2D offset, TArray<uint8> & outputPixels)
+{
+	const int supersampleCount = 4;
+
+	outputPixels.SetNumUninitialized(refinementTestImageSize * refinementTestImageSize);
+	for (int y = 0; y < refinementTestImageSize; y++)
+	{
+		for (int x = 0; x < refinementTestImageSize; x++)
+		{
+			int whiteCount = 0;
+			for (int sy = 0; sy < supersampleCount; sy++)
+			{
+				for (int sx = 0; sx < supersampleCount; sx++)
+				{
+					const float sampleX = x - 0.5f + (sx + 0.5f) / supersampleCount;
+					const float sampleY = y - 0.5f + (sy + 0.5f) / supersampleCount;
+					const int square = FMath::FloorToInt((sampleX - offset.X) / refinementTestSquareSize) + FMath::FloorToInt((sampleY - offset.Y) / refinementTestSquareSize);
+					whiteCount += square & 1;
+				}
+			}
+
+			outputPixels[y * refinementTestImageSize + x] = (uint8)FMath::RoundToInt(whiteCount * 255.0f / (supersampleCount * supersampleCount));
+		}
+	}
+}
+
+/* Corner estimates that are off by more than a pixel are pulled back to within a quarter pixel of the true corners. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverCornerRefinementConvergenceTest, "LensCalibrator.CornerRefinement.Convergence", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverCornerRefinementConvergenceTest::RunTest(const FString & Parameters)
+{
+	const FVector2D offset(0.3f, 0.6f);
+	const int cornerCountX = 6;
+	const int cornerCountY = 6;
+	const int cornerCount = cornerCountX * cornerCountY;
+
+	TArray<uint8> pixels;
+	RenderTestChessboard(offset, pixels);
+
+	TArray<float> trueCorners, corners;
+	for (int y = 0; y < cornerCountY; y++)
+	{
+		for (int x = 0; x < cornerCountX; x++)
+		{
+			const float cornerX = offset.X + (x + 2) * refinementTestSquareSize;
+			const float cornerY = offset.Y + (y + 2) * refinementTestSquareSize;
+			trueCorners.Add(cornerX);
+			trueCorners.Add(cornerY);
+
+			corners.Add(cornerX + ((x + y) % 2 == 0 ? -1.2f : 1.2f));
+			corners.Add(cornerY + (x % 2 == 0 ? 0.9f : -0.9f));
+		}
+	}
+
+	const int windowRadius = LensSolverCornerRefinement::MaxWindowRadius(corners.GetData(), cornerCountX, cornerCountY);
+	TestTrue(TEXT("Window stays clear of the neighbouring corners"), windowRadius > 2 && windowRadius < refinementTestSquareSize * 0.5f);
+
+	const int refinedCount = LensSolverCornerRefinement::RefineCorners(pixels.GetData(), refinementTestImageSize, refinementTestImageSize, corners.GetData(), cornerCount, windowRadius);
+	TestEqual(TEXT("Refined corner count"), refinedCount, cornerCount);
+
+	float maxError = 0.0f;
+	for (int i = 0; i < cornerCount; i++)
+		maxError = FMath::Max(maxError, FVector2D::Distance(FVector2D(corners[i * 2], corners[i * 2 + 1]), FVector2D(trueCorners[i * 2], trueCorners[i * 2 + 1])));
+	TestTrue(FString::Printf(TEXT("Refined corners are within a quarter pixel, the largest error is: %f"), maxError), maxError < 0.25f);
+
+	return true;
+}
+
+/* A window without any gradient has no corner to converge to, so the estimate is kept and not counted as refined. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverCornerRefinementFlatWindowTest, "LensCalibrator.CornerRefinement.FlatWindow", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverCornerRefinementFlatWindowTest::RunTest(const FString & Parameters)
+{
+	TArray<uint8> pixels;
+	pixels.Init(128, refinementTestImageSize * refinementTestImageSize);
+
+	float corners[2] = { 100.3f, 99.7f };
+	const int refinedCount = LensSolverCornerRefinement::RefineCorners(pixels.GetData(), refinementTestImageSize, refinementTestImageSize, corners, 1, 5);
+
+	TestEqual(TEXT("Refined corner count"), refinedCount, 0);
+	TestEqual(TEXT("Estimate X is kept"), corners[0], 100.3f);
+	TestEqual(TEXT("Estimate Y is kept"), corners[1], 99.7f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#include "LensSolverWorkDistributor.h"
+#include "LensSolverPixelBufferPool.h"
+#include "LensSolverBoundedQueue.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/* A media stream frame's pixels should be copied once from the mapped staging texture into a pooled buffer and then only 
+be shared by reference on their way to a find corner worker, every frame after the first reusing the first frame's buffer. 
+The frames are queued through a distributor of our own to two registered find corner workers whose queues belong to the 
+test, the least loaded worker gets the frame and the idle one steals it, the way a worker thread would when it's queue is empty. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverPixelBufferOneCopyPerFrameTest, "LensCalibrator.PixelBuffers.OneCopyPerFrame", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverPixelBufferOneCopyPerFrameTest::RunTest(const FString & Parameters)
+{
+	const int width = 64;
+	const int height = 48;
+	const int stride = 1;
+	const int rowPitchInPixels = 80;
+	const int frameCount = 3;
+
+	/* A distributor of our own leaves the singleton's workers and pool alone. */
+	LensSolverWorkDistributor distributor;
+
+	TLensSolverBoundedQueue<FLensSolverPixelArrayWorkUnit> victimQueue(4);
+	TLensSolverBoundedQueue<FLensSolverPixelArrayWorkUnit> thiefQueue(4);
+	const FString victimWorkerID = FGuid::NewGuid().ToString();
+	const FString thiefWorkerID = FGuid::NewGuid().ToString();
+
+	/* Register the workers the way PrepareFindCornerWorkers does, except that the delegates are bound to the test's queues instead of worker threads. */
+	auto registerWorker = [&distributor](const FString & workerID, TLensSolverBoundedQueue<FLensSolverPixelArrayWorkUnit> & queue)
+	{
+		distributor.workLoadSortedFindCornerWorkers.Add(workerID);
+
+		FWorkerFindCornersInterfaceContainer & interfaceContainer = distributor.findCornersWorkers.Add(workerID, FWorkerFindCornersInterfaceContainer());
+		interfaceContainer.worker = nullptr;
+		interfaceContainer.baseContainer.workerID = workerID;
+		interfaceContainer.baseContainer.getWorkLoadDel.BindLambda([&queue]() { return queue.IsEmpty() ? 0 : 1; });
+		interfaceContainer.queuePixelArrayWorkUnitInputDel.BindLambda([&queue](FLensSolverPixelArrayWorkUnit workUnit) { return queue.Enqueue(MoveTemp(workUnit)); });
+		interfaceContainer.stealPixelArrayWorkUnitInputDel.BindLambda([&queue](FLensSolverPixelArrayWorkUnit & workUnit) { return queue.Dequeue(workUnit); });
+	};
+
+	/* Both are idle so the victim, registered first, stays first in the work load sorted order. */
+	registerWorker(victimWorkerID, victimQueue);
+	registerWorker(thiefWorkerID, thiefQueue);
+
+	FMediaStreamWorkUnit mediaStreamWorkUnit;
+	mediaStreamWorkUnit.baseParameters.jobID = FGuid::NewGuid().ToString();
+	mediaStreamWorkUnit.baseParameters.calibrationID = FGuid::NewGuid().ToString();
+	mediaStreamWorkUnit.mediaStreamParameters.mediaTexture = NewObject<UMediaTexture>();
+
+	/* A mapped staging texture whose rows are padded. */
+	TArray<uint8> stagingSurface;
+	stagingSurface.SetNumZeroed(rowPitchInPixels * height * stride);
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			stagingSurface[y * rowPitchInPixels + x] = (uint8)((x + y * 3) & 0xFF);
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		const int64 acquiredBufferCount = distributor.pixelBufferPool->GetAcquiredBufferCount();
+
+		FLensSolverPixelBufferPtr surfaceData = LensSolverWorkDistributor::CopyMappedSnapshot(*distributor.pixelBufferPool, stagingSurface.GetData(), rowPitchInPixels, width, height, stride);
+		const uint8 * pixels = surfaceData->GetData();
+		const int64 copiedBufferCount = distributor.pixelBufferPool->GetAcquiredBufferCount();
+
+		distributor.QueueMediaStreamSnapshotPixels(mediaStreamWorkUnit, MoveTemp(surfaceData), width, height, stride);
+		TestFalse(TEXT("Queued to the least loaded worker"), victimQueue.IsEmpty());
+		TestTrue(TEXT("Stolen by the idle worker"), distributor.StealFindCornersWorkUnit(thiefWorkerID));
+		TestTrue(TEXT("Nothing left in the victim's queue"), victimQueue.IsEmpty());
+
+		FLensSolverPixelArrayWorkUnit dequeuedWorkUnit;
+		TestTrue(TEXT("Dequeued by the idle worker"), thiefQueue.Dequeue(dequeuedWorkUnit));
+
+		TestEqual(TEXT("Pixel buffers acquired between the copy and the dequeue"), (int32)(distributor.pixelBufferPool->GetAcquiredBufferCount() - copiedBufferCount), 0);
+		TestEqual(TEXT("Pixel buffers acquired for the frame"), (int32)(distributor.pixelBufferPool->GetAcquiredBufferCount() - acquiredBufferCount), 1);
+		TestTrue(TEXT("The dequeued work unit shares the frame's pixels"), dequeuedWorkUnit.pixelArrayParameters.pixels.IsValid() && dequeuedWorkUnit.pixelArrayParameters.pixels->GetData() == pixels);
+		TestEqual(TEXT("Pixel buffer size"), dequeuedWorkUnit.pixelArrayParameters.pixels->Num(), width * height * stride);
+
+		bool rowsUnpadded = true;
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+				rowsUnpadded &= pixels[y * width + x] == (uint8)((x + y * 3) & 0xFF);
+		TestTrue(TEXT("The padding of the staging texture rows is removed"), rowsUnpadded);
+	}
+
+	TestEqual(TEXT("Pixel buffers allocated"), (int32)distributor.pixelBufferPool->GetAllocatedBufferCount(), 1);
+	return true;
+}
+
+/* Released buffers are reused by later acquisitions of the same bucket, sizes in different buckets get their own buffers 
+and Trim frees the idle buffers so the next acquisition allocates again. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverPixelBufferPoolReuseTest, "LensCalibrator.PixelBuffers.PoolReuse", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverPixelBufferPoolReuseTest::RunTest(const FString & Parameters)
+{
+	TSharedRef<FLensSolverPixelBufferPool, ESPMode::ThreadSafe> pool = MakeShared<FLensSolverPixelBufferPool, ESPMode::ThreadSafe>();
+
+	FLensSolverPixelBufferPtr buffer = pool->Acquire(1000);
+	TestEqual(TEXT("Buffer size"), buffer->Num(), 1000);
+	const uint8 * firstData = buffer->GetData();
+	buffer.Reset();
+
+	/* A slightly larger frame rounds up to the same bucket. */
+	buffer = pool->Acquire(1200);
+	TestEqual(TEXT("Reused buffer size"), buffer->Num(), 1200);
+	TestTrue(TEXT("The released buffer is reused"), buffer->GetData() == firstData);
+	TestEqual(TEXT("Buffers allocated for one bucket"), (int32)pool->GetAllocatedBufferCount(), 1);
+
+	FLensSolverPixelBufferPtr largeBuffer = pool->Acquire(1024 * 1024);
+	TestEqual(TEXT("Buffers allocated for two buckets"), (int32)pool->GetAllocatedBufferCount(), 2);
+
+	buffer.Reset();
+	largeBuffer.Reset();
+	pool->Trim();
+
+	buffer = pool->Acquire(1000);
+	TestEqual(TEXT("Buffers allocated after trimming"), (int32)pool->GetAllocatedBufferCount(), 3);
+	TestEqual(TEXT("Buffers acquired"), (int32)pool->GetAcquiredBufferCount(), 4);
+
+	return true;
+}
+
+/* Only a bounded number of idle buffers are kept per bucket, and a buffer released after it's pool is gone is simply freed. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverPixelBufferPoolLimitsTest, "LensCalibrator.PixelBuffers.PoolLimits", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverPixelBufferPoolLimitsTest::RunTest(const FString & Parameters)
+{
+	const int bufferCount = 12;
+	const int maxPooledBuffers = 8;
+
+	TSharedPtr<FLensSolverPixelBufferPool, ESPMode::ThreadSafe> pool = MakeShared<FLensSolverPixelBufferPool, ESPMode::ThreadSafe>();
+
+	TArray<FLensSolverPixelBufferPtr> buffers;
+	for (int i = 0; i < bufferCount; i++)
+		buffers.Add(pool->Acquire(1000));
+	buffers.Empty();
+
+	for (int i = 0; i < bufferCount; i++)
+		buffers.Add(pool->Acquire(1000));
+	TestEqual(TEXT("Buffers allocated beyond the pooled limit"), (int32)pool->GetAllocatedBufferCount(), bufferCount * 2 - maxPooledBuffers);
+
+	/* The buffers hold a weak reference to the pool, destroying the pool first must not return them to it. */
+	pool.Reset();
+	buffers.Empty();
+
+	return true;
+}
+
+#endif
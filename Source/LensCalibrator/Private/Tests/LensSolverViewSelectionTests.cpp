@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#include "LensSolverWorkerCalibrate.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int viewTestCornerCountX = 5;
+static const int viewTestCornerCountY = 4;
+
+/* A view of a board with square cells spanning size of a 1000x1000 image, centered at center and rotated by angle radians. */
+static FLensSolverCalibrationViewPtr MakeTestView(FVector2D center, float size, float angle)
+{
+	FLensSolverCalibrationPointsWorkUnit view;
+	view.resizeParameters.resizeX = 1000;
+	view.resizeParameters.resizeY = 1000;
+
+	const float spacing = size / (viewTestCornerCountX - 1);
+	const float cosAngle = FMath::Cos(angle), sinAngle = FMath::Sin(angle);
+
+	for (int y = 0; y < viewTestCornerCountY; y++)
+	{
+		for (int x = 0; x < viewTestCornerCountX; x++)
+		{
+			const float localX = (x - (viewTestCornerCountX - 1) * 0.5f) * spacing;
+			const float localY = (y - (viewTestCornerCountY - 1) * 0.5f) * spacing;
+			view.calibrationPointParameters.corners.Add((center.X + localX * cosAngle - localY * sinAngle) * 1000.0f);
+			view.calibrationPointParameters.corners.Add((center.Y + localX * sinAngle + localY * cosAngle) * 1000.0f);
+		}
+	}
+
+	return MakeShared<FLensSolverCalibrationPointsWorkUnit, ESPMode::ThreadSafe>(MoveTemp(view));
+}
+
+/* Out of a cluster of near duplicate views and a few distinct ones, the largest view is picked first followed by the 
+distinct views, and the picked views come out in the order they were captured. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverSelectDiverseViewsTest, "LensCalibrator.ViewSelection.SelectDiverseViews", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverSelectDiverseViewsTest::RunTest(const FString & Parameters)
+{
+	const FVector2D center(0.5f, 0.5f);
+
+	TArray<FLensSolverCalibrationViewPtr> views;
+	views.Add(MakeTestView(center, 0.42f, 0.0f));
+	views.Add(MakeTestView(center, 0.4f, 0.0f));
+	views.Add(MakeTestView(FVector2D(0.2f, 0.2f), 0.2f, 0.0f));
+	views.Add(MakeTestView(center, 0.4f, 0.0f));
+	views.Add(MakeTestView(center, 0.4f, PI * 0.25f));
+	views.Add(MakeTestView(center, 0.4f, 0.0f));
+	views.Add(MakeTestView(FVector2D(0.8f, 0.8f), 0.2f, 0.0f));
+	views.Add(MakeTestView(center, 0.4f, 0.0f));
+	views.Add(MakeTestView(center, 0.4f, 0.0f));
+
+	TArray<int> selectedViews;
+	FLensSolverWorkerCalibrate::SelectDiverseViews(views, viewTestCornerCountX, viewTestCornerCountY, 4, selectedViews);
+
+	TestEqual(TEXT("Selected view count"), selectedViews.Num(), 4);
+	if (selectedViews.Num() == 4)
+	{
+		TestEqual(TEXT("Largest view"), selectedViews[0], 0);
+		TestEqual(TEXT("Top left view"), selectedViews[1], 2);
+		TestEqual(TEXT("Rotated view"), selectedViews[2], 4);
+		TestEqual(TEXT("Bottom right view"), selectedViews[3], 6);
+	}
+
+	/* Asking for more views than there are picks every view once. */
+	TArray<int> allViews;
+	FLensSolverWorkerCalibrate::SelectDiverseViews(views, viewTestCornerCountX, viewTestCornerCountY, views.Num() + 2, allViews);
+
+	TestEqual(TEXT("All views selected"), allViews.Num(), views.Num());
+	for (int i = 0; i < allViews.Num(); i++)
+		TestEqual(TEXT("All views selected in capture order"), allViews[i], i);
+
+	return true;
+}
+
+/* Views with too few corners for the pattern are described as empty instead of reading past their corners. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLensSolverDescribeIncompleteViewTest, "LensCalibrator.ViewSelection.DescribeIncompleteView", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLensSolverDescribeIncompleteViewTest::RunTest(const FString & Parameters)
+{
+	FLensSolverCalibrationPointsWorkUnit view = *MakeTestView(FVector2D(0.5f, 0.5f), 0.4f, 0.0f);
+	view.calibrationPointParameters.corners.SetNum(view.calibrationPointParameters.corners.Num() - 2);
+
+	TArray<float> descriptor = FLensSolverWorkerCalibrate::DescribeView(view, viewTestCornerCountX, viewTestCornerCountY);
+	TestEqual(TEXT("Descriptor size"), descriptor.Num(), 7);
+
+	bool isEmpty = true;
+	for (int i = 0; i < descriptor.Num(); i++)
+		isEmpty &= descriptor[i] == 0.0f;
+	TestTrue(TEXT("Descriptor is empty"), isEmpty);
+
+	return true;
+}
+
+#endif
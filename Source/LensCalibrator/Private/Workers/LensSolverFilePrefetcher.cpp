@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensSolverFilePrefetcher.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include "LensSolverWorkDistributor.h"
+#include "LensSolverUtilities.h"
+#include "LensCalibratorStats.h"
+#include "LensSolverPipelineLatency.h"
+#include "WorkerRegistry.h"
+
+FLensSolverFilePrefetcher::FLensSolverFilePrefetcher(int inputPrefetchCount)
+{
+	prefetchCount = inputPrefetchCount;
+	inFlightCount = 0;
+	decodedFrameCount = 0;
+	slotReleasedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+	/* Enough decoded frames for every find corner worker to have one to work on and the prefetch count more queued up behind them. */
+	int findCornerWorkerCount = LensSolverWorkDistributor::GetInstance().GetFindCornerWorkerCount();
+	if (findCornerWorkerCount == 0)
+		findCornerWorkerCount = FTaskGraphInterface::Get().GetNumWorkerThreads();
+	maxDecodedFrameCount = findCornerWorkerCount + prefetchCount;
+}
+
+FLensSolverFilePrefetcher::~FLensSolverFilePrefetcher()
+{
+	FPlatformProcess::ReturnSynchEventToPool(slotReleasedEvent);
+	slotReleasedEvent = nullptr;
+}
+
+int FLensSolverFilePrefetcher::GetPrefetchCountSetting()
+{
+	static IConsoleVariable * variable = IConsoleManager::Get().FindConsoleVariable(TEXT("LensCalibrator.FilePrefetchCount"));
+	if (variable == nullptr)
+		return 0;
+	return FMath::Max(variable->GetInt(), 0);
+}
+
+void FLensSolverFilePrefetcher::QueueWorkUnits(TArray<FLensSolverTextureFileWorkUnit> & workUnits)
+{
+	for (int i = 0; i < workUnits.Num(); i++)
+	{
+		/* A copy, the work unit is moved out below. */
+		const FString jobID = workUnits[i].baseParameters.jobID;
+
+		/* Wait for a file to finish decoding and for the workers to finish with enough of the decoded 
+		frames that are waiting for them, the timeout guards against a missed trigger and lets us 
+		notice a job that stopped while the workers are no longer releasing frames. */
+		uint32 stallStartCycles = FPlatformTime::Cycles();
+		bool stopped = ShouldStop(jobID);
+		while (!stopped && prefetchCount > 0 && (inFlightCount >= prefetchCount || decodedFrameCount >= maxDecodedFrameCount))
+		{
+			slotReleasedEvent->Wait(100);
+			stopped = ShouldStop(jobID);
+		}
+
+		if (prefetchCount > 0)
+		{
+			INC_FLOAT_STAT_BY(STAT_LensCalibratorFilePrefetchStallTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - stallStartCycles));
+		}
+
+		if (stopped)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Stopped prefetching job: \"%s\" with %d files left, the job is no longer registered or the workers are exiting."), *jobID, workUnits.Num() - i);
+			return;
+		}
+
+		TArray<uint8> fileData;
+		bool readAhead = false;
+		workUnits[i].baseParameters.pipelineTimestamps.queued = FPlatformTime::Seconds();
+
+		if (prefetchCount > 0)
+			readAhead = ReadFile(workUnits[i].textureFileParameters.absoluteFilePath, fileData);
+
+		/* If the file could not be read ahead, the worker falls back to reading it itself. */
+		if (!readAhead)
+		{
+			LensSolverWorkDistributor::GetInstance().QueueTextureFileWorkUnit(jobID, MoveTemp(workUnits[i]));
+			continue;
+		}
+
+		/* The slot is held from here until the file is decoded. */
+		inFlightCount++;
+
+		TSharedRef<FLensSolverFilePrefetcher, ESPMode::ThreadSafe> prefetcher = AsShared();
+		Async(EAsyncExecution::ThreadPool, [prefetcher, workUnit = MoveTemp(workUnits[i]), fileData = MoveTemp(fileData)]() mutable
+		{
+			prefetcher->DecodeWorkUnit(workUnit, fileData);
+		});
+	}
+}
+
+bool FLensSolverFilePrefetcher::ShouldStop(const FString & jobID)
+{
+	return WorkerRegistry::Get().ShouldExitAll() || !LensSolverWorkDistributor::GetInstance().IsJobRegistered(jobID);
+}
+
+/* The compressed file bytes are only held until they are decoded, so they are read into an array 
+of their own instead of a pooled buffer that would stay around in the frame pool afterwards. */
+bool FLensSolverFilePrefetcher::ReadFile(const FString & absoluteFilePath, TArray<uint8> & outputFileData)
+{
+	uint32 readStartCycles = FPlatformTime::Cycles();
+
+	int64 fileSize = IFileManager::Get().FileSize(*absoluteFilePath);
+	if (fileSize <= 0 || fileSize > MAX_int32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Unable to prefetch file: \"%s\" of size: %lld."), *absoluteFilePath, fileSize);
+		return false;
+	}
+
+	TUniquePtr<IFileHandle> fileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*absoluteFilePath));
+	if (!fileHandle.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Unable to open file: \"%s\" for prefetching."), *absoluteFilePath);
+		return false;
+	}
+
+	outputFileData.SetNumUninitialized((int32)fileSize);
+	if (!fileHandle->Read(outputFileData.GetData(), fileSize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Unable to read file: \"%s\" for prefetching."), *absoluteFilePath);
+		outputFileData.Empty();
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_LensCalibratorFilesPrefetched);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorFileReadTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - readStartCycles));
+	return true;
+}
+
+/* Decode stage, runs on the thread pool. */
+void FLensSolverFilePrefetcher::DecodeWorkUnit(FLensSolverTextureFileWorkUnit & workUnit, TArray<uint8> & fileData)
+{
+	/* Files read ahead before the job stopped are dropped without decoding them. */
+	if (ShouldStop(workUnit.baseParameters.jobID))
+	{
+		fileData.Empty();
+		ReleaseSlot();
+		return;
+	}
+
+	uint32 decodeStartCycles = FPlatformTime::Cycles();
+
+	const FChessboardSearchParameters & textureSearchParameters = workUnit.textureSearchParameters;
+
+	TArray64<uint8> sourcePixels;
+	int sourceWidth = 0, sourceHeight = 0, width = 0, height = 0;
+
+	bool decoded = LensSolverUtilities::DecodeImage(fileData, workUnit.textureFileParameters.absoluteFilePath, sourcePixels, sourceWidth, sourceHeight);
+	if (decoded)
+	{
+		width = textureSearchParameters.resize ? FMath::FloorToInt(sourceWidth * textureSearchParameters.resizePercentage) : sourceWidth;
+		height = textureSearchParameters.resize ? FMath::FloorToInt(sourceHeight * textureSearchParameters.resizePercentage) : sourceHeight;
+		decoded = width > 0 && height > 0;
+	}
+
+	fileData.Empty();
+
+	/* If the image can't be decoded here, give the slot back and let the worker read the file itself. */
+	if (!decoded)
+	{
+		ReleaseSlot();
+
+		const FString jobID = workUnit.baseParameters.jobID;
+		LensSolverWorkDistributor::GetInstance().QueueTextureFileWorkUnit(jobID, MoveTemp(workUnit));
+		return;
+	}
+
+	/* Convert with the weights the wrapper converted texture files with when it decoded them itself. Unlike the wrapper's resize, 
+	downscales are area averaged so corners detected from the decode stage may differ slightly, a prefetch count of 0 restores it. */
+	FLensSolverPixelBufferPtr pixels = LensSolverWorkDistributor::GetInstance().AcquirePixelBuffer(width * height);
+	LensSolverUtilities::ResampleToGrayscale(
+		sourcePixels.GetData(),
+		sourceWidth,
+		sourceHeight,
+		pixels->GetData(),
+		width,
+		height,
+		textureSearchParameters.flipX,
+		textureSearchParameters.flipY,
+		LensSolverUtilities::openCVLumaWeights);
+
+	INC_DWORD_STAT(STAT_LensCalibratorPixelBufferCopies);
+
+	/* The file is decoded so the next one can be read, queuing the decoded frame may wait for room in the work queues. */
+	sourcePixels.Empty();
+	decodedFrameCount++;
+	ReleaseSlot();
+
+	/* Hand the worker a reference that counts the decoded frame as released once the worker, or whoever drops the work 
+	unit, releases it. The pooled buffer itself is held by the deleter and returns to the pool right after. */
+	TSharedRef<FLensSolverFilePrefetcher, ESPMode::ThreadSafe> prefetcher = AsShared();
+
+	/* Like media stream snapshots, the pixels are already resized so the worker should search them as is. */
+	FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit;
+	pixelArrayWorkUnit.baseParameters = workUnit.baseParameters;
+	pixelArrayWorkUnit.textureSearchParameters = textureSearchParameters;
+	pixelArrayWorkUnit.textureSearchParameters.resize = false;
+	pixelArrayWorkUnit.pixelArrayParameters.pixels = MakeShareable(pixels.Get(), [pixels, prefetcher](TArray<uint8> * releasedPixels)
+	{
+		prefetcher->ReleaseDecodedFrame();
+	});
+	pixelArrayWorkUnit.pixelArrayParameters.stride = 1;
+	pixelArrayWorkUnit.resizeParameters.sourceX = sourceWidth;
+	pixelArrayWorkUnit.resizeParameters.sourceY = sourceHeight;
+	pixelArrayWorkUnit.resizeParameters.resizeX = width;
+	pixelArrayWorkUnit.resizeParameters.resizeY = height;
+	pixelArrayWorkUnit.cornerSearchParameters = workUnit.cornerSearchParameters;
+
+	INC_DWORD_STAT(STAT_LensCalibratorFilesDecoded);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorDecodeTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - decodeStartCycles));
+
+	FPipelineTimestamps & pipelineTimestamps = pixelArrayWorkUnit.baseParameters.pipelineTimestamps;
+	pipelineTimestamps.decoded = FPlatformTime::Seconds();
+	LensSolverPipelineLatency::Get().Record(UPipelineStage::ReadAndDecode, pipelineTimestamps.queued, pipelineTimestamps.decoded);
+
+	const FString jobID = pixelArrayWorkUnit.baseParameters.jobID;
+	LensSolverWorkDistributor::GetInstance().QueueTextureArrayWorkUnit(jobID, MoveTemp(pixelArrayWorkUnit));
+}
+
+void FLensSolverFilePrefetcher::ReleaseSlot()
+{
+	inFlightCount--;
+	slotReleasedEvent->Trigger();
+}
+
+void FLensSolverFilePrefetcher::ReleaseDecodedFrame()
+{
+	decodedFrameCount--;
+	slotReleasedEvent->Trigger();
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LensSolverPixelBufferPool.h"
+#include "LensCalibratorStats.h"
+
+FLensSolverPixelBufferPool::FLensSolverPixelBufferPool()
+{
+	allocatedBytes = 0;
+	highWaterMarkBytes = 0;
+	acquiredBufferCount = 0;
+	allocatedBufferCount = 0;
+}
+
+FLensSolverPixelBufferPool::~FLensSolverPixelBufferPool()
+{
+	Trim();
+}
+
+FLensSolverPixelBufferPtr FLensSolverPixelBufferPool::Acquire(int32 byteCount)
+{
+	int32 bucketSize = Align(FMath::Max(byteCount, 1), bucketGranularity);
+	TArray<uint8> * buffer = nullptr;
+
+	Lock();
+
+	acquiredBufferCount++;
+
+	TArray<TArray<uint8>*> * bucket = freeBuffers.Find(bucketSize);
+	if (bucket != nullptr && bucket->Num() > 0)
+	{
+		buffer = bucket->Pop(false);
+		INC_DWORD_STAT(STAT_LensCalibratorPixelBufferPoolHits);
+	}
+
+	else
+	{
+		allocatedBytes += bucketSize;
+		allocatedBufferCount++;
+		highWaterMarkBytes = FMath::Max(highWaterMarkBytes, allocatedBytes);
+		SET_MEMORY_STAT(STAT_LensCalibratorPixelBufferPoolHighWaterMark, highWaterMarkBytes);
+		INC_DWORD_STAT(STAT_LensCalibratorPixelBufferPoolMisses);
+		INC_DWORD_STAT(STAT_LensCalibratorPixelBufferAllocations);
+	}
+
+	Unlock();
+
+	if (buffer == nullptr)
+	{
+		buffer = new TArray<uint8>();
+		buffer->Reserve(bucketSize);
+	}
+
+	/* Capacity is already reserved for the bucket, so this never reallocates. */
+	buffer->SetNumUninitialized(byteCount, false);
+
+	/* The buffer may outlive the pool when the last work unit referencing it is destroyed late, in which case it's just freed. */
+	TWeakPtr<FLensSolverPixelBufferPool, ESPMode::ThreadSafe> weakPool = AsShared();
+	return MakeShareable(buffer, [weakPool, bucketSize](TArray<uint8> * releasedBuffer)
+	{
+		TSharedPtr<FLensSolverPixelBufferPool, ESPMode::ThreadSafe> pool = weakPool.Pin();
+		if (pool.IsValid())
+			pool->Release(releasedBuffer, bucketSize);
+		else
+			delete releasedBuffer;
+	});
+}
+
+void FLensSolverPixelBufferPool::Release(TArray<uint8> * buffer, int32 bucketSize)
+{
+	Lock();
+
+	TArray<TArray<uint8>*> & bucket = freeBuffers.FindOrAdd(bucketSize);
+	if (bucket.Num() < maxPooledBuffersPerBucket)
+	{
+		bucket.Add(buffer);
+		buffer = nullptr;
+	}
+
+	else allocatedBytes -= bucketSize;
+
+	Unlock();
+
+	if (buffer != nullptr)
+		delete buffer;
+}
+
+void FLensSolverPixelBufferPool::Trim()
+{
+	TArray<TArray<uint8>*> buffersToFree;
+
+	Lock();
+
+	for (auto & bucket : freeBuffers)
+	{
+		for (int i = 0; i < bucket.Value.Num(); i++)
+		{
+			allocatedBytes -= bucket.Key;
+			buffersToFree.Add(bucket.Value[i]);
+		}
+	}
+
+	freeBuffers.Empty();
+
+	Unlock();
+
+	for (int i = 0; i < buffersToFree.Num(); i++)
+		delete buffersToFree[i];
+}
+
+int64 FLensSolverPixelBufferPool::GetAcquiredBufferCount()
+{
+	Lock();
+	int64 count = acquiredBufferCount;
+	Unlock();
+	return count;
+}
+
+int64 FLensSolverPixelBufferPool::GetAllocatedBufferCount()
+{
+	Lock();
+	int64 count = allocatedBufferCount;
+	Unlock();
+	return count;
+}
+
+void FLensSolverPixelBufferPool::Lock()
+{
+	threadLock.Lock();
+}
+
+void FLensSolverPixelBufferPool::Unlock()
+{
+	threadLock.Unlock();
+}
@@ -25,6 +25,11 @@
 #include "Engine.h"
 #include "BlitShader.h"
 #include "LensSolverUtilities.h"
+#include "LensCalibratorStats.h"
+#include "LensSolverPipelineLatency.h"
+
+/* How long a one time job's producer sleeps before retrying when the work queues of all find corner workers are full. */
+static const float findCornersQueueFullBackOffSeconds = 0.001f;
 
 /* This spawns a thread pool and prepares a set of find corner and calibration workers. */
 void LensSolverWorkDistributor::PrepareWorkers(
@@ -64,7 +69,10 @@ void LensSolverWorkDistributor::PrepareFindCornerWorkers(
 	calibration worker. This will get passed to the find corner worker. */
 	queueCalibrateWorkUnitInputDel.BindRaw(this, &LensSolverWorkDistributor::QueueCalibrateWorkUnit);
 
-	Lock();
+	/* Bind the delegate that allows idle find corner workers to steal work from busy peers. */
+	stealFindCornersWorkUnitOutputDel.BindRaw(this, &LensSolverWorkDistributor::StealFindCornersWorkUnit);
+
+	WriteLockWorkers();
 
 	/* Loop through the expected number of workers we want to initialize. */
 	for (int i = 0; i < findCornerWorkerCount; i++)
@@ -79,6 +87,7 @@ void LensSolverWorkDistributor::PrepareFindCornerWorkers(
 			&queueLogOutputDel,
 			&interfaceContainer.baseContainer.isClosingDel,
 			&interfaceContainer.baseContainer.getWorkLoadDel,
+			&interfaceContainer.baseContainer.getWorkerStatsDel,
 			workerID
 		);
 
@@ -91,7 +100,10 @@ void LensSolverWorkDistributor::PrepareFindCornerWorkers(
 			workerParameters,
 			&interfaceContainer.queueTextureFileWorkUnitInputDel,
 			&interfaceContainer.queuePixelArrayWorkUnitInputDel,
-			&queueCalibrateWorkUnitInputDel);
+			&interfaceContainer.stealTextureFileWorkUnitInputDel,
+			&interfaceContainer.stealPixelArrayWorkUnitInputDel,
+			&queueCalibrateWorkUnitInputDel,
+			&stealFindCornersWorkUnitOutputDel);
 	}
 
 	/* After the workers have been constructed, start the threads. */
@@ -102,7 +114,7 @@ void LensSolverWorkDistributor::PrepareFindCornerWorkers(
 		count++;
 	}
 
-	Unlock();
+	WriteUnlockWorkers();
 
 	UE_LOG(LogTemp, Log, TEXT("(INFO): Started %d FindCorner workers"), count);
 }
@@ -119,12 +131,11 @@ void LensSolverWorkDistributor::PrepareCalibrateWorkers(
 	/* Bind the delegate that allows the find corner worker to queue a calibration result back onto the main thread
 	so it can be accessed by this class and accessed from blueprints This will get passed to the find calibration worker. */
 	queueCalibrationResultOutputDel.BindRaw(this, &LensSolverWorkDistributor::QueueCalibrationResult);
-	Lock();
+	WriteLockWorkers();
 
 	for (int i = 0; i < calibrateWorkerCount; i++)
 	{
 		FString workerID = FGuid::NewGuid().ToString();
-		workLoadSortedCalibrateWorkers.Add(workerID);
 
 		/* Setup interface to the worker and map it via worker ID. */
 		FWorkerCalibrateInterfaceContainer & interfaceContainer = calibrateWorkers.Add(workerID, FWorkerCalibrateInterfaceContainer());
@@ -133,6 +144,7 @@ void LensSolverWorkDistributor::PrepareCalibrateWorkers(
 			&queueLogOutputDel,
 			&interfaceContainer.baseContainer.isClosingDel,
 			&interfaceContainer.baseContainer.getWorkLoadDel,
+			&interfaceContainer.baseContainer.getWorkerStatsDel,
 			workerID
 		);
 
@@ -143,7 +155,6 @@ void LensSolverWorkDistributor::PrepareCalibrateWorkers(
 		/* Here is where we actually create the find corner background worker. */
 		interfaceContainer.worker = new FAutoDeleteAsyncTask<FLensSolverWorkerCalibrate>(
 			workerParameters,
-			&interfaceContainer.queueCalibrateWorkUnitDel,
 			&interfaceContainer.signalLatch,
 			&queueCalibrationResultOutputDel);
 	}
@@ -156,11 +167,76 @@ void LensSolverWorkDistributor::PrepareCalibrateWorkers(
 		count++;
 	}
 
-	Unlock();
+	WriteUnlockWorkers();
 
 	UE_LOG(LogTemp, Log, TEXT("(INFO): Started %d Calibrate workers"), count);
 }
 
+/* Instead of spawning long lived workers, create a find corner and calibration executor that 
+tasks dispatched to the task graph use to process work units on the task graph's threads. */
+void LensSolverWorkDistributor::PrepareTaskGraph()
+{
+	UE_LOG(LogTemp, Log, TEXT("Preparing task graph executors."));
+
+	queueCalibrateWorkUnitInputDel.BindRaw(this, &LensSolverWorkDistributor::QueueCalibrateWorkUnit);
+	queueCalibrationResultOutputDel.BindRaw(this, &LensSolverWorkDistributor::QueueCalibrationResult);
+
+	WriteLockWorkers();
+
+	if (useTaskGraph)
+	{
+		WriteUnlockWorkers();
+		QueueLogAsync("(ERROR): Task graph executors are already prepared.");
+		return;
+	}
+
+	FString findCornersWorkerID = FGuid::NewGuid().ToString();
+	findCornersTaskExecutorInterfaceContainer = MakeShareable(new FWorkerFindCornersInterfaceContainer());
+	findCornersTaskExecutorInterfaceContainer->worker = nullptr;
+	findCornersTaskExecutorInterfaceContainer->baseContainer.workerID = findCornersWorkerID;
+
+	FLensSolverWorkerParameters findCornersWorkerParameters(
+		&queueLogOutputDel,
+		&findCornersTaskExecutorInterfaceContainer->baseContainer.isClosingDel,
+		&findCornersTaskExecutorInterfaceContainer->baseContainer.getWorkLoadDel,
+		&findCornersTaskExecutorInterfaceContainer->baseContainer.getWorkerStatsDel,
+		findCornersWorkerID
+	);
+
+	findCornersTaskExecutor = MakeShareable(new FLensSolverWorkerFindCorners(
+		findCornersWorkerParameters,
+		&findCornersTaskExecutorInterfaceContainer->queueTextureFileWorkUnitInputDel,
+		&findCornersTaskExecutorInterfaceContainer->queuePixelArrayWorkUnitInputDel,
+		&findCornersTaskExecutorInterfaceContainer->stealTextureFileWorkUnitInputDel,
+		&findCornersTaskExecutorInterfaceContainer->stealPixelArrayWorkUnitInputDel,
+		&queueCalibrateWorkUnitInputDel,
+		&stealFindCornersWorkUnitOutputDel));
+
+	FString calibrateWorkerID = FGuid::NewGuid().ToString();
+	calibrateTaskExecutorInterfaceContainer = MakeShareable(new FWorkerCalibrateInterfaceContainer());
+	calibrateTaskExecutorInterfaceContainer->worker = nullptr;
+	calibrateTaskExecutorInterfaceContainer->baseContainer.workerID = calibrateWorkerID;
+
+	FLensSolverWorkerParameters calibrateWorkerParameters(
+		&queueLogOutputDel,
+		&calibrateTaskExecutorInterfaceContainer->baseContainer.isClosingDel,
+		&calibrateTaskExecutorInterfaceContainer->baseContainer.getWorkLoadDel,
+		&calibrateTaskExecutorInterfaceContainer->baseContainer.getWorkerStatsDel,
+		calibrateWorkerID
+	);
+
+	calibrateTaskExecutor = MakeShareable(new FLensSolverWorkerCalibrate(
+		calibrateWorkerParameters,
+		&calibrateTaskExecutorInterfaceContainer->signalLatch,
+		&queueCalibrationResultOutputDel));
+
+	useTaskGraph = true;
+
+	WriteUnlockWorkers();
+
+	UE_LOG(LogTemp, Log, TEXT("(INFO): Started task graph executors with %d task graph worker threads."), FTaskGraphInterface::Get().GetNumWorkerThreads());
+}
+
 /* Create job a one time or continuous job and return the job info. */
 FJobInfo LensSolverWorkDistributor::RegisterJob(
 	TScriptInterface<ILensSolverEventReceiver> eventReceiver, /* The interface that a blueprint class implements for callbacks. */
@@ -207,213 +283,515 @@ FJobInfo LensSolverWorkDistributor::RegisterJob(
 		job.startTime = GetTickNow();
 	}
 
-	Lock();
+	LockJobs();
 
 	/* Map job to job ID. */
 	jobs.Add(jobInfo.jobID, job);
 
-	Unlock();
+	UnlockJobs();
 
 	QueueLogAsync(FString::Printf(TEXT("(INFO): Registered job with ID: \"%s\"."), *job.jobInfo.jobID));
 
 	return jobInfo;
 }
 
-void LensSolverWorkDistributor::QueueTextureArrayWorkUnit(const FString & jobID, FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit)
+bool LensSolverWorkDistributor::SetExpectedImageCounts(const FString & jobID, const TArray<int> & expectedImageCounts)
 {
-	Lock();
-	if (workLoadSortedFindCornerWorkers.Num() == 0)
-	{
-		QueueLogAsync("(ERROR): The work load sorted FindCornerWorker array is empty!");
-		Unlock();
-		return;
-	}
-
-	/* Sort our corner finding background workers by least busy to most busy so we can load balance correctly. */
-	SortFindCornersWorkersByWorkLoad();
+	LockJobs();
 
-	/* Get first corner finding background worker. */
-	const FString workerID = workLoadSortedFindCornerWorkers[0];
-	if (workerID.IsEmpty())
+	FJob* jobPtr = jobs.Find(jobID);
+	if (jobPtr == nullptr || jobPtr->jobInfo.calibrationIDs.Num() != expectedImageCounts.Num())
 	{
-		QueueLogAsync("(ERROR): A worker ID in the work load sorted FindCornerWorker array is empty!");
-		Unlock();
-		return;
+		UnlockJobs();
+		QueueLogAsync(FString::Printf(TEXT("(ERROR): Cannot set expected image counts, no job with ID: \"%s\" and %d calibrations is registered."), *jobID, expectedImageCounts.Num()));
+		return false;
 	}
 
-	/* Get interface to worker. */
-	FWorkerFindCornersInterfaceContainer* interfaceContainer =nullptr;
-	if (!GetFindCornersContainerInterfacePtr(workerID, interfaceContainer))
+	for (int i = 0; i < expectedImageCounts.Num(); i++)
 	{
-		Unlock();
-		return;
+		FExpectedAndCurrentImageCount* expectedAndCurrentImageCount = jobPtr->expectedAndCurrentImageCounts.Find(jobPtr->jobInfo.calibrationIDs[i]);
+		if (expectedAndCurrentImageCount != nullptr)
+			expectedAndCurrentImageCount->expectedImageCount = expectedImageCounts[i];
 	}
-	Unlock();
 
-	/* Determine if we have a valid delegate to execute methods in our background worker. */
-	if (!interfaceContainer->queuePixelArrayWorkUnitInputDel.IsBound())
+	UnlockJobs();
+	return true;
+}
+
+void LensSolverWorkDistributor::FailJob(const FString & jobID)
+{
+	LockJobs();
+
+	FJob* jobPtr = jobs.Find(jobID);
+	if (jobPtr == nullptr)
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): FindCornerWorker: \"%s\" does not have a QueueWorkUnit delegate binded!"), *workerID));
+		UnlockJobs();
+		QueueLogAsync(FString::Printf(TEXT("(ERROR): Cannot fail job, no job with ID: \"%s\" registered."), *jobID));
 		return;
 	}
 
-	/* Queue pixel data work unit to worker to find calibration pattern corners in the image. */
-	interfaceContainer->queuePixelArrayWorkUnitInputDel.Execute(pixelArrayWorkUnit);
+	FinishedJobQueueContainer finishedJobQueueContainer;
+	finishedJobQueueContainer.jobInfo = jobPtr->jobInfo;
+	finishedJobQueueContainer.jobInfo.failed = true;
+	finishedJobQueueContainer.eventReceiver = jobPtr->eventReceiver;
+
+	jobs.Remove(jobID);
+
+	if (queueFinishedJobOutputDel.IsBound())
+		queueFinishedJobOutputDel.Execute(finishedJobQueueContainer);
+
+	UnlockJobs();
+
+	QueueLogAsync(FString::Printf(TEXT("(ERROR): Failed job with ID: \"%s\", job was unregistered."), *jobID));
 }
 
-void LensSolverWorkDistributor::QueueTextureFileWorkUnit(const FString & jobID, FLensSolverTextureFileWorkUnit textureFileWorkUnit)
+bool LensSolverWorkDistributor::IsJobRegistered(const FString & jobID)
+{
+	LockJobs();
+	bool registered = jobs.Contains(jobID);
+	UnlockJobs();
+	return registered;
+}
+
+void LensSolverWorkDistributor::QueueTextureArrayWorkUnit(const FString & jobID, FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit)
 {
-	Lock();
-	if (workLoadSortedFindCornerWorkers.Num() == 0)
+	/* Decoded image files were already stamped when they were queued to the file prefetcher. */
+	if (pixelArrayWorkUnit.baseParameters.pipelineTimestamps.queued == 0.0)
+		pixelArrayWorkUnit.baseParameters.pipelineTimestamps.queued = FPlatformTime::Seconds();
+
+	/* One time jobs wait here for queue space, so the workers are looked up again on each attempt in case they were stopped meanwhile. */
+	int retryCount = 0;
+	do
 	{
-		QueueLogAsync("(ERROR): The work load sorted CalibrateWorker array is empty!");
-		Unlock();
-		return;
+		ReadLockWorkers();
+		if (useTaskGraph)
+		{
+			ReadUnlockWorkers();
+			DispatchPixelArrayWorkUnitTask(MoveTemp(pixelArrayWorkUnit));
+			return;
+		}
+
+		if (workLoadSortedFindCornerWorkers.Num() == 0)
+		{
+			QueueLogAsync("(ERROR): The work load sorted FindCornerWorker array is empty!");
+			ReadUnlockWorkers();
+			return;
+		}
+
+		/* Get interfaces to our corner finding background workers sorted by least busy to most busy so we can load balance 
+		correctly, if the least busy worker's queue is full we fall through to the next one. The containers live in the worker 
+		map which is emptied when the workers are stopped, so the read lock is held until we are done with them. */
+		TArray<FWorkerFindCornersInterfaceContainer*> interfaceContainers;
+		GetWorkLoadSortedFindCornersContainerInterfacePtrs(interfaceContainers);
+
+		for (int i = 0; i < interfaceContainers.Num(); i++)
+		{
+			/* Determine if we have a valid delegate to execute methods in our background worker. */
+			if (!interfaceContainers[i]->queuePixelArrayWorkUnitInputDel.IsBound())
+			{
+				QueueLogAsync(FString::Printf(TEXT("(ERROR): FindCornerWorker: \"%s\" does not have a QueueWorkUnit delegate binded!"), *interfaceContainers[i]->baseContainer.workerID));
+				continue;
+			}
+
+			/* Queue pixel data work unit to worker to find calibration pattern corners in the image, only the reference to the pixels is copied. */
+			if (interfaceContainers[i]->queuePixelArrayWorkUnitInputDel.Execute(pixelArrayWorkUnit))
+			{
+				ReadUnlockWorkers();
+				return;
+			}
+		}
+
+		ReadUnlockWorkers();
 	}
+	while (BackOffOrDropFindCornersWorkUnit(jobID, pixelArrayWorkUnit.baseParameters, pixelArrayWorkUnit.textureSearchParameters, retryCount));
+}
 
-	SortFindCornersWorkersByWorkLoad();
+void LensSolverWorkDistributor::QueueTextureFileWorkUnit(const FString & jobID, FLensSolverTextureFileWorkUnit textureFileWorkUnit)
+{
+	if (textureFileWorkUnit.baseParameters.pipelineTimestamps.queued == 0.0)
+		textureFileWorkUnit.baseParameters.pipelineTimestamps.queued = FPlatformTime::Seconds();
 
-	const FString workerID = workLoadSortedFindCornerWorkers[0];
-	if (workerID.IsEmpty())
+	int retryCount = 0;
+	do
 	{
-		QueueLogAsync("(ERROR): A worker ID in the work load sorted CalibrateWorker array is empty!");
-		Unlock();
-		return;
+		ReadLockWorkers();
+		if (useTaskGraph)
+		{
+			ReadUnlockWorkers();
+			DispatchTextureFileWorkUnitTask(textureFileWorkUnit);
+			return;
+		}
+
+		if (workLoadSortedFindCornerWorkers.Num() == 0)
+		{
+			QueueLogAsync("(ERROR): The work load sorted CalibrateWorker array is empty!");
+			ReadUnlockWorkers();
+			return;
+		}
+
+		TArray<FWorkerFindCornersInterfaceContainer*> interfaceContainers;
+		GetWorkLoadSortedFindCornersContainerInterfacePtrs(interfaceContainers);
+
+		for (int i = 0; i < interfaceContainers.Num(); i++)
+		{
+			if (!interfaceContainers[i]->queueTextureFileWorkUnitInputDel.IsBound())
+			{
+				QueueLogAsync(FString::Printf(TEXT("(ERROR): CalibrateWorker: \"%s\" does not have a QueueWorkUnit delegate binded!"), *interfaceContainers[i]->baseContainer.workerID));
+				continue;
+			}
+
+			if (interfaceContainers[i]->queueTextureFileWorkUnitInputDel.Execute(textureFileWorkUnit))
+			{
+				ReadUnlockWorkers();
+				return;
+			}
+		}
+
+		ReadUnlockWorkers();
 	}
+	while (BackOffOrDropFindCornersWorkUnit(jobID, textureFileWorkUnit.baseParameters, textureFileWorkUnit.textureSearchParameters, retryCount));
+}
 
-	FWorkerFindCornersInterfaceContainer* interfaceContainer = nullptr;
-	if (!GetFindCornersContainerInterfacePtr(workerID, interfaceContainer))
+/* Called when the work queues of all find corner workers are full. Continuous jobs only care about the latest frames so the image 
+is dropped, while one time jobs need every image so the producer backs off until a worker has room. Returns true to retry. */
+bool LensSolverWorkDistributor::BackOffOrDropFindCornersWorkUnit(
+	const FString & jobID,
+	const FBaseParameters & baseParameters, 
+	const FChessboardSearchParameters & textureSearchParameters,
+	int & retryCount)
+{
+	LockJobs();
+	FJob* jobPtr = jobs.Find(jobID);
+	bool dropWorkUnit = jobPtr == nullptr || jobPtr->jobInfo.jobType == UJobType::Continuous;
+	UnlockJobs();
+
+	if (dropWorkUnit)
 	{
-		Unlock();
-		return;
+		QueueEmptyCalibrateWorkUnit(baseParameters, textureSearchParameters);
+		return false;
 	}
-	Unlock();
 
-	if (!interfaceContainer->queueTextureFileWorkUnitInputDel.IsBound())
+	if (retryCount == 0)
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): CalibrateWorker: \"%s\" does not have a QueueWorkUnit delegate binded!"), *workerID));
-		return;
+		INC_DWORD_STAT(STAT_LensCalibratorFindCornersQueueFullWaits);
+		if (Debug())
+			QueueLogAsync(FString::Printf(TEXT("(INFO): The work queues of all FindCorner workers are full, waiting to queue image: \"%s\" for calibration: \"%s\"."),
+				*baseParameters.friendlyName,
+				*baseParameters.calibrationID));
 	}
 
-	interfaceContainer->queueTextureFileWorkUnitInputDel.Execute(textureFileWorkUnit);
+	retryCount++;
+	FPlatformProcess::Sleep(findCornersQueueFullBackOffSeconds);
+	return true;
+}
+
+/* When the work queues of all find corner workers are full, a continuous job's image is dropped. We still queue an empty calibration 
+points work unit in it's place, the same way a worker does when it fails to find corners, so the job can complete. */
+void LensSolverWorkDistributor::QueueEmptyCalibrateWorkUnit(const FBaseParameters & baseParameters, const FChessboardSearchParameters & textureSearchParameters)
+{
+	QueueLogAsync(FString::Printf(TEXT("(ERROR): The work queues of all FindCorner workers are full, dropped image: \"%s\" for calibration: \"%s\"."),
+		*baseParameters.friendlyName,
+		*baseParameters.calibrationID));
+
+	INC_DWORD_STAT(STAT_LensCalibratorFindCornersWorkUnitsDropped);
+
+	FLensSolverCalibrationPointsWorkUnit calibrationPointsWorkUnit;
+	calibrationPointsWorkUnit.baseParameters			= baseParameters;
+	calibrationPointsWorkUnit.resizeParameters.nativeX	= textureSearchParameters.nativeFullResolutionX;
+	calibrationPointsWorkUnit.resizeParameters.nativeY	= textureSearchParameters.nativeFullResolutionY;
+
+	QueueCalibrateWorkUnit(calibrationPointsWorkUnit);
 }
 
 /* Queuing work unit for taking snapshots of media stream. */
 void LensSolverWorkDistributor::QueueMediaStreamWorkUnit(const FMediaStreamWorkUnit mediaStreamWorkUnit)
 {
+	LockStreams();
 	if (mediaTextureJobLUT.Contains(mediaStreamWorkUnit.baseParameters.jobID))
 	{
+		UnlockStreams();
 		UE_LOG(LogTemp, Fatal, TEXT("Attempted to re-register already registered job ID: \"%s\" in MediaTexture Job LUT."), *mediaStreamWorkUnit.baseParameters.jobID);
 		return;
 	}
 
-	if (Debug())
-		QueueLogAsync(FString::Printf(TEXT("Queued MediaStreamWorkUnit for calibration"), *mediaStreamWorkUnit.baseParameters.calibrationID));
-
 	/* Media stream calibration job mapping between work unit and job ID. */
 	mediaTextureJobLUT.Add(mediaStreamWorkUnit.baseParameters.jobID, mediaStreamWorkUnit);
+	mediaStreamInFlightSnapshotCounts.Add(mediaStreamWorkUnit.baseParameters.jobID, 0);
+	UnlockStreams();
+
+	if (Debug())
+		QueueLogAsync(FString::Printf(TEXT("Queued MediaStreamWorkUnit for calibration"), *mediaStreamWorkUnit.baseParameters.calibrationID));
 }
 
 void LensSolverWorkDistributor::SetCalibrateWorkerParameters(FCalibrationParameters calibrationParameters)
 {
+	LockJobs();
 	cachedCalibrationParameters = calibrationParameters;
+	UnlockJobs();
 }
 
-/* After corners are found by the find corner workers, the results are polled, put 
-into a calibrate work unit and queued to calibration background workers for processing. */
+/* After corners are found by the find corner workers, the results are accumulated with their job until 
+a calibration is due, then the calibration is latched to whichever calibration worker is free. */
 void LensSolverWorkDistributor::QueueCalibrateWorkUnit(FLensSolverCalibrationPointsWorkUnit calibrateWorkUnit)
 {
-	Lock();
-	if (calibrateWorkers.Num() == 0)
+	/* Corner detection for this image is done, if it was a media stream snapshot then the stream can take another one. */
+	ReleaseMediaStreamSnapshot(calibrateWorkUnit.baseParameters.jobID);
+
+	/* Images dropped before reaching a find corner worker were never dequeued, so they are not recorded. */
+	FPipelineTimestamps & pipelineTimestamps = calibrateWorkUnit.baseParameters.pipelineTimestamps;
+	pipelineTimestamps.cornersFound = FPlatformTime::Seconds();
+	if (pipelineTimestamps.dequeued > 0.0)
+	{
+		LensSolverPipelineLatency::Get().Record(UPipelineStage::QueueWait, pipelineTimestamps.decoded > 0.0 ? pipelineTimestamps.decoded : pipelineTimestamps.queued, pipelineTimestamps.dequeued);
+		LensSolverPipelineLatency::Get().Record(UPipelineStage::CornerDetection, pipelineTimestamps.dequeued, pipelineTimestamps.cornersFound);
+	}
+
+	/* We've processed an image, so accumulate it's view and determine whether we have processed all the images or a provisional solve is due. */
+	FCalibrateLatch latchData;
+	bool hitExpectedImageCount = false;
+
+	if (!AccumulateCalibrationView(calibrateWorkUnit, latchData, hitExpectedImageCount))
+		return;
+
+	/* Submit data and flag to the calibration workers that we've finished attempting to find all corners in the calibration pattern in all images. */
+	LatchCalibrateWorker(latchData);
+
+	/* Do we need to shutdwon find corner background workers? */
+	if (hitExpectedImageCount)
+		PollShutdownFindCornerWorkersIfNecessary();
+}
+
+void LensSolverWorkDistributor::LatchCalibrateWorker(const FCalibrateLatch& latchData)
+{
+	if (latchData.baseParameters.calibrationID.IsEmpty())
+	{
+		QueueLogAsync("(ERROR): The calibration ID is empty!");
+		return;
+	}
+
+	ReadLockWorkers();
+	bool taskGraph = useTaskGraph;
+	ReadUnlockWorkers();
+
+	if (taskGraph)
 	{
-		Unlock();
+		DispatchCalibrateTask(latchData);
 		return;
 	}
 
-	FWorkerCalibrateInterfaceContainer * interfaceContainerPtr;
-	if (!GetCalibrateWorkerInterfaceContainerPtr(calibrateWorkUnit.baseParameters.calibrationID, interfaceContainerPtr))
+	/* The interface container is only valid while the read lock is held, so the latch is submitted before releasing it. */
+	ReadLockWorkers();
+
+	FWorkerCalibrateInterfaceContainer* interfaceContainerPtr;
+	/* Get reference to interface container to the least loaded calibration worker, the latch carries it's views so any worker can solve it. */
+	if (!GetLeastLoadedCalibrateWorkerInterfaceContainerPtr(interfaceContainerPtr))
 	{
-		Unlock();
+		ReadUnlockWorkers();
 		return;
 	}
-	Unlock();
 
-	if (!interfaceContainerPtr->queueCalibrateWorkUnitDel.IsBound())
+	if (!interfaceContainerPtr->signalLatch.IsBound())
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): The QueueWOrkUnit delegate is not binded for CalibrateWorker with ID: \"%s\"."), *interfaceContainerPtr->baseContainer.workerID));
-		Unlock();
+		FString workerID = interfaceContainerPtr->baseContainer.workerID;
+		ReadUnlockWorkers();
+		QueueLogAsync(FString::Printf(TEXT("(ERROR): The CalibrateWorker: \"%s\" does not have a QueueLatchInput delegate binded!"), *workerID));
 		return;
 	}
 
-	interfaceContainerPtr->queueCalibrateWorkUnitDel.Execute(calibrateWorkUnit);
+	/* Call a delegate binded to a calibration worker method to submit the latch and the data. */
+	interfaceContainerPtr->signalLatch.Execute(latchData);
+	ReadUnlockWorkers();
+}
 
-	/* We've processed an image, so iterate the current image count and determine whether we have processed all the images and return true if we have. */
-	bool hitExpectedImageCount = IterateImageCount(calibrateWorkUnit.baseParameters.jobID, calibrateWorkUnit.baseParameters.calibrationID);
+/* Find corner work is distributed to the least loaded worker when it's queued, however some images take much longer to process
+than others. So when a worker's queues are empty, it calls this method to dequeue the oldest work unit from the most loaded peer's 
+bounded queue and enqueue it to it's own. */
+bool LensSolverWorkDistributor::StealFindCornersWorkUnit(const FString thiefWorkerID)
+{
+	ReadLockWorkers();
 
-	if (hitExpectedImageCount)
+	FWorkerFindCornersInterfaceContainer* thiefInterfaceContainer = findCornersWorkers.Find(thiefWorkerID);
+	if (thiefInterfaceContainer == nullptr || findCornersWorkers.Num() < 2)
 	{
-		FCalibrateLatch latchData;
-		latchData.baseParameters		= calibrateWorkUnit.baseParameters;
-		latchData.calibrationParameters	= cachedCalibrationParameters;
-		latchData.resizeParameters		= calibrateWorkUnit.resizeParameters;
+		ReadUnlockWorkers();
+		return false;
+	}
 
-		/* Submit data and flag to the calibration workers that we've finished attempting to find all corners in the calibration pattern in all images. */
-		LatchCalibrateWorker(latchData);
+	/* Find the most loaded peer. */
+	FWorkerFindCornersInterfaceContainer* victimInterfaceContainer = nullptr;
+	int victimWorkLoad = 0;
 
-		/* Do we need to shutdwon find corner background workers? */
-		PollShutdownFindCornerWorkersIfNecessary();
+	for (auto & entry : findCornersWorkers)
+	{
+		if (entry.Key == thiefWorkerID || !entry.Value.baseContainer.getWorkLoadDel.IsBound())
+			continue;
+
+		int workLoad = entry.Value.baseContainer.getWorkLoadDel.Execute();
+		if (workLoad > victimWorkLoad)
+		{
+			victimWorkLoad = workLoad;
+			victimInterfaceContainer = &entry.Value;
+		}
+	}
+
+	if (victimInterfaceContainer == nullptr)
+	{
+		ReadUnlockWorkers();
+		return false;
+	}
+
+	bool stole = false;
+
+	FLensSolverTextureFileWorkUnit textureFileWorkUnit;
+	FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit;
+
+	/* If the thief's queue is unexpectedly full, hand the work unit back to the victim. */
+	if (victimInterfaceContainer->stealTextureFileWorkUnitInputDel.IsBound() &&
+		thiefInterfaceContainer->queueTextureFileWorkUnitInputDel.IsBound() &&
+		victimInterfaceContainer->stealTextureFileWorkUnitInputDel.Execute(textureFileWorkUnit))
+	{
+		stole = thiefInterfaceContainer->queueTextureFileWorkUnitInputDel.Execute(textureFileWorkUnit);
+		if (!stole && victimInterfaceContainer->queueTextureFileWorkUnitInputDel.IsBound())
+			victimInterfaceContainer->queueTextureFileWorkUnitInputDel.Execute(textureFileWorkUnit);
+	}
+
+	else if (victimInterfaceContainer->stealPixelArrayWorkUnitInputDel.IsBound() &&
+		thiefInterfaceContainer->queuePixelArrayWorkUnitInputDel.IsBound() &&
+		victimInterfaceContainer->stealPixelArrayWorkUnitInputDel.Execute(pixelArrayWorkUnit))
+	{
+		stole = thiefInterfaceContainer->queuePixelArrayWorkUnitInputDel.Execute(pixelArrayWorkUnit);
+		if (!stole && victimInterfaceContainer->queuePixelArrayWorkUnitInputDel.IsBound())
+			victimInterfaceContainer->queuePixelArrayWorkUnitInputDel.Execute(pixelArrayWorkUnit);
 	}
+
+	const FString victimWorkerID = victimInterfaceContainer->baseContainer.workerID;
+	ReadUnlockWorkers();
+
+	if (stole && Debug())
+		QueueLogAsync(FString::Printf(TEXT("(INFO): FindCorner worker: \"%s\" stole a work unit from FindCorner worker: \"%s\" with work load: %d."), 
+			*thiefWorkerID,
+			*victimWorkerID,
+			victimWorkLoad));
+
+	return stole;
 }
 
-void LensSolverWorkDistributor::LatchCalibrateWorker(const FCalibrateLatch& latchData)
+void LensSolverWorkDistributor::DispatchTextureFileWorkUnitTask(FLensSolverTextureFileWorkUnit textureFileWorkUnit)
 {
-	if (latchData.baseParameters.calibrationID.IsEmpty())
+	ReadLockWorkers();
+	TSharedPtr<FLensSolverWorkerFindCorners, ESPMode::ThreadSafe> executor = findCornersTaskExecutor;
+	TSharedPtr<FWorkerFindCornersInterfaceContainer, ESPMode::ThreadSafe> executorInterfaceContainer = findCornersTaskExecutorInterfaceContainer;
+	ReadUnlockWorkers();
+
+	if (!executor.IsValid())
 	{
-		QueueLogAsync("(ERROR): The calibration ID is empty!");
+		QueueLogAsync("(ERROR): Cannot dispatch texture file task, there is no FindCorner task executor.");
 		return;
 	}
 
-	Lock();
-	FWorkerCalibrateInterfaceContainer* interfaceContainerPtr;
-	/* Get reference to interface container to calibration worker. */
-	if (!GetCalibrateWorkerInterfaceContainerPtr(latchData.baseParameters.calibrationID, interfaceContainerPtr))
+	INC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+
+	/* The task holds a reference to the executor and it's interface container so they stay alive if the executors are stopped while this task is in flight. */
+	FFunctionGraphTask::CreateAndDispatchWhenReady([executor, executorInterfaceContainer, textureFileWorkUnit]() mutable
 	{
-		Unlock();
+		executor->ProcessTextureFileWorkUnit(textureFileWorkUnit);
+		DEC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+void LensSolverWorkDistributor::DispatchPixelArrayWorkUnitTask(FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit)
+{
+	ReadLockWorkers();
+	TSharedPtr<FLensSolverWorkerFindCorners, ESPMode::ThreadSafe> executor = findCornersTaskExecutor;
+	TSharedPtr<FWorkerFindCornersInterfaceContainer, ESPMode::ThreadSafe> executorInterfaceContainer = findCornersTaskExecutorInterfaceContainer;
+	ReadUnlockWorkers();
+
+	if (!executor.IsValid())
+	{
+		QueueLogAsync("(ERROR): Cannot dispatch pixel array task, there is no FindCorner task executor.");
 		return;
 	}
-	Unlock();
 
-	if (!interfaceContainerPtr->signalLatch.IsBound())
+	INC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+
+	FFunctionGraphTask::CreateAndDispatchWhenReady([executor, executorInterfaceContainer, pixelArrayWorkUnit = MoveTemp(pixelArrayWorkUnit)]() mutable
+	{
+		executor->ProcessPixelArrayWorkUnit(pixelArrayWorkUnit);
+		DEC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+/* This is dispatched by the corner detection task that processed the last image of a calibration 
+ID, so the calibration task depends on all the corner detection tasks of that calibration ID. */
+void LensSolverWorkDistributor::DispatchCalibrateTask(const FCalibrateLatch & latchData)
+{
+	ReadLockWorkers();
+	TSharedPtr<FLensSolverWorkerCalibrate, ESPMode::ThreadSafe> executor = calibrateTaskExecutor;
+	TSharedPtr<FWorkerCalibrateInterfaceContainer, ESPMode::ThreadSafe> executorInterfaceContainer = calibrateTaskExecutorInterfaceContainer;
+	ReadUnlockWorkers();
+
+	if (!executor.IsValid())
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): The CalibrateWorker: \"%s\" does not have a QueueLatchInput delegate binded!"), *interfaceContainerPtr->baseContainer.workerID));
+		QueueLogAsync("(ERROR): Cannot dispatch calibration task, there is no Calibrate task executor.");
 		return;
 	}
 
-	/* Call a delegate binded to a calibration worker method to submit the latch and the data. */
-	interfaceContainerPtr->signalLatch.Execute(latchData);
+	if (Debug())
+		QueueLogAsync(FString::Printf(TEXT("(INFO): Dispatching calibration task for calibration: \"%s\"."), *latchData.baseParameters.calibrationID));
+
+	INC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+
+	FFunctionGraphTask::CreateAndDispatchWhenReady([executor, executorInterfaceContainer, latchData]()
+	{
+		executor->Calibrate(latchData);
+		DEC_DWORD_STAT(STAT_LensCalibratorTaskGraphTasksInFlight);
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
 }
 
 /* When calibration is complete, calibration background workers call this method via a 
 delegate to queue the results back onto the main thread in this class. */
 void LensSolverWorkDistributor::QueueCalibrationResult(const FCalibrationResult calibrationResult)
 {
-	Lock();
+	LockJobs();
 
 	/* Get a handle to the job to access the data. */
 	FJob* jobPtr = jobs.Find(calibrationResult.baseParameters.jobID);
 	if (jobPtr == nullptr)
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): Unknown error occurred while queuing calibration result, no jobs are registered with ID: \"%s\"."), *calibrationResult.baseParameters.jobID));
-		Unlock();
+		/* Provisional solves can finish after the final solve of their job, those results are stale and dropped. */
+		if (!calibrationResult.provisional)
+			QueueLogAsync(FString::Printf(TEXT("(ERROR): Unknown error occurred while queuing calibration result, no jobs are registered with ID: \"%s\"."), *calibrationResult.baseParameters.jobID));
+		UnlockJobs();
 		return;
 	}
 
+	/* Provisional solves can also finish after the final solve of their calibration was latched. */
+	if (calibrationResult.provisional)
+	{
+		FExpectedAndCurrentImageCount* expectedAndCurrentImageCount = jobPtr->expectedAndCurrentImageCounts.Find(calibrationResult.baseParameters.calibrationID);
+		if (expectedAndCurrentImageCount == nullptr || expectedAndCurrentImageCount->currentImageCount > expectedAndCurrentImageCount->expectedImageCount - 1)
+		{
+			UnlockJobs();
+			return;
+		}
+	}
+
 	CalibrationResultQueueContainer queueContainer;
 	queueContainer.eventReceiver = jobPtr->eventReceiver;
 	queueContainer.calibrationResult = calibrationResult;
 
 	queuedCalibrationResults.Enqueue(queueContainer);
 
+	/* Provisional results do not count towards finishing the job, the next solve of the calibration starts from them. */
+	if (calibrationResult.provisional)
+	{
+		jobPtr->provisionalPrincipalPixelPoints.Add(calibrationResult.baseParameters.calibrationID, calibrationResult.principalPixelPoint);
+		UnlockJobs();
+		return;
+	}
+
+	jobPtr->jobInfo.calibrationSolveTimesMS.Add(calibrationResult.baseParameters.calibrationID, calibrationResult.solveTimeMS);
+
 	FJobInfo jobInfo;
 	bool done = false;
 
@@ -435,7 +813,13 @@ void LensSolverWorkDistributor::QueueCalibrationResult(const FCalibrationResult
 		done = true;
 	}
 
-	Unlock();
+	UnlockJobs();
+
+	if (done)
+		ClearTrackedCorners(jobInfo.calibrationIDs);
+
+	if (done && Debug())
+		LogWorkerStats();
 
 	PollShutdownAllWorkersIfNecessary();
  }
@@ -454,18 +838,33 @@ void LensSolverWorkDistributor::DequeueCalibrationResult(CalibrationResultQueueC
 feeding new frames into the system for calibration. */
 void LensSolverWorkDistributor::PollMediaTextureStreams()
 {
-	Lock();
+	LensSolverWorkDistributor* workDistributor = this;
+
+	/* Snapshots read back asynchronously are picked up on the render thread a frame or more after their copy was queued. */
+	if (pendingSnapshotReadbackCount > 0)
+	{
+		ENQUEUE_RENDER_COMMAND(MediaStreamSnapshotReadbackRenderCommand)
+		(
+			[workDistributor](FRHICommandListImmediate& RHICmdList)
+			{
+				workDistributor->PollSnapshotReadbacks(RHICmdList);
+			}
+		);
+	}
+
+	LockStreams();
 	if (mediaTextureJobLUT.Num() == 0)
 	{
-		Unlock();
+		UnlockStreams();
 		return;
 	}
 
-	LensSolverWorkDistributor* workDistributor = this;
-
 	TArray<FString> jobIDs;
 	mediaTextureJobLUT.GetKeys(jobIDs);
 
+	/* Job IDs of streams that skipped a snapshot this poll, the job's dropped frame count is in the jobs shard so it's updated after the streams lock is released. */
+	TArray<FString> droppedFrameJobIDs;
+
 	/* Loop through job IDs related to media stream calibration work units. */
 	for (int i = 0; i < jobIDs.Num(); i++)
 	{
@@ -479,6 +878,22 @@ void LensSolverWorkDistributor::PollMediaTextureStreams()
 
 		mediaStreamWorkUnit->mediaStreamParameters.previousSnapshotTime = tickNow;
 
+		/* If the workers have fallen behind, skip this snapshot rather than queuing another full frame into memory. */
+		int & inFlightSnapshotCount = mediaStreamInFlightSnapshotCounts.FindOrAdd(jobIDs[i]);
+		if (mediaStreamWorkUnit->mediaStreamParameters.maxInFlightSnapshots > 0 && 
+			inFlightSnapshotCount >= mediaStreamWorkUnit->mediaStreamParameters.maxInFlightSnapshots)
+		{
+			droppedFrameJobIDs.Add(jobIDs[i]);
+			INC_DWORD_STAT(STAT_LensCalibratorMediaStreamFramesDropped);
+
+			if (Debug())
+				QueueLogAsync(FString::Printf(TEXT("(INFO): Skipped media stream snapshot for calibration: \"%s\", %d snapshots are still in flight."), 
+					*mediaStreamWorkUnit->baseParameters.calibrationID,
+					inFlightSnapshotCount));
+
+			continue;
+		}
+
 		/* Determine whether the media stream texture is valid. */
 		if (!ValidateMediaTexture(mediaStreamWorkUnit->mediaStreamParameters.mediaTexture))
 		{
@@ -507,6 +922,8 @@ void LensSolverWorkDistributor::PollMediaTextureStreams()
 
 		/* Render command has been queued to take a snapshot of the media stream, so perform a count. */
 		mediaStreamWorkUnit->mediaStreamParameters.currentStreamSnapshotCount++;
+		inFlightSnapshotCount++;
+		INC_DWORD_STAT(STAT_LensCalibratorMediaStreamSnapshotsInFlight);
 
 		/* If we reached the expected snapshot count, finish the job. */
 		if (mediaStreamWorkUnit->mediaStreamParameters.currentStreamSnapshotCount > mediaStreamWorkUnit->mediaStreamParameters.expectedStreamSnapshotCount - 1)
@@ -526,7 +943,45 @@ void LensSolverWorkDistributor::PollMediaTextureStreams()
 				*mediaStreamWorkUnit->baseParameters.calibrationID));
 	}
 
-	Unlock();
+	UnlockStreams();
+
+	for (int i = 0; i < droppedFrameJobIDs.Num(); i++)
+		AddDroppedFrames(droppedFrameJobIDs[i], 1);
+}
+
+void LensSolverWorkDistributor::ReleaseMediaStreamSnapshot(const FString & jobID)
+{
+	LockStreams();
+
+	int * inFlightSnapshotCount = mediaStreamInFlightSnapshotCounts.Find(jobID);
+	if (inFlightSnapshotCount == nullptr)
+	{
+		UnlockStreams();
+		return;
+	}
+
+	if (*inFlightSnapshotCount > 0)
+	{
+		(*inFlightSnapshotCount)--;
+		DEC_DWORD_STAT(STAT_LensCalibratorMediaStreamSnapshotsInFlight);
+	}
+
+	/* Once all snapshots were queued and have been processed, the stream's entry is no longer needed. */
+	if (*inFlightSnapshotCount == 0 && !mediaTextureJobLUT.Contains(jobID))
+		mediaStreamInFlightSnapshotCounts.Remove(jobID);
+
+	UnlockStreams();
+}
+
+void LensSolverWorkDistributor::AddDroppedFrames(const FString & jobID, int droppedFrameCount)
+{
+	LockJobs();
+
+	FJob* jobPtr = jobs.Find(jobID);
+	if (jobPtr != nullptr)
+		jobPtr->jobInfo.droppedFrameCount += droppedFrameCount;
+
+	UnlockJobs();
 }
 
 /* Are we in debug mode? */
@@ -566,50 +1021,100 @@ bool LensSolverWorkDistributor::GetFindCornersContainerInterfacePtr(
 	return true;
 }
 
-bool LensSolverWorkDistributor::GetCalibrateWorkerInterfaceContainerPtr(
-	const FString calibrationID,
-	FWorkerCalibrateInterfaceContainer *& outputInterfaceContainerPtr)
+/* This only reads shared state so it can be called under the workers read lock, the work loads are 
+sampled once and sorted in a local array instead of sorting the shared worker ID array in place. */
+void LensSolverWorkDistributor::GetWorkLoadSortedFindCornersContainerInterfacePtrs(
+	TArray<FWorkerFindCornersInterfaceContainer*> & outputInterfaceContainerPtrs)
 {
-	if (calibrationID.IsEmpty())
+	TArray<TPair<int, FWorkerFindCornersInterfaceContainer*>> workLoads;
+
+	for (int i = 0; i < workLoadSortedFindCornerWorkers.Num(); i++)
 	{
-		QueueLogAsync("(ERROR): Received NULL LensSolverCalibrateWorkUnit with empty calibrationID FString member!");
-		return false;
+		FWorkerFindCornersInterfaceContainer * interfaceContainerPtr = nullptr;
+		if (workLoadSortedFindCornerWorkers[i].IsEmpty())
+		{
+			QueueLogAsync("(ERROR): A worker ID in the work load sorted FindCornerWorker array is empty!");
+			continue;
+		}
+
+		if (!GetFindCornersContainerInterfacePtr(workLoadSortedFindCornerWorkers[i], interfaceContainerPtr))
+			continue;
+
+		int workLoad = interfaceContainerPtr->baseContainer.getWorkLoadDel.IsBound() ? interfaceContainerPtr->baseContainer.getWorkLoadDel.Execute() : MAX_int32;
+		workLoads.Add(TPair<int, FWorkerFindCornersInterfaceContainer*>(workLoad, interfaceContainerPtr));
 	}
 
-	const FString* workerIDPtr = workerCalibrationIDLUT.Find(calibrationID);
-	FString workerID;
+	workLoads.StableSort([](const TPair<int, FWorkerFindCornersInterfaceContainer*> & a, const TPair<int, FWorkerFindCornersInterfaceContainer*> & b)
+	{
+		return a.Key < b.Key;
+	});
+
+	for (int i = 0; i < workLoads.Num(); i++)
+		outputInterfaceContainerPtrs.Add(workLoads[i].Value);
+}
+
+bool LensSolverWorkDistributor::GetLeastLoadedCalibrateWorkerInterfaceContainerPtr(
+	FWorkerCalibrateInterfaceContainer *& outputInterfaceContainerPtr)
+{
+	/* A single pass for the minimum only reads the workers, so concurrent latches don't serialize on the write lock. */
+	outputInterfaceContainerPtr = nullptr;
+	int leastWorkLoad = MAX_int32;
 
-	if (workerIDPtr == nullptr)
+	for (auto & workerContainer : calibrateWorkers)
 	{
-		SortCalibrateWorkersByWorkLoad();
-		workerID = workLoadSortedCalibrateWorkers[0];
-		workerCalibrationIDLUT.Add(calibrationID, workerID);
-	}
+		FWorkerCalibrateInterfaceContainer & interfaceContainer = workerContainer.Value;
+		if (!interfaceContainer.baseContainer.getWorkLoadDel.IsBound())
+			continue;
 
-	else workerID = *workerIDPtr;
+		int workLoad = interfaceContainer.baseContainer.getWorkLoadDel.Execute();
+		if (outputInterfaceContainerPtr == nullptr || workLoad < leastWorkLoad)
+		{
+			outputInterfaceContainerPtr = &interfaceContainer;
+			leastWorkLoad = workLoad;
+
+			/* Nothing beats an idle worker. */
+			if (workLoad == 0)
+				break;
+		}
+	}
 
-	outputInterfaceContainerPtr = calibrateWorkers.Find(workerID);
 	if (outputInterfaceContainerPtr == nullptr)
 	{
-		QueueLogAsync(FString::Printf(TEXT("(ERROR): We the worker ID: \"%s\". However, no CalibrateWorkerInterfaceContainer is registered with that ID!"), *workerID));
+		QueueLogAsync("(ERROR): There are no CalibrateWorkers registered to latch to!");
 		return false;
 	}
 
 	return true;
 }
 
-/* After we have processed an image by a find corner workers, this method will be called to iterate the current processed image 
-count and returns true if we have processed all images by the find corner background workers. */
-bool LensSolverWorkDistributor::IterateImageCount(const FString & jobID, const FString& calibrationID)
+/* After we have processed an image by a find corner workers, this method will be called to add it's view to the job, iterate the current processed 
+image count and return true with the latch to dispatch if we have processed all images of the calibration or a provisional solve is due. */
+bool LensSolverWorkDistributor::AccumulateCalibrationView(
+	FLensSolverCalibrationPointsWorkUnit & calibrateWorkUnit,
+	FCalibrateLatch & outputLatchData,
+	bool & outputHitExpectedImageCount)
 {
-	Lock();
+	const FString jobID = calibrateWorkUnit.baseParameters.jobID;
+	const FString calibrationID = calibrateWorkUnit.baseParameters.calibrationID;
+	outputHitExpectedImageCount = false;
+
+	if (calibrationID.IsEmpty())
+	{
+		QueueLogAsync("(ERROR): Received NULL LensSolverCalibrateWorkUnit with empty calibrationID FString member!");
+		return false;
+	}
+
+	outputLatchData.baseParameters		= calibrateWorkUnit.baseParameters;
+	outputLatchData.resizeParameters	= calibrateWorkUnit.resizeParameters;
+
+	LockJobs();
 
 	/* Get the job to retrieve information about that job. */
 	FJob* job = jobs.Find(jobID);
 	if (job == nullptr)
 	{
 		QueueLogAsync(FString::Printf(TEXT("(ERROR): Cannot iterate image count, no job with ID: \"%s\" registered."), *jobID));
-		Unlock();
+		UnlockJobs();
 		return false;
 	}
 
@@ -618,67 +1123,93 @@ bool LensSolverWorkDistributor::IterateImageCount(const FString & jobID, const F
 	if (expectedAndCurrentImageCount == nullptr)
 	{
 		QueueLogAsync(FString::Printf(TEXT("(ERROR): Cannot iterate image count, the job: \"%s\" does not contain the calibration ID: \"%s\"."), *jobID, *calibrationID));
-		Unlock();
+		UnlockJobs();
 		return false;
 	}
 
+	/* Images without a detected calibration pattern only count towards the processed images. */
+	if (calibrateWorkUnit.calibrationPointParameters.corners.Num() > 0)
+		job->calibrationViews.FindOrAdd(calibrationID).Add(MakeShared<FLensSolverCalibrationPointsWorkUnit, ESPMode::ThreadSafe>(MoveTemp(calibrateWorkUnit)));
+
+	else if (Debug())
+		QueueLogAsync(FString::Printf(TEXT("(WARNING): No detected calibration pattern corners in image: \"%s\" for calibration: \"%s\", skipping and continuing to next image."),
+			*outputLatchData.baseParameters.friendlyName,
+			*calibrationID));
+
 	int currentImageCount = expectedAndCurrentImageCount->currentImageCount;
 	int expectedImageCount = expectedAndCurrentImageCount->expectedImageCount;
 
 	currentImageCount++;
 	expectedAndCurrentImageCount->currentImageCount = currentImageCount;
 
-	/* Have we processed all the images? */
-	if (currentImageCount > expectedImageCount - 1)
-	{
-		QueueLogAsync(FString::Printf(TEXT("(INFO): Completed processing all images of count %d/%d for calibration: \"%s\"."), currentImageCount, expectedImageCount, *calibrationID));
+	/* Have we processed all the images? Otherwise refine the calibration with the views found so far every provisionalSolveInterval images. */
+	outputHitExpectedImageCount = currentImageCount > expectedImageCount - 1;
+	int provisionalSolveInterval = cachedCalibrationParameters.provisionalSolveInterval;
+	TArray<FLensSolverCalibrationViewPtr> * viewsPtr = job->calibrationViews.Find(calibrationID);
+
+	bool provisional = 
+		!outputHitExpectedImageCount && 
+		provisionalSolveInterval > 0 && 
+		currentImageCount % provisionalSolveInterval == 0 &&
+		viewsPtr != nullptr;
 
-		Unlock();
+	if (!outputHitExpectedImageCount && !provisional)
+	{
+		UnlockJobs();
+		QueueLogAsync(FString::Printf(TEXT("(INFO): Iterate image count %d/%d for calibration: \"%s\"."), currentImageCount, expectedImageCount, *calibrationID));
 
-		/* We have processed all the images. */
-		return true;
+		/* We have not processed all the images. */
+		return false;
 	}
 
-	Unlock();
-	QueueLogAsync(FString::Printf(TEXT("(INFO): Iterate image count %d/%d for calibration: \"%s\"."), currentImageCount, expectedImageCount, *calibrationID));
+	outputLatchData.calibrationParameters	= cachedCalibrationParameters;
+	outputLatchData.provisional				= provisional;
 
-	/* We have not processed all the images. */
-	return false;
-}
+	/* Only provisional solves warm start, the final solve starts from the calibration parameters like it would without provisional solves. */
+	FVector2D * provisionalPrincipalPixelPointPtr = job->provisionalPrincipalPixelPoints.Find(calibrationID);
+	if (provisional && provisionalPrincipalPixelPointPtr != nullptr)
+	{
+		outputLatchData.warmStart						= true;
+		outputLatchData.warmStartPrincipalPixelPoint	= *provisionalPrincipalPixelPointPtr;
+	}
 
-void LensSolverWorkDistributor::SortFindCornersWorkersByWorkLoad()
-{
-	LensSolverWorkDistributor* workDistributor = this;
-	workLoadSortedFindCornerWorkers.Sort([workDistributor](const FString& workerAID, const FString& workerBID) 
+	/* Provisional solves share the views found so far, the final solve takes them. */
+	if (provisional)
+		outputLatchData.views = *viewsPtr;
+
+	else
 	{
-		FWorkerFindCornersInterfaceContainer * interfaceContainerA = workDistributor->findCornersWorkers.Find(workerAID);
-		FWorkerFindCornersInterfaceContainer * interfaceContainerB = workDistributor->findCornersWorkers.Find(workerBID);
+		if (viewsPtr != nullptr)
+			outputLatchData.views = MoveTemp(*viewsPtr);
 
-		if (interfaceContainerA == nullptr || 
-			interfaceContainerB == nullptr ||
-			!interfaceContainerA->baseContainer.getWorkLoadDel.IsBound() ||
-			!interfaceContainerB->baseContainer.getWorkLoadDel.IsBound())
-			return false;
+		job->calibrationViews.Remove(calibrationID);
+		job->provisionalPrincipalPixelPoints.Remove(calibrationID);
+	}
 
-		return interfaceContainerA->baseContainer.getWorkLoadDel.Execute() < interfaceContainerB->baseContainer.getWorkLoadDel.Execute();
-	});
-}
+	UnlockJobs();
 
-void LensSolverWorkDistributor::SortCalibrateWorkersByWorkLoad()
-{
-	LensSolverWorkDistributor* workDistributor = this;
-	workLoadSortedCalibrateWorkers.Sort([workDistributor](const FString & workerAID, const FString & workerBID) 
+	/* The latch starts timing from the first of it's views to be queued, each view of the final latch records how long it waited for the rest. */
+	FPipelineTimestamps & latchTimestamps = outputLatchData.baseParameters.pipelineTimestamps;
+	latchTimestamps.latched = FPlatformTime::Seconds();
+
+	for (int i = 0; i < outputLatchData.views.Num(); i++)
 	{
-		FWorkerCalibrateInterfaceContainer * interfaceContainerA = workDistributor->calibrateWorkers.Find(workerAID);
-		FWorkerCalibrateInterfaceContainer * interfaceContainerB = workDistributor->calibrateWorkers.Find(workerBID);
-		if (interfaceContainerA == nullptr || 
-			interfaceContainerB == nullptr ||
-			!interfaceContainerA->baseContainer.getWorkLoadDel.IsBound() ||
-			!interfaceContainerB->baseContainer.getWorkLoadDel.IsBound())
-			return false;
+		const FPipelineTimestamps & viewTimestamps = outputLatchData.views[i]->baseParameters.pipelineTimestamps;
+		if (viewTimestamps.queued > 0.0 && (latchTimestamps.queued == 0.0 || viewTimestamps.queued < latchTimestamps.queued))
+			latchTimestamps.queued = viewTimestamps.queued;
 
-		return interfaceContainerA->baseContainer.getWorkLoadDel.Execute() < interfaceContainerB->baseContainer.getWorkLoadDel.Execute();
-	});
+		if (!provisional)
+			LensSolverPipelineLatency::Get().Record(UPipelineStage::LatchWait, viewTimestamps.cornersFound, latchTimestamps.latched);
+	}
+
+	latchTimestamps.decoded = 0.0;
+	latchTimestamps.dequeued = 0.0;
+	latchTimestamps.cornersFound = 0.0;
+
+	if (outputHitExpectedImageCount)
+		QueueLogAsync(FString::Printf(TEXT("(INFO): Completed processing all images of count %d/%d for calibration: \"%s\"."), currentImageCount, expectedImageCount, *calibrationID));
+
+	return true;
 }
 
 void LensSolverWorkDistributor::PollShutdownFindCornerWorkersIfNecessary()
@@ -689,11 +1220,11 @@ void LensSolverWorkDistributor::PollShutdownFindCornerWorkersIfNecessary()
 	TQueue<IsClosingOutputDel> isClosingDelQueue;
 	bool allImagesProcessed = true;
 
-	Lock();
+	LockJobs();
 
-	for (auto job : jobs)
+	for (auto & job : jobs)
 	{
-		for (auto expectedAndCurrentImageCount : job.Value.expectedAndCurrentImageCounts)
+		for (auto & expectedAndCurrentImageCount : job.Value.expectedAndCurrentImageCounts)
 		{
 			if (expectedAndCurrentImageCount.Value.currentImageCount < expectedAndCurrentImageCount.Value.expectedImageCount)
 			{
@@ -703,63 +1234,112 @@ void LensSolverWorkDistributor::PollShutdownFindCornerWorkersIfNecessary()
 		}
 	}
 
-	if (allImagesProcessed)
-	{
-		for (auto workerContainer : findCornersWorkers)
-			isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
-	}
+	UnlockJobs();
+
+	if (!allImagesProcessed)
+		return;
 
-	Unlock();
+	WriteLockWorkers();
 
-	if (allImagesProcessed)
-	{
-		while (!isClosingDelQueue.IsEmpty())
-		{
-			IsClosingOutputDel isClosingDel;
-			isClosingDelQueue.Dequeue(isClosingDel);
-			if (isClosingDel.IsBound())
-				isClosingDel.Execute();
-		}
+	for (auto & workerContainer : findCornersWorkers)
+		isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
 
-		findCornersWorkers.Empty();
-		workLoadSortedFindCornerWorkers.Empty();
+	findCornersWorkers.Empty();
+	workLoadSortedFindCornerWorkers.Empty();
+
+	WriteUnlockWorkers();
+
+	while (!isClosingDelQueue.IsEmpty())
+	{
+		IsClosingOutputDel isClosingDel;
+		isClosingDelQueue.Dequeue(isClosingDel);
+		if (isClosingDel.IsBound())
+			isClosingDel.Execute();
 	}
 }
 
 void LensSolverWorkDistributor::PollShutdownAllWorkersIfNecessary()
 {
-	if (!shutDownWorkersAfterCompletedTasks || jobs.Num() != 0)
+	if (!shutDownWorkersAfterCompletedTasks)
 		return;
 
-	TQueue<IsClosingOutputDel*> isClosingDelQueue;
-	Lock();
+	LockJobs();
+	bool jobsRemaining = jobs.Num() != 0;
+	UnlockJobs();
 
-	for (auto workerContainer : findCornersWorkers)
-		isClosingDelQueue.Enqueue(&workerContainer.Value.baseContainer.isClosingDel);
+	if (jobsRemaining)
+		return;
 
-	for (auto workerContainer : calibrateWorkers)
-		isClosingDelQueue.Enqueue(&workerContainer.Value.baseContainer.isClosingDel);
+	StopTaskGraphExecutors();
 
-	Unlock();
+	TQueue<IsClosingOutputDel> isClosingDelQueue;
+	WriteLockWorkers();
 
-	while (!isClosingDelQueue.IsEmpty())
-	{
-		IsClosingOutputDel * isClosingDel;
-		isClosingDelQueue.Dequeue(isClosingDel);
-		if (isClosingDel->IsBound())
-			isClosingDel->Execute();
-	}
+	for (auto & workerContainer : findCornersWorkers)
+		isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
+
+	for (auto & workerContainer : calibrateWorkers)
+		isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
 
 	findCornersWorkers.Empty();
 	workLoadSortedFindCornerWorkers.Empty();
 
 	calibrateWorkers.Empty();
-	workLoadSortedCalibrateWorkers.Empty();
-	workerCalibrationIDLUT.Empty();
 
+	WriteUnlockWorkers();
+
+	while (!isClosingDelQueue.IsEmpty())
+	{
+		IsClosingOutputDel isClosingDel;
+		isClosingDelQueue.Dequeue(isClosingDel);
+		if (isClosingDel.IsBound())
+			isClosingDel.Execute();
+	}
+
+	LockJobs();
 	jobs.Empty();
-	workerCalibrationIDLUT.Empty();
+	UnlockJobs();
+
+	LockStreams();
 	mediaTextureJobLUT.Empty();
+	mediaStreamInFlightSnapshotCounts.Empty();
+	trackedCorners.Empty();
+	SET_DWORD_STAT(STAT_LensCalibratorMediaStreamSnapshotsInFlight, 0);
+	UnlockStreams();
+}
+
+/* Print wakeup latency, utilisation and work stealing counts of each worker, this is useful to determine whether workers are starved or idling. */
+void LensSolverWorkDistributor::LogWorkerStats()
+{
+	TArray<FLensSolverWorkerStats> workerStats;
+
+	ReadLockWorkers();
+	for (auto & entry : findCornersWorkers)
+		if (entry.Value.baseContainer.getWorkerStatsDel.IsBound())
+			workerStats.Add(entry.Value.baseContainer.getWorkerStatsDel.Execute());
+
+	for (auto & entry : calibrateWorkers)
+		if (entry.Value.baseContainer.getWorkerStatsDel.IsBound())
+			workerStats.Add(entry.Value.baseContainer.getWorkerStatsDel.Execute());
+	ReadUnlockWorkers();
+
+	for (int i = 0; i < workerStats.Num(); i++)
+	{
+		QueueLogAsync(FString::Printf(TEXT("(INFO): Worker: \"%s\" woke up %d times with wakeup latency (last: %f ms, average: %f ms, max: %f ms)."),
+			*workerStats[i].workerID,
+			workerStats[i].wakeupCount,
+			workerStats[i].lastWakeupLatencyMS,
+			workerStats[i].averageWakeupLatencyMS,
+			workerStats[i].maxWakeupLatencyMS));
+
+		QueueLogAsync(FString::Printf(TEXT("(INFO): Worker: \"%s\" processed %d ticks in %f ms with utilisation: %f, stole %d work units and lost %d work units to peers."),
+			*workerStats[i].workerID,
+			workerStats[i].processedTickCount,
+			workerStats[i].busyTimeMS,
+			workerStats[i].utilisation,
+			workerStats[i].stolenWorkUnitCount,
+			workerStats[i].lostWorkUnitCount));
+	}
 }
 
 bool LensSolverWorkDistributor::ValidateMediaTexture(const UMediaTexture* inputTexture)
@@ -780,14 +1360,58 @@ bool LensSolverWorkDistributor::ValidateMediaTexture(const UMediaTexture* inputT
 	return true;
 }
 
-void LensSolverWorkDistributor::Lock()
+/* Contention is counted by first trying to take the lock without blocking. */
+void LensSolverWorkDistributor::LockJobs()
 {
-	threadLock.Lock();
+	if (!jobsLock.TryLock())
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorJobsLockContentions);
+		jobsLock.Lock();
+	}
 }
 
-void LensSolverWorkDistributor::Unlock()
+void LensSolverWorkDistributor::UnlockJobs()
 {
-	threadLock.Unlock();
+	jobsLock.Unlock();
+}
+
+/* FRWLock has no non-blocking variant on all platforms, so the time spent waiting is recorded instead. */
+void LensSolverWorkDistributor::ReadLockWorkers()
+{
+	uint32 startCycles = FPlatformTime::Cycles();
+	workersLock.ReadLock();
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorWorkersLockWaitTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles));
+}
+
+void LensSolverWorkDistributor::ReadUnlockWorkers()
+{
+	workersLock.ReadUnlock();
+}
+
+void LensSolverWorkDistributor::WriteLockWorkers()
+{
+	uint32 startCycles = FPlatformTime::Cycles();
+	workersLock.WriteLock();
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorWorkersLockWaitTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles));
+}
+
+void LensSolverWorkDistributor::WriteUnlockWorkers()
+{
+	workersLock.WriteUnlock();
+}
+
+void LensSolverWorkDistributor::LockStreams()
+{
+	if (!streamsLock.TryLock())
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorStreamsLockContentions);
+		streamsLock.Lock();
+	}
+}
+
+void LensSolverWorkDistributor::UnlockStreams()
+{
+	streamsLock.Unlock();
 }
 
 int64 LensSolverWorkDistributor::GetTickNow()
@@ -799,65 +1423,96 @@ int64 LensSolverWorkDistributor::GetTickNow()
 void LensSolverWorkDistributor::StopFindCornerWorkers()
 {
 	UE_LOG(LogTemp, Log, TEXT("Stopping find corner workers."));
-	Lock();
+	WriteLockWorkers();
 	if (findCornersWorkers.Num() == 0)
 	{
-		Unlock();
+		WriteUnlockWorkers();
 		return;
 	}
 
-	TArray<FString> workerIDs;
-	findCornersWorkers.GetKeys(workerIDs);
-	for (int i = 0; i < workerIDs.Num(); i++)
-	{
-		FWorkerFindCornersInterfaceContainer* interfaceContainerPtr = findCornersWorkers.Find(workerIDs[i]);
-		if (interfaceContainerPtr == nullptr)
-			continue;
-
-		/* Flag to the find corner workers that they shut exit their loops. */
-		if (interfaceContainerPtr->baseContainer.isClosingDel.IsBound())
-			interfaceContainerPtr->baseContainer.isClosingDel.Execute();
-	}
-
-	Unlock();
+	TQueue<IsClosingOutputDel> isClosingDelQueue;
+	for (auto & workerContainer : findCornersWorkers)
+		isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
 
 	/* Clean up relevant structures. */
 	findCornersWorkers.Empty();
 	workLoadSortedFindCornerWorkers.Empty();
+
+	WriteUnlockWorkers();
+
+	/* Flag to the find corner workers that they shut exit their loops, outside of the lock like PollShutdownFindCornerWorkersIfNecessary. */
+	while (!isClosingDelQueue.IsEmpty())
+	{
+		IsClosingOutputDel isClosingDel;
+		isClosingDelQueue.Dequeue(isClosingDel);
+		if (isClosingDel.IsBound())
+			isClosingDel.Execute();
+	}
 }
 
 void LensSolverWorkDistributor::StopCalibrationWorkers()
 {
 	UE_LOG(LogTemp, Log, TEXT("Stopping calibration workers."));
-	Lock();
+	WriteLockWorkers();
 	if (calibrateWorkers.Num() == 0)
 	{
-		Unlock();
+		WriteUnlockWorkers();
 		return;
 	}
 
-	TArray<FString> workerIDs;
-	calibrateWorkers.GetKeys(workerIDs);
-	for (int i = 0; i < workerIDs.Num(); i++)
-	{
-		FWorkerCalibrateInterfaceContainer* interfaceContainerPtr = calibrateWorkers.Find(workerIDs[i]);
-		if (interfaceContainerPtr == nullptr)
-			continue;
-
-		/* Flag to the calibration workers that they shut exit their loops. */
-		if (interfaceContainerPtr->baseContainer.isClosingDel.IsBound())
-			interfaceContainerPtr->baseContainer.isClosingDel.Execute();
-	}
+	TQueue<IsClosingOutputDel> isClosingDelQueue;
+	for (auto & workerContainer : calibrateWorkers)
+		isClosingDelQueue.Enqueue(workerContainer.Value.baseContainer.isClosingDel);
 
 	/* Clean up structures. */
 	calibrateWorkers.Empty();
-	workLoadSortedCalibrateWorkers.Empty();
-	workerCalibrationIDLUT.Empty();
+	WriteUnlockWorkers();
+
+	/* Flag to the calibration workers that they shut exit their loops. */
+	while (!isClosingDelQueue.IsEmpty())
+	{
+		IsClosingOutputDel isClosingDel;
+		isClosingDelQueue.Dequeue(isClosingDel);
+		if (isClosingDel.IsBound())
+			isClosingDel.Execute();
+	}
 
+	LockJobs();
 	jobs.Empty();
-	workerCalibrationIDLUT.Empty();
+	UnlockJobs();
+
+	LockStreams();
 	mediaTextureJobLUT.Empty();
-	Unlock();
+	mediaStreamInFlightSnapshotCounts.Empty();
+	trackedCorners.Empty();
+	SET_DWORD_STAT(STAT_LensCalibratorMediaStreamSnapshotsInFlight, 0);
+	UnlockStreams();
+}
+
+void LensSolverWorkDistributor::StopTaskGraphExecutors()
+{
+	WriteLockWorkers();
+	if (!useTaskGraph)
+	{
+		WriteUnlockWorkers();
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Stopping task graph executors."));
+	useTaskGraph = false;
+
+	/* Flag the executors to exit so in flight tasks stop queuing their results. */
+	findCornersTaskExecutor->ExitTaskExecutor();
+	calibrateTaskExecutor->ExitTaskExecutor();
+
+	/* In flight tasks hold their own references to the executors and the interface containers the executors 
+	hold pointers into, so only drop ours and let the last task referencing them destroy them. */
+	findCornersTaskExecutor.Reset();
+	calibrateTaskExecutor.Reset();
+	findCornersTaskExecutorInterfaceContainer.Reset();
+	calibrateTaskExecutorInterfaceContainer.Reset();
+
+	WriteUnlockWorkers();
 }
 
 void LensSolverWorkDistributor::StopBackgroundWorkers()
@@ -865,23 +1520,27 @@ void LensSolverWorkDistributor::StopBackgroundWorkers()
 	UE_LOG(LogTemp, Log, TEXT("Stopping background workers."));
 	StopFindCornerWorkers();
 	StopCalibrationWorkers();
+	StopTaskGraphExecutors();
+
+	/* Buffers still referenced by in flight work units return to the pool when released, only idle ones are freed here. */
+	pixelBufferPool->Trim();
 }
 
 int LensSolverWorkDistributor::GetFindCornerWorkerCount()
 {
 	int count = 0;
-	Lock();
+	ReadLockWorkers();
 	count = findCornersWorkers.Num();
-	Unlock();
+	ReadUnlockWorkers();
 	return count;
 }
 
 int LensSolverWorkDistributor::GetCalibrateCount()
 {
 	int count = 0;
-	Lock();
+	ReadLockWorkers();
 	count = calibrateWorkers.Num();
-	Unlock();
+	ReadUnlockWorkers();
 	return count;
 }
 
@@ -891,7 +1550,10 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 {
 	/* We should check again whether the media stream texture is still valid since we are in the render thread. */
 	if (!ValidateMediaTexture(mediaStreamWorkUnit.mediaStreamParameters.mediaTexture))
+	{
+		ReleaseMediaStreamSnapshot(mediaStreamWorkUnit.baseParameters.jobID);
 		return;
+	}
 
 	/* If this boolean is toggled in the calibration parameters, then we will save a snapshot of the stream before we do any processing on it. */
 	if (mediaStreamWorkUnit.mediaStreamParameters.writePreBlitRenderTextureToFile)
@@ -926,6 +1588,7 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 	/* Determine what the size of our snapshot buffer should be. */
 	int width = mediaStreamWorkUnit.textureSearchParameters.resize ? mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetWidth() * mediaStreamWorkUnit.textureSearchParameters.resizePercentage : mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetWidth();
 	int height = mediaStreamWorkUnit.textureSearchParameters.resize ? mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetHeight() * mediaStreamWorkUnit.textureSearchParameters.resizePercentage : mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetHeight();
+	int stride = mediaStreamWorkUnit.mediaStreamParameters.grayscaleSnapshot ? 1 : 4;
 
 	FTexture2DRHIRef blitRenderTexture;
 	FRHIResourceCreateInfo createInfo;
@@ -934,8 +1597,8 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 	RHICreateTargetableShaderResource2D(
 		width,
 		height,
-		/* BGRA with all channels 8 bits. */
-		EPixelFormat::PF_B8G8R8A8,
+		/* Either a single 8 bit grayscale channel or BGRA with all channels 8 bits. */
+		stride == 1 ? EPixelFormat::PF_G8 : EPixelFormat::PF_B8G8R8A8,
 		1,
 		TexCreate_Transient,
 		TexCreate_RenderTargetable,
@@ -980,18 +1643,182 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 	RHICmdList.EndRenderPass();
 
 	FRHITexture2D * texture2D = blitRenderTexture->GetTexture2D();
-	TArray<FColor> surfaceData;
 
-	FReadSurfaceDataFlags ReadDataFlags;
-	ReadDataFlags.SetLinearToGamma(false);
-	ReadDataFlags.SetOutputStencil(false);
-	ReadDataFlags.SetMip(0);
+	/* Pick up any earlier snapshots the GPU has finished copying before we queue another one. */
+	if (UseAsyncSnapshotReadback())
+	{
+		PollSnapshotReadbacks(RHICmdList);
+		if (EnqueueSnapshotReadback(RHICmdList, texture2D, mediaStreamWorkUnit, width, height, stride))
+			return;
+
+		if (Debug())
+			QueueLogAsync("(INFO): All snapshot readback staging textures are in use, falling back to blocking readback.");
+	}
+
+	/* Copy the snapshot into the staging texture kept for blocking readbacks, mapping it blocks the render thread until the GPU has completed 
+	the blit and the copy. ReadSurfaceData would expand the pixels to FColor in an array of it's own first, which is one more copy. */
+	PrepareSnapshotReadbackStagingTexture(blockingSnapshotReadback, width, height, stride);
+	RHICmdList.CopyToResolveTarget(texture2D, blockingSnapshotReadback.stagingTexture, FResolveParams());
+
+	void * data = nullptr;
+	int rowPitchInPixels = 0;
+	int mappedHeight = 0;
+
+	RHICmdList.MapStagingSurface(blockingSnapshotReadback.stagingTexture, data, rowPitchInPixels, mappedHeight);
+	INC_DWORD_STAT(STAT_LensCalibratorBlockingSnapshotReadbacks);
 
-	/* Read pixels from texture into surfaceData pixel array. */
-	RHICmdList.ReadSurfaceData(texture2D, FIntRect(0, 0, width, height), surfaceData, ReadDataFlags);
+	FLensSolverPixelBufferPtr surfaceData;
+	if (data != nullptr)
+		surfaceData = CopyMappedSnapshot(*pixelBufferPool, data, rowPitchInPixels, width, height, stride);
 
-	uint32 ExtendXWithMSAA = surfaceData.Num() / texture2D->GetSizeY();
+	RHICmdList.UnmapStagingSurface(blockingSnapshotReadback.stagingTexture);
+
+	if (!surfaceData.IsValid())
+	{
+		QueueLogAsync(FString::Printf(TEXT("(ERROR): Unable to map snapshot readback staging texture for calibration: \"%s\"."), *mediaStreamWorkUnit.baseParameters.calibrationID));
+		ReleaseMediaStreamSnapshot(mediaStreamWorkUnit.baseParameters.jobID);
+		return;
+	}
+
+	QueueMediaStreamSnapshotPixels(mediaStreamWorkUnit, MoveTemp(surfaceData), width, height, stride);
+}
+
+bool LensSolverWorkDistributor::UseAsyncSnapshotReadback()
+{
+	if (GUsingNullRHI)
+		return false;
+
+	static IConsoleVariable * variable = IConsoleManager::Get().FindConsoleVariable(TEXT("LensCalibrator.AsyncSnapshotReadback"));
+	return variable != nullptr && variable->GetInt() != 0;
+}
+
+bool LensSolverWorkDistributor::EnqueueSnapshotReadback(
+	FRHICommandListImmediate& RHICmdList,
+	FRHITexture2D* snapshotTexture,
+	const FMediaStreamWorkUnit & mediaStreamWorkUnit,
+	int width,
+	int height,
+	int stride)
+{
+	FMediaStreamSnapshotReadback * readback = nullptr;
+	for (int i = 0; i < snapshotReadbackRingSize; i++)
+	{
+		if (!snapshotReadbacks[i].inUse)
+		{
+			readback = &snapshotReadbacks[i];
+			break;
+		}
+	}
+
+	if (readback == nullptr)
+		return false;
+
+	PrepareSnapshotReadbackStagingTexture(*readback, width, height, stride);
+
+	if (!readback->fence.IsValid())
+		readback->fence = RHICreateGPUFence(TEXT("LensCalibratorSnapshotReadbackFence"));
+
+	readback->fence->Clear();
+	RHICmdList.CopyToResolveTarget(snapshotTexture, readback->stagingTexture, FResolveParams());
+	RHICmdList.WriteGPUFence(readback->fence);
+
+	readback->mediaStreamWorkUnit = mediaStreamWorkUnit;
+	readback->inUse = true;
+	pendingSnapshotReadbackCount++;
+	INC_DWORD_STAT(STAT_LensCalibratorAsyncSnapshotReadbacks);
+
+	return true;
+}
+
+/* Staging textures are reused between snapshots and only recreated if the stream resolution or format changes. */
+void LensSolverWorkDistributor::PrepareSnapshotReadbackStagingTexture(
+	FMediaStreamSnapshotReadback & readback,
+	int width,
+	int height,
+	int stride)
+{
+	if (readback.stagingTexture.IsValid() && readback.width == width && readback.height == height && readback.stride == stride)
+		return;
 
+	FRHIResourceCreateInfo createInfo;
+	readback.stagingTexture = RHICreateTexture2D(
+		width,
+		height,
+		stride == 1 ? EPixelFormat::PF_G8 : EPixelFormat::PF_B8G8R8A8,
+		1,
+		1,
+		TexCreate_CPUReadback,
+		createInfo);
+
+	readback.width = width;
+	readback.height = height;
+	readback.stride = stride;
+}
+
+/* The staging texture's rows may be padded, so copy row by row into a tightly packed pixel array. This is the only copy of 
+the pixels, from here on the buffer is shared by reference until corner detection is done. */
+FLensSolverPixelBufferPtr LensSolverWorkDistributor::CopyMappedSnapshot(
+	FLensSolverPixelBufferPool & pool,
+	const void * data,
+	int rowPitchInPixels,
+	int width,
+	int height,
+	int stride)
+{
+	int rowSize = width * stride;
+	FLensSolverPixelBufferPtr surfaceData = pool.Acquire(rowSize * height);
+	INC_DWORD_STAT(STAT_LensCalibratorPixelBufferCopies);
+
+	const uint8 * source = static_cast<const uint8*>(data);
+	for (int y = 0; y < height; y++)
+		FMemory::Memcpy(surfaceData->GetData() + y * rowSize, source + y * rowPitchInPixels * stride, rowSize);
+
+	return surfaceData;
+}
+
+void LensSolverWorkDistributor::PollSnapshotReadbacks(FRHICommandListImmediate& RHICmdList)
+{
+	for (int i = 0; i < snapshotReadbackRingSize; i++)
+	{
+		FMediaStreamSnapshotReadback & readback = snapshotReadbacks[i];
+		if (!readback.inUse || !readback.fence->Poll())
+			continue;
+
+		void * data = nullptr;
+		int rowPitchInPixels = 0;
+		int mappedHeight = 0;
+
+		RHICmdList.MapStagingSurface(readback.stagingTexture, data, rowPitchInPixels, mappedHeight);
+
+		FLensSolverPixelBufferPtr surfaceData;
+		if (data != nullptr)
+			surfaceData = CopyMappedSnapshot(*pixelBufferPool, data, rowPitchInPixels, readback.width, readback.height, readback.stride);
+
+		RHICmdList.UnmapStagingSurface(readback.stagingTexture);
+
+		FMediaStreamWorkUnit mediaStreamWorkUnit = readback.mediaStreamWorkUnit;
+		readback.mediaStreamWorkUnit = FMediaStreamWorkUnit();
+		readback.inUse = false;
+		pendingSnapshotReadbackCount--;
+
+		if (data == nullptr)
+		{
+			QueueLogAsync(FString::Printf(TEXT("(ERROR): Unable to map snapshot readback staging texture for calibration: \"%s\"."), *mediaStreamWorkUnit.baseParameters.calibrationID));
+			ReleaseMediaStreamSnapshot(mediaStreamWorkUnit.baseParameters.jobID);
+			continue;
+		}
+
+		QueueMediaStreamSnapshotPixels(mediaStreamWorkUnit, MoveTemp(surfaceData), readback.width, readback.height, readback.stride);
+	}
+}
+
+void LensSolverWorkDistributor::QueueMediaStreamSnapshotPixels(
+	const FMediaStreamWorkUnit & mediaStreamWorkUnit,
+	FLensSolverPixelBufferPtr surfaceData,
+	int width,
+	int height,
+	int stride)
+{
 	/* After media stream snapshot occurs, we can also write that snapshot to to a file for debugging. */
 	if (mediaStreamWorkUnit.mediaStreamParameters.writePostBlitRenderTextureToFile)
 	{
@@ -1001,7 +1828,13 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 		backupOutputDir = FPaths::Combine(backupOutputDir, folder);
 		if (LensSolverUtilities::ValidateFilePath(outputPath, backupOutputDir, "MediaStreamSnapshot", "bmp"))
 		{
-			FFileHelper::CreateBitmap(*outputPath, ExtendXWithMSAA, texture2D->GetSizeY(), surfaceData.GetData());
+			/* Bitmaps are written from BGRA so grayscale snapshots are expanded for debugging. */
+			TArray<FColor> bitmapPixels;
+			bitmapPixels.SetNumUninitialized(width * height);
+			for (int i = 0; i < bitmapPixels.Num(); i++)
+				bitmapPixels[i] = stride == 1 ? FColor((*surfaceData)[i], (*surfaceData)[i], (*surfaceData)[i], 255) : reinterpret_cast<const FColor*>(surfaceData->GetData())[i];
+
+			FFileHelper::CreateBitmap(*outputPath, width, height, bitmapPixels.GetData());
 			UE_LOG(LogTemp, Log, TEXT("Wrote post blit input texture to file: \"%s\"."), *outputPath);
 		}
 	}
@@ -1016,12 +1849,86 @@ void LensSolverWorkDistributor::MediaTextureRenderThread(
 	pixelArrayWorkUnit.baseParameters = mediaStreamWorkUnit.baseParameters;
 	pixelArrayWorkUnit.textureSearchParameters = mediaStreamWorkUnit.textureSearchParameters;
 	pixelArrayWorkUnit.textureSearchParameters.resize = false;
-	pixelArrayWorkUnit.pixelArrayParameters.pixels = surfaceData;
+	pixelArrayWorkUnit.pixelArrayParameters.pixels = MoveTemp(surfaceData);
+	pixelArrayWorkUnit.pixelArrayParameters.stride = stride;
 
 	pixelArrayWorkUnit.resizeParameters.sourceX = mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetWidth();
-	pixelArrayWorkUnit.resizeParameters.sourceX = mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetHeight();
+	pixelArrayWorkUnit.resizeParameters.sourceY = mediaStreamWorkUnit.mediaStreamParameters.mediaTexture->GetHeight();
 	pixelArrayWorkUnit.resizeParameters.resizeX = width;
 	pixelArrayWorkUnit.resizeParameters.resizeY = height;
+	pixelArrayWorkUnit.cornerSearchParameters = mediaStreamWorkUnit.cornerSearchParameters;
+
+	QueueTextureArrayWorkUnit(mediaStreamWorkUnit.baseParameters.jobID, MoveTemp(pixelArrayWorkUnit));
+}
+
+FLensSolverPixelBufferPtr LensSolverWorkDistributor::AcquirePixelBuffer(int32 byteCount)
+{
+	return pixelBufferPool->Acquire(byteCount);
+}
+
+bool LensSolverWorkDistributor::GetTrackedCorners(
+	const FString & calibrationID,
+	int width,
+	int height,
+	int maxConsecutiveTrackedSnapshots,
+	TArray<float> & outputCorners)
+{
+	LockStreams();
 
-	QueueTextureArrayWorkUnit(pixelArrayWorkUnit.baseParameters.jobID, pixelArrayWorkUnit);
+	const FTrackedCorners * trackedCornersPtr = trackedCorners.Find(calibrationID);
+	if (trackedCornersPtr == nullptr || 
+		trackedCornersPtr->width != width || 
+		trackedCornersPtr->height != height ||
+		(maxConsecutiveTrackedSnapshots > 0 && trackedCornersPtr->consecutiveTrackedSnapshots >= maxConsecutiveTrackedSnapshots))
+	{
+		UnlockStreams();
+		return false;
+	}
+
+	outputCorners = trackedCornersPtr->corners;
+
+	UnlockStreams();
+	return true;
+}
+
+void LensSolverWorkDistributor::SetTrackedCorners(
+	const FString & calibrationID,
+	int width,
+	int height,
+	const TArray<float> & corners,
+	bool tracked)
+{
+	LockStreams();
+
+	FTrackedCorners & calibrationTrackedCorners = trackedCorners.FindOrAdd(calibrationID);
+	calibrationTrackedCorners.corners = corners;
+	calibrationTrackedCorners.width = width;
+	calibrationTrackedCorners.height = height;
+	calibrationTrackedCorners.consecutiveTrackedSnapshots = tracked ? calibrationTrackedCorners.consecutiveTrackedSnapshots + 1 : 0;
+
+	UnlockStreams();
+}
+
+void LensSolverWorkDistributor::ClearTrackedCorners(const FString & calibrationID)
+{
+	LockStreams();
+	trackedCorners.Remove(calibrationID);
+	UnlockStreams();
+}
+
+void LensSolverWorkDistributor::ClearTrackedCorners(const TArray<FString> & calibrationIDs)
+{
+	LockStreams();
+	for (int i = 0; i < calibrationIDs.Num(); i++)
+		trackedCorners.Remove(calibrationIDs[i]);
+	UnlockStreams();
+}
+
+bool LensSolverWorkDistributor::WorkersAvailable()
+{
+	bool available = false;
+	ReadLockWorkers();
+	available = useTaskGraph || (findCornersWorkers.Num() > 0 && calibrateWorkers.Num() > 0);
+	ReadUnlockWorkers();
+	return available;
 }
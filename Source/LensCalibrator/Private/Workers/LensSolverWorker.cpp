@@ -22,6 +22,11 @@
 #include "RenderUtils.h"
 #include "Engine/Texture2D.h"
 #include "WorkerRegistry.h"
+#include "LensCalibratorStats.h"
+
+/* Idle workers block on their work event, this timeout only exists so that workers still 
+observe the global shutdown flag in WorkerRegistry which does not signal individual workers. */
+static const uint32 idleWaitTimeoutMS = 100;
 
 FLensSolverWorker::FLensSolverWorker(FLensSolverWorkerParameters& inputParameters) :
 	workerID(inputParameters.inputWorkerID),
@@ -31,8 +36,21 @@ FLensSolverWorker::FLensSolverWorker(FLensSolverWorkerParameters& inputParameter
 {
 	inputParameters.inputGetWorkOutputLoadDel->BindRaw(this, &FLensSolverWorker::GetWorkLoad);
 	inputParameters.inputIsClosingOutputDel->BindRaw(this, &FLensSolverWorker::Exit);
+	inputParameters.inputGetWorkerStatsOutputDel->BindRaw(this, &FLensSolverWorker::GetWorkerStats);
 
 	flagToExit = false;
+
+	workEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	isWaitingForWork = false;
+	workSignaledCycles = 0;
+	startCycles = 0;
+	workerStats.workerID = workerID;
+}
+
+FLensSolverWorker::~FLensSolverWorker()
+{
+	FPlatformProcess::ReturnSynchEventToPool(workEvent);
+	workEvent = nullptr;
 }
 
 /* Queue log message to main thread so that it can be dequeued and printed to the console on the main thread. */
@@ -62,22 +80,32 @@ void FLensSolverWorker::DoWork()
 {
 	FLensSolverWorker* baseWorker = this;
 
+	Lock();
+	startCycles = FPlatformTime::Cycles64();
+	Unlock();
+
 	/* Keep the thread alive in this while loop until the worker has been flagged to exit. */
 	while (!ShouldExit())
 	{
 		/* Determine if there is any work to do. */
-		if (GetWorkLoad() == 0)
+		if (!IsReadyToTick())
 		{
-			/* Sleep for 1 second to reduce CPU load when this worker is idling. */
-			FPlatformProcess::Sleep(1.0f);
-
-			/* Continue to the next loop if we still don't have work to do. */
-			if (GetWorkLoad() == 0)
-				continue;
+			/* Block until a producer signals us that work has been queued. */
+			WaitForWork();
+			continue;
 		}
 
+		uint64 tickStartCycles = FPlatformTime::Cycles64();
+
 		/* Call the overrided calculation method that implements this class. */
 		baseWorker->Tick();
+
+		float tickTimeMS = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - tickStartCycles);
+
+		Lock();
+		workerStats.processedTickCount++;
+		workerStats.busyTimeMS += tickTimeMS;
+		Unlock();
 	}
 
 	/* Log to main thread that this worker has exited it's loop. */
@@ -87,26 +115,84 @@ void FLensSolverWorker::DoWork()
 	NotifyShutdown();
 }
 
+void FLensSolverWorker::ExitTaskExecutor()
+{
+	Exit();
+	NotifyShutdown();
+}
+
 /* Exit worker loop, reset anything and queue a message log to the main thread that we've exited. */
 bool FLensSolverWorker::Exit()
 {
-	Lock();
 	flagToExit = true;
-	Unlock();
+
+	/* Wake up the worker if it's idling so it can exit it's loop. */
+	workEvent->Trigger();
+
 	if (Debug())
 		QueueLog("Exiting worker.");
 	return true;
 }
 
-/* Check flags from main thread whether this worker should exit it's loop. */
-bool FLensSolverWorker::ShouldExit()
+/* Called by producers after they queue work, the event is auto-reset so if the worker is 
+not waiting yet, the next wait will return immediately and no signal is lost. */
+void FLensSolverWorker::NotifyWork()
+{
+	/* Only the first producer to signal a waiting worker stamps the time. */
+	if (isWaitingForWork.Load())
+	{
+		uint64 expectedCycles = 0;
+		workSignaledCycles.CompareExchange(expectedCycles, FPlatformTime::Cycles64());
+	}
+
+	workEvent->Trigger();
+}
+
+void FLensSolverWorker::WaitForWork()
 {
-	bool shouldExit = false;
+	isWaitingForWork = true;
+
+	workEvent->Wait(idleWaitTimeoutMS);
+
+	isWaitingForWork = false;
+	uint64 signaledCycles = workSignaledCycles.Exchange(0);
+
+	/* We only record wakeups caused by a producer, not the idle timeout. */
+	if (signaledCycles == 0)
+		return;
+
+	float latencyMS = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - signaledCycles);
 
 	Lock();
-	shouldExit = flagToExit;
+	workerStats.wakeupCount++;
+	workerStats.lastWakeupLatencyMS = latencyMS;
+	workerStats.averageWakeupLatencyMS += (latencyMS - workerStats.averageWakeupLatencyMS) / workerStats.wakeupCount;
+	workerStats.maxWakeupLatencyMS = FMath::Max(workerStats.maxWakeupLatencyMS, latencyMS);
 	Unlock();
 
+	SET_FLOAT_STAT(STAT_LensCalibratorWorkerWakeupLatency, latencyMS);
+	INC_DWORD_STAT(STAT_LensCalibratorWorkerWakeups);
+}
+
+FLensSolverWorkerStats FLensSolverWorker::GetWorkerStats()
+{
+	FLensSolverWorkerStats copyOfWorkerStats;
+	Lock();
+	copyOfWorkerStats = workerStats;
+	if (startCycles != 0)
+	{
+		float elapsedMS = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+		copyOfWorkerStats.utilisation = elapsedMS > 0.0f ? copyOfWorkerStats.busyTimeMS / elapsedMS : 0.0f;
+	}
+	Unlock();
+	return copyOfWorkerStats;
+}
+
+/* Check flags from main thread whether this worker should exit it's loop. */
+bool FLensSolverWorker::ShouldExit()
+{
+	bool shouldExit = flagToExit.Load();
+
 	/* Check whether only this worker has been flagged to exit, or whether all workers have been flagged to exit. */
 	return shouldExit || WorkerRegistry::Get().ShouldExitAll();
 }
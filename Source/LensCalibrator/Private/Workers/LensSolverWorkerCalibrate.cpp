@@ -19,17 +19,17 @@
 #include "GenericPlatform/GenericPlatformProcess.h"
 
 #include "WorkerRegistry.h"
+#include "LensCalibratorStats.h"
+#include "LensSolverPipelineLatency.h"
 
 FLensSolverWorkerCalibrate::FLensSolverWorkerCalibrate(
 	FLensSolverWorkerParameters & inputParameters,
-	QueueCalibrateWorkUnitInputDel* inputQueueCalibrateWorkUnitDel,
 	QueueLatchInputDel* inputSignalLatch,
 	QueueCalibrationResultOutputDel* inputOnSolvePointsDel) : 
 	FLensSolverWorker(inputParameters), /* Call base class constructor and pass generic input parameters. */
 	onSolvePointsDel(inputOnSolvePointsDel) /* Initialize class member delegate with input. */
 {
 	/* Bind internal methods to delegates so they can be called from ULensSolverWorkDistributor. */
-	inputQueueCalibrateWorkUnitDel->BindRaw(this, &FLensSolverWorkerCalibrate::QueueWorkUnit);
 	inputSignalLatch->BindRaw(this, &FLensSolverWorkerCalibrate::QueueLatch);
 
 	workUnitCount = 0;
@@ -85,6 +85,20 @@ void FLensSolverWorkerCalibrate::Tick()
 	FCalibrateLatch latchData;
 	DequeueLatch(latchData);
 
+	/* Provisional solves are best effort, skip them when the worker is behind on queued latches. */
+	if (latchData.provisional && LatchInQueue())
+		INC_DWORD_STAT(STAT_LensCalibratorProvisionalSolvesSkipped);
+	else
+		Calibrate(latchData);
+
+	Lock();
+	workUnitCount--;
+	Unlock();
+}
+
+/* Calibrate using the views carried by the latch, this is called from Tick or directly from a task graph task. */
+void FLensSolverWorkerCalibrate::Calibrate(const FCalibrateLatch & latchData)
+{
 	/* Found calibration patterns is put in this float array, this array has x & y coordinates packed into it via: x,y,x,y,x,y,x,y. */
 	TArray<float> corners; 
 
@@ -95,10 +109,15 @@ void FLensSolverWorkerCalibrate::Tick()
 	float chessboardSquareSizeMM;
 
 	/* The number images in the work units. */
-	int imageCount;
+	int imageCount = 0;
+
+	uint32 start = FPlatformTime::Cycles();
+
+	double dequeuedSeconds = FPlatformTime::Seconds();
+	LensSolverPipelineLatency::Get().Record(UPipelineStage::CalibrateQueueWait, latchData.baseParameters.pipelineTimestamps.latched, dequeuedSeconds);
 
-	if (!DequeueAllWorkUnits(
-		latchData.baseParameters.calibrationID, 
+	if (!GatherCorners(
+		latchData,
 		corners, cornerCountX, 
 		cornerCountY, 
 		chessboardSquareSizeMM,
@@ -107,13 +126,17 @@ void FLensSolverWorkerCalibrate::Tick()
 
 	if (corners.Num() == 0)
 	{
+		/* Provisional solves are retried with more views at the next interval. */
+		if (latchData.provisional)
+			return;
+
 		QueueLog("No calibration corners or object points to use in calibration process.");
 		QueueCalibrationResultError(latchData.baseParameters);
 		return;
 	}
 
 	if (Debug())
-		QueueLog(FString::Printf(TEXT("(INFO): Done dequeing work units, preparing calibration using %d sets of points."), corners.Num()));
+		QueueLog(FString::Printf(TEXT("(INFO): Done gathering views, preparing calibration using %d sets of points."), corners.Num()));
 
 	FCalibrateLensParameters parameters; 
 	parameters.sensorDiagonalSizeMM							= latchData.calibrationParameters.sensorDiagonalSizeMM;
@@ -131,6 +154,15 @@ void FLensSolverWorkerCalibrate::Tick()
 	parameters.fixRadialDistortionCoefficientK6				= latchData.calibrationParameters.fixRadialDistortionCoefficientK6;
 	parameters.useRationalModel								= latchData.calibrationParameters.useRationalModel;
 
+	/* Start a provisional solve from the previous provisional solve of this calibration unless initial intrinsics were provided, only 
+	the principal point can be passed to the wrapper as an initial value. The final latch never warm starts, see FCalibrateLatch::warmStart. */
+	if (latchData.warmStart && !latchData.calibrationParameters.useInitialIntrinsicValues)
+	{
+		parameters.useInitialIntrinsicValues					= true;
+		parameters.initialPrincipalPointNativePixelPositionX	= FMath::RoundToInt(latchData.warmStartPrincipalPixelPoint.X);
+		parameters.initialPrincipalPointNativePixelPositionY	= FMath::RoundToInt(latchData.warmStartPrincipalPixelPoint.Y);
+	}
+
 	FCalibrateLensOutput output;
 
 	/* Send data across DLL boundary to be prepared and processed in OpenCV, currently this method will always return true */
@@ -153,24 +185,34 @@ void FLensSolverWorkerCalibrate::Tick()
 		output.focalLengthMM);
 
 	/* Queue result message log to the main thread to be printed to the console. */
-	QueueLog(FString::Printf(TEXT("(INFO): Completed camera calibration at zoom level: %f "
-		"with solve error: %f "
-		"with results: ("
-		"\n\tField of View in degrees: (%f, %f)"
-		"\n\tSensor width in MM: %f,"
-		"\n\tSensor height in MM: %f,"
-		"\n\tFocal Length in MM: %f,"
-		"\n\tPrincipal Point Pixel: (%f, %f),"
-		"\n\tAspect Ratio: %f\n)"),
-		latchData.baseParameters.zoomLevel,
-		output.error,
-		output.fovX,
-		output.fovY,
-		output.sensorSizeMMX,
-		output.sensorSizeMMY,
-		output.focalLengthMM,
-		output.principalPixelPointX, output.principalPixelPointY,
-		output.aspectRatio));
+	if (latchData.provisional)
+		QueueLog(FString::Printf(TEXT("(INFO): Completed provisional camera calibration at zoom level: %f "
+			"using %d images with solve error: %f, focal length in MM: %f, principal point pixel: (%f, %f)."),
+			latchData.baseParameters.zoomLevel,
+			imageCount,
+			output.error,
+			output.focalLengthMM,
+			output.principalPixelPointX, output.principalPixelPointY));
+
+	else
+		QueueLog(FString::Printf(TEXT("(INFO): Completed camera calibration at zoom level: %f "
+			"with solve error: %f "
+			"with results: ("
+			"\n\tField of View in degrees: (%f, %f)"
+			"\n\tSensor width in MM: %f,"
+			"\n\tSensor height in MM: %f,"
+			"\n\tFocal Length in MM: %f,"
+			"\n\tPrincipal Point Pixel: (%f, %f),"
+			"\n\tAspect Ratio: %f\n)"),
+			latchData.baseParameters.zoomLevel,
+			output.error,
+			output.fovX,
+			output.fovY,
+			output.sensorSizeMMX,
+			output.sensorSizeMMY,
+			output.focalLengthMM,
+			output.principalPixelPointX, output.principalPixelPointY,
+			output.aspectRatio));
 
 	/* Store all the relevant data the user may need in this result struct. */
 	FCalibrationResult result;
@@ -194,10 +236,28 @@ void FLensSolverWorkerCalibrate::Tick()
 	result.k5						= output.k5;
 	result.k6						= output.k6;
 	result.imageCount				= imageCount;
+	result.provisional				= latchData.provisional;
+	result.solveTimeMS				= FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - start);
+
+	FPipelineTimestamps & pipelineTimestamps = result.baseParameters.pipelineTimestamps;
+	pipelineTimestamps.dequeued = dequeuedSeconds;
+	pipelineTimestamps.solved = FPlatformTime::Seconds();
+	LensSolverPipelineLatency::Get().Record(UPipelineStage::Solve, pipelineTimestamps.dequeued, pipelineTimestamps.solved);
+
+	if (latchData.provisional)
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorProvisionalSolves);
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorProvisionalSolveTime, result.solveTimeMS);
+	}
 
-	/* Write the calibration results to a JSON file if the parameter is toggled. */
-	if (latchData.calibrationParameters.writeCalibrationResultsToFile)
-		WriteSolvedPointsToJSONFile(result, latchData.calibrationParameters.calibrationResultsOutputPath);
+	else
+	{
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorCalibrationSolveTime, result.solveTimeMS);
+
+		/* Write the calibration results to a JSON file if the parameter is toggled. */
+		if (latchData.calibrationParameters.writeCalibrationResultsToFile)
+			WriteSolvedPointsToJSONFile(result, latchData.calibrationParameters.calibrationResultsOutputPath);
+	}
 
 	if (Debug())
 		QueueLog(FString("(INFO): Finished with work unit."));
@@ -209,74 +269,33 @@ void FLensSolverWorkerCalibrate::Tick()
 	QueueCalibrationResult(result);
 }
 
+/* The number of latches queued or being solved, the work distributor hands each latch to the least loaded worker. */
 int FLensSolverWorkerCalibrate::GetWorkLoad()
 {
 	int count = 0;
 	Lock();
-	count = workQueue.Num();
+	count = workUnitCount;
 	Unlock();
 	return count;
 }
 
-/* Called by the main thread via a delegate registered in this class's constructor. */
-void FLensSolverWorkerCalibrate::QueueWorkUnit(const FLensSolverCalibrationPointsWorkUnit calibrateWorkUnit)
-{
-	Lock();
-	TQueue<FLensSolverCalibrationPointsWorkUnit> ** queuePtr = workQueue.Find(calibrateWorkUnit.baseParameters.calibrationID);
-	if (queuePtr == nullptr)
-	{
-		workQueue.Add(calibrateWorkUnit.baseParameters.calibrationID, new TQueue<FLensSolverCalibrationPointsWorkUnit>());
-		queuePtr = workQueue.Find(calibrateWorkUnit.baseParameters.calibrationID);
-		if (Debug())
-			QueueLog(FString::Printf(TEXT("Registered expected calibration work units with ID: \"%s\""), *calibrateWorkUnit.baseParameters.calibrationID));
-	}
-	Unlock();
-
-	if (Debug())
-		QueueLog(FString::Printf(TEXT("Queued calibration work unit with calibration ID: \"%s\""), *calibrateWorkUnit.baseParameters.calibrationID));
-
-	TQueue<FLensSolverCalibrationPointsWorkUnit>* queue = *queuePtr;
-	queue->Enqueue(calibrateWorkUnit);
-}
-
-bool FLensSolverWorkerCalibrate::DequeueAllWorkUnits(
-	const FString calibrationID, 
+bool FLensSolverWorkerCalibrate::GatherCorners(
+	const FCalibrateLatch & latchData,
 	TArray<float> & corners,
 	int & cornerCountX, int & cornerCountY,
 	float & chessboardSquareSizeMM,
 	int & imageCount) 
 {
-	Lock();
-	TQueue<FLensSolverCalibrationPointsWorkUnit> ** queuePtr = workQueue.Find(calibrationID);
-	if (queuePtr == nullptr)
-	{
-		if (Debug())
-			QueueLog(FString::Printf(TEXT("(ERROR): No work units in calibration queue with ID: \"%s\"."), *calibrationID));
-		Unlock();
-		return false;
-	}
+	const FString & calibrationID = latchData.baseParameters.calibrationID;
+	const TArray<FLensSolverCalibrationViewPtr> & views = latchData.views;
 
-	TQueue<FLensSolverCalibrationPointsWorkUnit>* queue = *queuePtr; 
-
-	bool isQueued = queue->IsEmpty() == false;
 	cornerCountX = -1, cornerCountY = -1;
 	chessboardSquareSizeMM = -1;
 
-	while (isQueued)
+	/* The views only contain images with a detected calibration pattern, these are only added to the corners once the views to solve with are picked. */
+	for (int i = 0; i < views.Num(); i++)
 	{
-		FLensSolverCalibrationPointsWorkUnit calibrateWorkUnit;
-		queue->Dequeue(calibrateWorkUnit);
-		isQueued = queue->IsEmpty() == false;
-		workUnitCount--;
-
-		if (calibrateWorkUnit.calibrationPointParameters.corners.Num() == 0)
-		{
-			if (Debug())
-				QueueLog(FString::Printf(TEXT("(WARNING): No detected calibration pattern corners in image: \"%s\" for calibration: \"%s\", skipping and continuing to next image."),
-					*calibrateWorkUnit.baseParameters.friendlyName,
-					*calibrateWorkUnit.baseParameters.calibrationID));
-			continue;
-		}
+		const FLensSolverCalibrationPointsWorkUnit & calibrateWorkUnit = *views[i];
 
 		if (cornerCountX == -1 || cornerCountY == -1)
 		{
@@ -287,12 +306,12 @@ bool FLensSolverWorkerCalibrate::DequeueAllWorkUnits(
 		else if (cornerCountX != calibrateWorkUnit.calibrationPointParameters.cornerCountX || cornerCountY != calibrateWorkUnit.calibrationPointParameters.cornerCountY)
 		{
 			if (Debug())
-				QueueLog(FString::Printf(TEXT("(ERROR): Detected different chessboard corner count of: (%i, %i) instead of (%i, %i) in calibration queue: \"%s\". Something is broken."),
+				QueueLog(FString::Printf(TEXT("(ERROR): Detected different chessboard corner count of: (%i, %i) instead of (%i, %i) in calibration: \"%s\". Something is broken."),
 					calibrateWorkUnit.calibrationPointParameters.cornerCountX,
 					calibrateWorkUnit.calibrationPointParameters.cornerCountY,
 					cornerCountX,
 					cornerCountY,
-					*calibrateWorkUnit.baseParameters.calibrationID));
+					*calibrationID));
 			return false;
 		}
 
@@ -301,29 +320,45 @@ bool FLensSolverWorkerCalibrate::DequeueAllWorkUnits(
 		else if (chessboardSquareSizeMM != calibrateWorkUnit.calibrationPointParameters.chessboardSquareSizeMM)
 		{
 			if (Debug())
-				QueueLog(FString::Printf(TEXT("(ERROR): Detected different chessboard square size of: %d instead of %d in calibration queue: \"%s\". Something is broken."),
+				QueueLog(FString::Printf(TEXT("(ERROR): Detected different chessboard square size of: %d instead of %d in calibration: \"%s\". Something is broken."),
 					calibrateWorkUnit.calibrationPointParameters.chessboardSquareSizeMM,
 					chessboardSquareSizeMM,
-					*calibrateWorkUnit.baseParameters.calibrationID));
+					*calibrationID));
 			return false;
 		}
+	}
 
-		corners.Append(calibrateWorkUnit.calibrationPointParameters.corners);
-		imageCount++;
+	int maxViewCount = latchData.calibrationParameters.maxCalibrationViewCount;
+	TArray<int> selectedViews;
+	if (maxViewCount > 0 && views.Num() > maxViewCount)
+	{
+		uint32 selectionStartCycles = FPlatformTime::Cycles();
+		SelectDiverseViews(views, cornerCountX, cornerCountY, maxViewCount, selectedViews);
+		INC_FLOAT_STAT_BY(STAT_LensCalibratorViewSelectionTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - selectionStartCycles));
+		INC_DWORD_STAT_BY(STAT_LensCalibratorViewsDiscarded, views.Num() - selectedViews.Num());
+
+		QueueLog(FString::Printf(TEXT("(INFO): Picked the %d most diverse of %d views for calibration: \"%s\"."),
+			selectedViews.Num(),
+			views.Num(),
+			*calibrationID));
+	}
 
-		if (Debug())
-			QueueLog(FString::Printf(TEXT("(INFO): Dequeued %d corner points image: \"%s\" for calibration: \"%s\"."),
-				calibrateWorkUnit.calibrationPointParameters.corners.Num(),
-				*calibrateWorkUnit.baseParameters.friendlyName,
-				*calibrateWorkUnit.baseParameters.calibrationID));
+	else
+	{
+		for (int i = 0; i < views.Num(); i++)
+			selectedViews.Add(i);
 	}
 
-	delete queue;
-	workQueue.Remove(calibrationID);
-	Unlock();
+	INC_DWORD_STAT_BY(STAT_LensCalibratorViewsSelected, selectedViews.Num());
+
+	for (int i = 0; i < selectedViews.Num(); i++)
+	{
+		corners.Append(views[selectedViews[i]]->calibrationPointParameters.corners);
+		imageCount++;
+	}
 
 	if (Debug())
-		QueueLog(FString::Printf(TEXT("(INFO): Dequeued %d images corner sets each of size: (%i, %i) for calibration: \"%s\"."),
+		QueueLog(FString::Printf(TEXT("(INFO): Gathered %d images corner sets each of size: (%i, %i) for calibration: \"%s\"."),
 			imageCount,
 			cornerCountX,
 			cornerCountY,
@@ -332,6 +367,126 @@ bool FLensSolverWorkerCalibrate::DequeueAllWorkUnits(
 	return true;
 }
 
+TArray<float> FLensSolverWorkerCalibrate::DescribeView(
+	const FLensSolverCalibrationPointsWorkUnit & calibrateWorkUnit,
+	int cornerCountX,
+	int cornerCountY)
+{
+	const TArray<float> & corners = calibrateWorkUnit.calibrationPointParameters.corners;
+
+	TArray<float> descriptor;
+	if (cornerCountX <= 0 || cornerCountY <= 0 || corners.Num() < cornerCountX * cornerCountY * 2)
+	{
+		descriptor.Init(0.0f, 7);
+		return descriptor;
+	}
+
+	/* Normalize by the image size so views from images of different sizes are comparable. */
+	float width = FMath::Max(calibrateWorkUnit.resizeParameters.resizeX, 1);
+	float height = FMath::Max(calibrateWorkUnit.resizeParameters.resizeY, 1);
+
+	auto corner = [&corners, width, height](int i)
+	{
+		return FVector2D(corners[i * 2] / width, corners[i * 2 + 1] / height);
+	};
+
+	FVector2D centroid = FVector2D::ZeroVector;
+	int cornerCount = corners.Num() / 2;
+	for (int i = 0; i < cornerCount; i++)
+		centroid += corner(i);
+	centroid /= FMath::Max(cornerCount, 1);
+
+	/* The outer corners of the pattern. */
+	FVector2D topLeft = corner(0);
+	FVector2D topRight = corner(cornerCountX - 1);
+	FVector2D bottomLeft = corner((cornerCountY - 1) * cornerCountX);
+	FVector2D bottomRight = corner(cornerCountY * cornerCountX - 1);
+
+	/* Size of the pattern in the image from the area of it's outline. */
+	float area = 0.5f * FMath::Abs(
+		FVector2D::CrossProduct(topRight - topLeft, bottomRight - topLeft) + 
+		FVector2D::CrossProduct(bottomRight - topLeft, bottomLeft - topLeft));
+
+	/* Perspective foreshortens the far side of a tilted pattern, so the ratio of opposite sides describes the tilt. */
+	float top = FMath::Max(FVector2D::Distance(topLeft, topRight), KINDA_SMALL_NUMBER);
+	float bottom = FMath::Max(FVector2D::Distance(bottomLeft, bottomRight), KINDA_SMALL_NUMBER);
+	float left = FMath::Max(FVector2D::Distance(topLeft, bottomLeft), KINDA_SMALL_NUMBER);
+	float right = FMath::Max(FVector2D::Distance(topRight, bottomRight), KINDA_SMALL_NUMBER);
+
+	/* In plane rotation, doubled since the corner ordering can start from either end of the pattern. */
+	FVector2D rowDirection = topRight - topLeft;
+	float angle = 2.0f * FMath::Atan2(rowDirection.Y, rowDirection.X);
+
+	descriptor.Add(centroid.X);
+	descriptor.Add(centroid.Y);
+	descriptor.Add(FMath::Sqrt(area));
+	descriptor.Add(0.5f * FMath::Loge(top / bottom));
+	descriptor.Add(0.5f * FMath::Loge(left / right));
+	descriptor.Add(0.25f * FMath::Cos(angle));
+	descriptor.Add(0.25f * FMath::Sin(angle));
+	return descriptor;
+}
+
+void FLensSolverWorkerCalibrate::SelectDiverseViews(
+	const TArray<FLensSolverCalibrationViewPtr> & views,
+	int cornerCountX,
+	int cornerCountY,
+	int maxViewCount,
+	TArray<int> & outputSelectedViews)
+{
+	TArray<TArray<float>> descriptors;
+	descriptors.SetNum(views.Num());
+	for (int i = 0; i < views.Num(); i++)
+		descriptors[i] = DescribeView(*views[i], cornerCountX, cornerCountY);
+
+	auto distanceSquared = [&descriptors](int a, int b)
+	{
+		float sum = 0.0f;
+		for (int i = 0; i < descriptors[a].Num(); i++)
+			sum += FMath::Square(descriptors[a][i] - descriptors[b][i]);
+		return sum;
+	};
+
+	/* Start with the view where the pattern covers the most of the image. */
+	int first = 0;
+	for (int i = 1; i < views.Num(); i++)
+		if (descriptors[i][2] > descriptors[first][2])
+			first = i;
+
+	/* Distance from each view to the closest view picked so far. */
+	TArray<float> closestDistances;
+	closestDistances.Init(MAX_flt, views.Num());
+
+	TArray<bool> selected;
+	selected.Init(false, views.Num());
+
+	int next = first;
+	while (outputSelectedViews.Num() < maxViewCount)
+	{
+		selected[next] = true;
+		outputSelectedViews.Add(next);
+
+		int farthest = -1;
+		for (int i = 0; i < views.Num(); i++)
+		{
+			if (selected[i])
+				continue;
+
+			closestDistances[i] = FMath::Min(closestDistances[i], distanceSquared(i, next));
+			if (farthest == -1 || closestDistances[i] > closestDistances[farthest])
+				farthest = i;
+		}
+
+		if (farthest == -1)
+			break;
+
+		next = farthest;
+	}
+
+	/* Keep the views in the order they were captured. */
+	outputSelectedViews.Sort();
+}
+
 void FLensSolverWorkerCalibrate::WriteSolvedPointsToJSONFile(const FCalibrationResult& solvePoints, FString outputPath)
 {
 	if (!LensSolverUtilities::ValidateFilePath(outputPath, calibrationVisualizationOutputPath, "CalibrationResults", "json"))
@@ -417,7 +572,13 @@ void FLensSolverWorkerCalibrate::QueueCalibrationResult(FCalibrationResult solve
 
 void FLensSolverWorkerCalibrate::QueueLatch(const FCalibrateLatch latchData)
 {
+	Lock();
+	workUnitCount++;
+	Unlock();
+
 	latchQueue.Enqueue(latchData);
+	NotifyWork();
+
 	if (Debug())
 		QueueLog(FString::Printf(TEXT("(INFO): %s: Queued calibrate latch."), *JobDataToString(latchData.baseParameters)));
 }
@@ -434,6 +595,12 @@ bool FLensSolverWorkerCalibrate::LatchInQueue()
 	return latchQueue.IsEmpty() == false;
 }
 
+/* We only have something to do once a latch is queued, otherwise we would spin while work units trickle in. */
+bool FLensSolverWorkerCalibrate::IsReadyToTick()
+{
+	return LatchInQueue();
+}
+
 void FLensSolverWorkerCalibrate::NotifyShutdown()
 {
 	WorkerRegistry::Get().UncountCalibrateWorker();
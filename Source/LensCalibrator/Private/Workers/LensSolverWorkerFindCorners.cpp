@@ -20,17 +20,37 @@
 #include "OpenCVWrapper.h"
 
 #include "WorkerRegistry.h"
+#include "LensSolverWorkDistributor.h"
+#include "LensSolverUtilities.h"
+#include "LensSolverCornerRefinement.h"
+#include "LensSolverBoardPrefilter.h"
+#include "LensCalibratorStats.h"
+#include "LensSolverPipelineLatency.h"
+
+/* The maximum number of work units of each type that can be queued to a single worker. */
+static const uint32 workQueueCapacity = 1024;
+
+/* Corners are tracked within at most this many pixels of where they were in the previous snapshot. */
+static const int maxTrackingWindowRadius = 16;
 
 FLensSolverWorkerFindCorners::FLensSolverWorkerFindCorners(
 	FLensSolverWorkerParameters & inputParameters,
 	QueueTextureFileWorkUnitInputDel* inputQueueTextureFileWorkUnitInputDel,
 	QueuePixelArrayWorkUnitInputDel* inputQueuePixelArrayWorkUnitInputDel,
-	QueueFindCornerResultOutputDel* inputQueueFindCornerResultOutputDel) :
+	StealTextureFileWorkUnitInputDel* inputStealTextureFileWorkUnitInputDel,
+	StealPixelArrayWorkUnitInputDel* inputStealPixelArrayWorkUnitInputDel,
+	QueueFindCornerResultOutputDel* inputQueueFindCornerResultOutputDel,
+	StealFindCornersWorkUnitOutputDel* inputStealFindCornersWorkUnitOutputDel) :
 	FLensSolverWorker(inputParameters),
-	queueFindCornerResultOutputDel(inputQueueFindCornerResultOutputDel)
+	pixelArrayWorkQueue(workQueueCapacity),
+	textureFileWorkQueue(workQueueCapacity),
+	queueFindCornerResultOutputDel(inputQueueFindCornerResultOutputDel),
+	stealFindCornersWorkUnitOutputDel(inputStealFindCornersWorkUnitOutputDel)
 {
 	inputQueueTextureFileWorkUnitInputDel->BindRaw(this, &FLensSolverWorkerFindCorners::QueueTextureFileWorkUnit);
 	inputQueuePixelArrayWorkUnitInputDel->BindRaw(this, &FLensSolverWorkerFindCorners::QueuePixelArrayWorkUnit);
+	inputStealTextureFileWorkUnitInputDel->BindRaw(this, &FLensSolverWorkerFindCorners::StealTextureFileWorkUnit);
+	inputStealPixelArrayWorkUnitInputDel->BindRaw(this, &FLensSolverWorkerFindCorners::StealPixelArrayWorkUnit);
 
 	workUnitCount = 0;
 	WorkerRegistry::Get().CountFindCornerWorker();
@@ -38,138 +58,270 @@ FLensSolverWorkerFindCorners::FLensSolverWorkerFindCorners(
 
 int FLensSolverWorkerFindCorners::GetWorkLoad()
 {
-	int count = 0;
-	Lock();
-	count = workUnitCount;
-	Unlock();
-
-	return count;
+	return workUnitCount.Load();
 }
 
-void FLensSolverWorkerFindCorners::QueueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit workUnit)
+bool FLensSolverWorkerFindCorners::QueueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit workUnit)
 {
-	textureFileWorkQueue.Enqueue(workUnit);
-	Lock();
-	workUnitCount++;
-	Unlock();
+	/* Count before enqueuing so the work load never under reports what a consumer can dequeue. */
+	int count = ++workUnitCount;
+
+	const FString absoluteFilePath = Debug() ? workUnit.textureFileParameters.absoluteFilePath : FString();
+	const FBaseParameters baseParameters = workUnit.baseParameters;
+
+	if (!textureFileWorkQueue.Enqueue(MoveTemp(workUnit)))
+	{
+		--workUnitCount;
+		QueueLog(FString::Printf(TEXT("(ERROR): %s: Unable to queue TextureFileWorkUnit, the work queue is full."), *JobDataToString(baseParameters)));
+		return false;
+	}
+
+	NotifyWork();
 
 	if (Debug())
 		QueueLog(FString::Printf(TEXT("(INFO): %s: Queued TextureFileWorkUnit with path: \"%s\", total currently queued: %d."),
-		*JobDataToString(workUnit.baseParameters),
-		*workUnit.textureFileParameters.absoluteFilePath,
-		workUnitCount));
+		*JobDataToString(baseParameters),
+		*absoluteFilePath,
+		count));
+
+	return true;
 }
 
-void FLensSolverWorkerFindCorners::QueuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit workUnit)
+bool FLensSolverWorkerFindCorners::QueuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit workUnit)
 {
-	pixelArrayWorkQueue.Enqueue(workUnit);
-	Lock();
-	workUnitCount++;
-	Unlock();
+	int count = ++workUnitCount;
+
+	const FBaseParameters baseParameters = workUnit.baseParameters;
+	const FResizeParameters resizeParameters = workUnit.resizeParameters;
+
+	if (!pixelArrayWorkQueue.Enqueue(MoveTemp(workUnit)))
+	{
+		--workUnitCount;
+		QueueLog(FString::Printf(TEXT("(ERROR): %s: Unable to queue PixelArrayWorkUnit, the work queue is full."), *JobDataToString(baseParameters)));
+		return false;
+	}
+
+	NotifyWork();
 
 	if (Debug())
 		QueueLog(FString::Printf(TEXT("(INFO): %s: Queued PixelArrayWorkUnit of resolution: (%d, %d), total currently queued: %d."),
-		*JobDataToString(workUnit.baseParameters),
-		workUnit.resizeParameters.sourceX,
-		workUnit.resizeParameters.sourceY,
-		workUnitCount));
+		*JobDataToString(baseParameters),
+		resizeParameters.sourceX,
+		resizeParameters.sourceY,
+		count));
+
+	return true;
 }
 
-void FLensSolverWorkerFindCorners::DequeueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit)
+bool FLensSolverWorkerFindCorners::DequeueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit)
 {
-	textureFileWorkQueue.Dequeue(workUnit);
-	Lock();
-	workUnitCount--;
-	Unlock();
+	/* A peer may have stolen the work unit since we last checked. */
+	if (!textureFileWorkQueue.Dequeue(workUnit))
+		return false;
+
+	--workUnitCount;
+
+	INC_DWORD_STAT(STAT_LensCalibratorFindCornersWorkUnitsProcessed);
 
 	if (Debug())
 		QueueLog(FString::Printf(TEXT("(INFO): %s: Dequeued TextureFileWorkUnit with path: \"%s\"."),
 		*JobDataToString(workUnit.baseParameters),
 		*workUnit.textureFileParameters.absoluteFilePath));
+
+	return true;
 }
 
-void FLensSolverWorkerFindCorners::DequeuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & workUnit)
+bool FLensSolverWorkerFindCorners::DequeuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & workUnit)
 {
-	pixelArrayWorkQueue.Dequeue(workUnit);
-	Lock();
-	workUnitCount--;
-	Unlock();
+	if (!pixelArrayWorkQueue.Dequeue(workUnit))
+		return false;
+
+	--workUnitCount;
+
+	INC_DWORD_STAT(STAT_LensCalibratorFindCornersWorkUnitsProcessed);
 
 	if (Debug())
 		QueueLog(FString::Printf(TEXT("(INFO): %s: Dequeued PixelArrayWorkUnit of resolution: (%d, %d)."),
 		*JobDataToString(workUnit.baseParameters),
 		workUnit.resizeParameters.sourceX,
 		workUnit.resizeParameters.sourceY));
+
+	return true;
+}
+
+/* The work queues support multiple consumers, so peers steal the oldest work unit from the same end this worker dequeues from. */
+bool FLensSolverWorkerFindCorners::StealTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit)
+{
+	if (!textureFileWorkQueue.Dequeue(workUnit))
+		return false;
+
+	--workUnitCount;
+
+	Lock();
+	workerStats.lostWorkUnitCount++;
+	Unlock();
+
+	return true;
+}
+
+bool FLensSolverWorkerFindCorners::StealPixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit& workUnit)
+{
+	if (!pixelArrayWorkQueue.Dequeue(workUnit))
+		return false;
+
+	--workUnitCount;
+
+	Lock();
+	workerStats.lostWorkUnitCount++;
+	Unlock();
+
+	return true;
+}
+
+bool FLensSolverWorkerFindCorners::StealWorkUnitFromPeer()
+{
+	if (stealFindCornersWorkUnitOutputDel == nullptr || !stealFindCornersWorkUnitOutputDel->IsBound())
+		return false;
+
+	/* The work distributor queues the stolen work unit directly into this worker. */
+	if (!stealFindCornersWorkUnitOutputDel->Execute(GetWorkerID()))
+		return false;
+
+	Lock();
+	workerStats.stolenWorkUnitCount++;
+	Unlock();
+
+	INC_DWORD_STAT(STAT_LensCalibratorWorkUnitsStolen);
+	return true;
+}
+
+/* When our own queues are empty, try to take the oldest work unit from a busier peer before going idle. */
+bool FLensSolverWorkerFindCorners::IsReadyToTick()
+{
+	if (GetWorkLoad() > 0)
+		return true;
+
+	return StealWorkUnitFromPeer() && GetWorkLoad() > 0;
 }
 
 void FLensSolverWorkerFindCorners::Tick()
 {
-	FBaseParameters baseParameters;
+	FLensSolverTextureFileWorkUnit textureFileWorkUnit;
+	FLensSolverPixelArrayWorkUnit texturePixelArrayUnit;
+
+	if (DequeueTextureFileWorkUnit(textureFileWorkUnit))
+		ProcessTextureFileWorkUnit(textureFileWorkUnit);
+
+	else if (DequeuePixelArrayWorkUnit(texturePixelArrayUnit))
+		ProcessPixelArrayWorkUnit(texturePixelArrayUnit);
+}
+
+/* Find the calibration pattern corners in a texture file, this is called from Tick or directly from a task graph task. */
+void FLensSolverWorkerFindCorners::ProcessTextureFileWorkUnit(FLensSolverTextureFileWorkUnit & textureFileWorkUnit)
+{
+	textureFileWorkUnit.baseParameters.pipelineTimestamps.dequeued = FPlatformTime::Seconds();
+
+	FResizeParameters resizeParameters;
+	resizeParameters.nativeX = textureFileWorkUnit.textureSearchParameters.nativeFullResolutionX;
+	resizeParameters.nativeY = textureFileWorkUnit.textureSearchParameters.nativeFullResolutionY;
+
+	FChessboardSearchParameters textureSearchParameters = textureFileWorkUnit.textureSearchParameters;
+
+	TArray<float> corners;
+	corners.SetNum(textureSearchParameters.checkerBoardCornerCountX * textureSearchParameters.checkerBoardCornerCountY * 2);
+
+	DeclareCharArrayFromFString(absoluteFilePath, textureFileWorkUnit.textureFileParameters.absoluteFilePath);
+
+	uint32 detectionStartCycles = FPlatformTime::Cycles();
+	bool found = GetOpenCVWrapper().ProcessImageFromFile(
+		resizeParameters,
+		textureSearchParameters,
+		absoluteFilePath,
+		corners.GetData(),
+		Debug());
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerDetectionTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - detectionStartCycles));
+	INC_DWORD_STAT(STAT_LensCalibratorCornerDetections);
+
+	if (!found)
+	{
+		QueueEmptyCalibrationPointsWorkUnit(textureFileWorkUnit.baseParameters, resizeParameters);
+		return;
+	}
+
+	QueueFoundCorners(textureFileWorkUnit.baseParameters, textureSearchParameters, resizeParameters, corners);
+}
+
+/* Find the calibration pattern corners in an array of pixels, this is called from Tick or directly from a task graph task. */
+void FLensSolverWorkerFindCorners::ProcessPixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit)
+{
+	texturePixelArrayUnit.baseParameters.pipelineTimestamps.dequeued = FPlatformTime::Seconds();
+
+	FChessboardSearchParameters textureSearchParameters = texturePixelArrayUnit.textureSearchParameters;
+	const FCornerSearchParameters & cornerSearchParameters = texturePixelArrayUnit.cornerSearchParameters;
+
 	FResizeParameters resizeParameters;
-	FChessboardSearchParameters textureSearchParameters;
+	resizeParameters			= CalculateResizeParameters(textureSearchParameters);
+	resizeParameters.sourceX	= texturePixelArrayUnit.resizeParameters.sourceX;
+	resizeParameters.sourceY	= texturePixelArrayUnit.resizeParameters.sourceY;
+	resizeParameters.resizeX	= texturePixelArrayUnit.resizeParameters.resizeX;
+	resizeParameters.resizeY	= texturePixelArrayUnit.resizeParameters.resizeY;
 
 	TArray<float> corners;
+	corners.SetNum(textureSearchParameters.checkerBoardCornerCountX * textureSearchParameters.checkerBoardCornerCountY * 2);
 
-	if (!textureFileWorkQueue.IsEmpty())
+	if (!texturePixelArrayUnit.pixelArrayParameters.pixels.IsValid())
 	{
-		FLensSolverTextureFileWorkUnit textureFileWorkUnit;
-
-		DequeueTextureFileWorkUnit(textureFileWorkUnit);
-		baseParameters				= textureFileWorkUnit.baseParameters;
-		textureSearchParameters		= textureFileWorkUnit.textureSearchParameters;
-		resizeParameters.nativeX	= textureFileWorkUnit.textureSearchParameters.nativeFullResolutionX;
-		resizeParameters.nativeY	= textureFileWorkUnit.textureSearchParameters.nativeFullResolutionY;
-
-		corners.SetNum(textureSearchParameters.checkerBoardCornerCountX * textureSearchParameters.checkerBoardCornerCountY * 2);
-
-		DeclareCharArrayFromFString(absoluteFilePath, textureFileWorkUnit.textureFileParameters.absoluteFilePath);
-
-		if (!GetOpenCVWrapper().ProcessImageFromFile(
-			resizeParameters,
-			textureFileWorkUnit.textureSearchParameters,
-			absoluteFilePath,
-			corners.GetData(),
-			Debug()))
-		{
-			QueueEmptyCalibrationPointsWorkUnit(baseParameters, resizeParameters);
-			return;
-		}
+		QueueLog(FString::Printf(TEXT("(ERROR): %s: PixelArrayWorkUnit has no pixel buffer."), *JobDataToString(texturePixelArrayUnit.baseParameters)));
+		QueueEmptyCalibrationPointsWorkUnit(texturePixelArrayUnit.baseParameters, resizeParameters);
+		return;
 	}
 
-	else if (!pixelArrayWorkQueue.IsEmpty())
+	/* Follow the corners found in the previous snapshot before searching the whole image. */
+	if (cornerSearchParameters.trackCorners && TrackCorners(texturePixelArrayUnit, resizeParameters, corners))
 	{
-		FLensSolverPixelArrayWorkUnit texturePixelArrayUnit;
-		DequeuePixelArrayWorkUnit(texturePixelArrayUnit);
-
-		baseParameters				= texturePixelArrayUnit.baseParameters;
-		textureSearchParameters		= texturePixelArrayUnit.textureSearchParameters;
-		resizeParameters			= CalculateResizeParameters(textureSearchParameters);
-		resizeParameters.resizeX	= texturePixelArrayUnit.resizeParameters.resizeX;
-		resizeParameters.resizeY	= texturePixelArrayUnit.resizeParameters.resizeY;
-
-		corners.SetNum(textureSearchParameters.checkerBoardCornerCountX * textureSearchParameters.checkerBoardCornerCountY * 2);
-
-		uint8_t * pixelData = reinterpret_cast<uint8_t*>(texturePixelArrayUnit.pixelArrayParameters.pixels.GetData());
-		float * cornersData = corners.GetData();
-		bool debug = Debug();
-
-		if (!GetOpenCVWrapper().ProcessImageFromPixels(
-			resizeParameters,
-			texturePixelArrayUnit.textureSearchParameters,
-			pixelData,
-			4,
-			resizeParameters.resizeX,
-			resizeParameters.resizeY,
-			cornersData,
-			debug))
-		{
-			QueueEmptyCalibrationPointsWorkUnit(baseParameters, resizeParameters);
-			return;
-		}
+		texturePixelArrayUnit.pixelArrayParameters.pixels.Reset();
+		QueueFoundCorners(texturePixelArrayUnit.baseParameters, textureSearchParameters, resizeParameters, corners);
+		return;
 	}
 
-	else return;
+	bool found = false;
+
+	/* Images the prefilter rejects are treated as if the search found nothing. */
+	if (cornerSearchParameters.prefilter && !PassesPrefilter(texturePixelArrayUnit, resizeParameters))
+		found = false;
 
+	else if (cornerSearchParameters.coarseToFine)
+		found = FindCornersCoarseToFine(texturePixelArrayUnit, resizeParameters, corners);
+
+	else
+		found = FindCorners(texturePixelArrayUnit, resizeParameters, corners);
+
+	/* Release the pixels as soon as we're done with them rather than when the work unit goes out of scope. */
+	texturePixelArrayUnit.pixelArrayParameters.pixels.Reset();
+
+	/* A full detection restarts tracking from it's corners, or stops tracking until the board is found again. */
+	if (cornerSearchParameters.trackCorners)
+	{
+		if (found)
+			LensSolverWorkDistributor::GetInstance().SetTrackedCorners(texturePixelArrayUnit.baseParameters.calibrationID, resizeParameters.resizeX, resizeParameters.resizeY, corners, false);
+		else LensSolverWorkDistributor::GetInstance().ClearTrackedCorners(texturePixelArrayUnit.baseParameters.calibrationID);
+	}
+
+	if (!found)
+	{
+		QueueEmptyCalibrationPointsWorkUnit(texturePixelArrayUnit.baseParameters, resizeParameters);
+		return;
+	}
+
+	QueueFoundCorners(texturePixelArrayUnit.baseParameters, textureSearchParameters, resizeParameters, corners);
+}
+
+void FLensSolverWorkerFindCorners::QueueFoundCorners(
+	const FBaseParameters & baseParameters,
+	const FChessboardSearchParameters & textureSearchParameters,
+	const FResizeParameters & resizeParameters,
+	const TArray<float> & corners)
+{
 	FLensSolverCalibrationPointsWorkUnit calibrationPointsWorkUnit;
 
 	calibrationPointsWorkUnit.baseParameters										= baseParameters;
@@ -210,6 +362,246 @@ void FLensSolverWorkerFindCorners::QueueEmptyCalibrationPointsWorkUnit(const FBa
 	queueFindCornerResultOutputDel->Execute(calibrationPointsWorkUnit);
 }
 
+bool FLensSolverWorkerFindCorners::FindCorners(
+	FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+	const FResizeParameters & resizeParameters,
+	TArray<float> & corners)
+{
+	uint8_t * pixelData = reinterpret_cast<uint8_t*>(texturePixelArrayUnit.pixelArrayParameters.pixels->GetData());
+	float * cornersData = corners.GetData();
+	bool debug = Debug();
+
+	uint32 detectionStartCycles = FPlatformTime::Cycles();
+	bool found = GetOpenCVWrapper().ProcessImageFromPixels(
+		resizeParameters,
+		texturePixelArrayUnit.textureSearchParameters,
+		pixelData,
+		texturePixelArrayUnit.pixelArrayParameters.stride,
+		resizeParameters.resizeX,
+		resizeParameters.resizeY,
+		cornersData,
+		debug);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerDetectionTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - detectionStartCycles));
+	INC_DWORD_STAT(STAT_LensCalibratorCornerDetections);
+
+	return found;
+}
+
+bool FLensSolverWorkerFindCorners::FindCornersCoarseToFine(
+	FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+	const FResizeParameters & resizeParameters,
+	TArray<float> & corners)
+{
+	const FChessboardSearchParameters & textureSearchParameters = texturePixelArrayUnit.textureSearchParameters;
+	const FCornerSearchParameters & cornerSearchParameters = texturePixelArrayUnit.cornerSearchParameters;
+
+	const int width = resizeParameters.resizeX;
+	const int height = resizeParameters.resizeY;
+
+	FLensSolverPixelBufferPtr grayscalePixels = GetGrayscalePixels(texturePixelArrayUnit, width, height);
+	if (!grayscalePixels.IsValid())
+		return false;
+
+	const float coarseSearchPercentage = FMath::Clamp(cornerSearchParameters.coarseSearchPercentage, 0.01f, 1.0f);
+	const int coarseWidth = FMath::Max(FMath::FloorToInt(width * coarseSearchPercentage), 1);
+	const int coarseHeight = FMath::Max(FMath::FloorToInt(height * coarseSearchPercentage), 1);
+
+	FLensSolverPixelBufferPtr coarsePixels = LensSolverWorkDistributor::GetInstance().AcquirePixelBuffer(coarseWidth * coarseHeight);
+	LensSolverUtilities::DownsampleGrayscale(grayscalePixels->GetData(), width, height, coarsePixels->GetData(), coarseWidth, coarseHeight);
+
+	FResizeParameters coarseResizeParameters = resizeParameters;
+	coarseResizeParameters.resizeX = coarseWidth;
+	coarseResizeParameters.resizeY = coarseHeight;
+
+	INC_DWORD_STAT(STAT_LensCalibratorCoarseToFineSearches);
+
+	uint32 detectionStartCycles = FPlatformTime::Cycles();
+	bool found = GetOpenCVWrapper().ProcessImageFromPixels(
+		coarseResizeParameters,
+		textureSearchParameters,
+		reinterpret_cast<uint8_t*>(coarsePixels->GetData()),
+		1,
+		coarseWidth,
+		coarseHeight,
+		corners.GetData(),
+		Debug());
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerDetectionTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - detectionStartCycles));
+	INC_DWORD_STAT(STAT_LensCalibratorCornerDetections);
+
+	coarsePixels.Reset();
+
+	if (!found)
+		return false;
+
+	/* Scale the estimates up to the full resolution image, corner positions are relative to pixel centers. */
+	const float scaleX = width / (float)coarseWidth;
+	const float scaleY = height / (float)coarseHeight;
+	const int cornerCount = corners.Num() / 2;
+
+	for (int i = 0; i < cornerCount; i++)
+	{
+		corners[i * 2] = (corners[i * 2] + 0.5f) * scaleX - 0.5f;
+		corners[i * 2 + 1] = (corners[i * 2 + 1] + 0.5f) * scaleY - 0.5f;
+	}
+
+	/* The window has to cover the error of the upscaled estimates without reaching the neighbouring corners. */
+	int windowRadius = cornerSearchParameters.windowRadius > 0 ? cornerSearchParameters.windowRadius : FMath::Max(FMath::CeilToInt(2.0f * FMath::Max(scaleX, scaleY)), 3);
+	windowRadius = FMath::Min(windowRadius, LensSolverCornerRefinement::MaxWindowRadius(corners.GetData(), textureSearchParameters.checkerBoardCornerCountX, textureSearchParameters.checkerBoardCornerCountY));
+
+	uint32 refinementStartCycles = FPlatformTime::Cycles();
+	int refinedCount = LensSolverCornerRefinement::RefineCorners(grayscalePixels->GetData(), width, height, corners.GetData(), cornerCount, windowRadius);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerRefinementTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - refinementStartCycles));
+	INC_DWORD_STAT_BY(STAT_LensCalibratorCornersRefined, refinedCount);
+	INC_DWORD_STAT_BY(STAT_LensCalibratorCornersNotRefined, cornerCount - refinedCount);
+
+	if (Debug())
+		QueueLog(FString::Printf(TEXT("(INFO): %s: Refined %d/%d corners found at: (%d, %d) in a window of radius: %d at: (%d, %d)."),
+			*JobDataToString(texturePixelArrayUnit.baseParameters),
+			refinedCount,
+			cornerCount,
+			coarseWidth,
+			coarseHeight,
+			windowRadius,
+			width,
+			height));
+
+	/* Like a lost track, corners that didn't converge still hold their upscaled coarse estimate, so 
+	rather than mixing them with refined corners the whole image is searched at full resolution. */
+	if (refinedCount < cornerCount)
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorCoarseToFineFallbacks);
+
+		if (Debug())
+			QueueLog(FString::Printf(TEXT("(INFO): %s: Only %d/%d corners refined, falling back to full resolution detection."),
+				*JobDataToString(texturePixelArrayUnit.baseParameters),
+				refinedCount,
+				cornerCount));
+
+		grayscalePixels.Reset();
+		return FindCorners(texturePixelArrayUnit, resizeParameters, corners);
+	}
+
+	return true;
+}
+
+bool FLensSolverWorkerFindCorners::TrackCorners(
+	FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+	const FResizeParameters & resizeParameters,
+	TArray<float> & corners)
+{
+	const FChessboardSearchParameters & textureSearchParameters = texturePixelArrayUnit.textureSearchParameters;
+	const FString & calibrationID = texturePixelArrayUnit.baseParameters.calibrationID;
+
+	const int width = resizeParameters.resizeX;
+	const int height = resizeParameters.resizeY;
+
+	TArray<float> trackedCorners;
+	if (!LensSolverWorkDistributor::GetInstance().GetTrackedCorners(calibrationID, width, height, texturePixelArrayUnit.cornerSearchParameters.maxConsecutiveTrackedSnapshots, trackedCorners) || 
+		trackedCorners.Num() != corners.Num())
+		return false;
+
+	FLensSolverPixelBufferPtr grayscalePixels = GetGrayscalePixels(texturePixelArrayUnit, width, height);
+	if (!grayscalePixels.IsValid())
+		return false;
+
+	const int cornerCount = trackedCorners.Num() / 2;
+	const float previousSpacing = LensSolverCornerRefinement::MinCornerSpacing(trackedCorners.GetData(), textureSearchParameters.checkerBoardCornerCountX, textureSearchParameters.checkerBoardCornerCountY);
+
+	/* Search as far as the board can move without a corner reaching it's neighbour's window. */
+	int windowRadius = FMath::Min(LensSolverCornerRefinement::MaxWindowRadius(trackedCorners.GetData(), textureSearchParameters.checkerBoardCornerCountX, textureSearchParameters.checkerBoardCornerCountY), maxTrackingWindowRadius);
+
+	uint32 trackingStartCycles = FPlatformTime::Cycles();
+	int refinedCount = LensSolverCornerRefinement::RefineCorners(grayscalePixels->GetData(), width, height, trackedCorners.GetData(), cornerCount, windowRadius);
+	INC_FLOAT_STAT_BY(STAT_LensCalibratorCornerTrackingTime, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - trackingStartCycles));
+
+	/* Tracking only counts if every corner converged and the board kept it's shape, otherwise 
+	corners may have locked on to something else and we fall back to a full detection. */
+	const float spacing = LensSolverCornerRefinement::MinCornerSpacing(trackedCorners.GetData(), textureSearchParameters.checkerBoardCornerCountX, textureSearchParameters.checkerBoardCornerCountY);
+	if (refinedCount != cornerCount || spacing < previousSpacing * 0.5f)
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorCornerTrackingFailures);
+
+		if (Debug())
+			QueueLog(FString::Printf(TEXT("(INFO): %s: Lost track of the corners, %d/%d corners converged, falling back to full detection."),
+				*JobDataToString(texturePixelArrayUnit.baseParameters),
+				refinedCount,
+				cornerCount));
+
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_LensCalibratorSnapshotsTracked);
+
+	corners = trackedCorners;
+	LensSolverWorkDistributor::GetInstance().SetTrackedCorners(calibrationID, width, height, corners, true);
+	return true;
+}
+
+bool FLensSolverWorkerFindCorners::PassesPrefilter(
+	const FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+	const FResizeParameters & resizeParameters)
+{
+	const FChessboardSearchParameters & textureSearchParameters = texturePixelArrayUnit.textureSearchParameters;
+	const FPixelArrayParameters & pixelArrayParameters = texturePixelArrayUnit.pixelArrayParameters;
+
+	const int width = resizeParameters.resizeX;
+	const int height = resizeParameters.resizeY;
+
+	/* Let the full search deal with a mismatched buffer. */
+	if (width <= 0 || height <= 0 || pixelArrayParameters.pixels->Num() < width * height * pixelArrayParameters.stride)
+		return true;
+
+	int cornerResponseCount = 0;
+
+	const double prefilterStartSeconds = FPlatformTime::Seconds();
+	bool mayContainBoard = LensSolverBoardPrefilter::MayContainBoard(
+		pixelArrayParameters.pixels->GetData(),
+		width,
+		height,
+		pixelArrayParameters.stride,
+		textureSearchParameters.checkerBoardCornerCountX,
+		textureSearchParameters.checkerBoardCornerCountY,
+		cornerResponseCount);
+	LensSolverPipelineLatency::Get().Record(UPipelineStage::Prefilter, prefilterStartSeconds, FPlatformTime::Seconds());
+
+	if (mayContainBoard)
+	{
+		INC_DWORD_STAT(STAT_LensCalibratorPrefilterPassed);
+		return true;
+	}
+
+	INC_DWORD_STAT(STAT_LensCalibratorPrefilterRejected);
+
+	if (Debug())
+		QueueLog(FString::Printf(TEXT("(INFO): %s: Prefilter found %d chessboard like corners, skipped the corner search."),
+			*JobDataToString(texturePixelArrayUnit.baseParameters),
+			cornerResponseCount));
+
+	return false;
+}
+
+FLensSolverPixelBufferPtr FLensSolverWorkerFindCorners::GetGrayscalePixels(
+	const FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+	int width,
+	int height)
+{
+	const FPixelArrayParameters & pixelArrayParameters = texturePixelArrayUnit.pixelArrayParameters;
+
+	if (width <= 0 || height <= 0 || pixelArrayParameters.pixels->Num() < width * height * pixelArrayParameters.stride)
+	{
+		QueueLog(FString::Printf(TEXT("(ERROR): %s: Pixel buffer does not match the image size: (%d, %d)."), *JobDataToString(texturePixelArrayUnit.baseParameters), width, height));
+		return nullptr;
+	}
+
+	if (pixelArrayParameters.stride == 1)
+		return pixelArrayParameters.pixels;
+
+	/* BGRA snapshots are converted with the blit shader's weights. */
+	FLensSolverPixelBufferPtr grayscalePixels = LensSolverWorkDistributor::GetInstance().AcquirePixelBuffer(width * height);
+	LensSolverUtilities::ResampleToGrayscale(pixelArrayParameters.pixels->GetData(), width, height, grayscalePixels->GetData(), width, height, false, false, LensSolverUtilities::blitShaderLumaWeights);
+	return grayscalePixels;
+}
+
 FResizeParameters FLensSolverWorkerFindCorners::CalculateResizeParameters(const FChessboardSearchParameters & textureSearchParameters)
 {
 	FResizeParameters resizeParameters;
@@ -44,7 +44,12 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
 	void OnReceiveCalibrationResult (FCalibrationResult calibrationResult);
 
-	/* After all calibration jobs are finished, this method is called. */
+	/* When provisional solves are enabled, this method is called with the calibration refined
+	with the images processed so far, before OnReceiveCalibrationResult is called with the final result. */
+	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
+	void OnReceiveProvisionalCalibrationResult (FCalibrationResult calibrationResult);
+
+	/* After all calibration jobs are finished, this method is called. It is also called with jobInfo.failed set when a job is canceled before producing results. */
 	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
 	void OnFinishedJob (FJobInfo jobInfo);
 
@@ -52,6 +57,11 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
 	void OnGeneratedDistortionMaps (FDistortionCorrectionTextureContainer generatedCorrectionDistortionMap, FDistortionCorrectionTextureContainer generatedUnCorrectionDistortionMap);
 
+	/* When a batch of distortion maps is generated, this method is called once with the maps of every 
+	set of coefficients in the batch, in the order they were submitted in. */
+	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
+	void OnGeneratedDistortionMapBatch (const TArray<FDistortionCorrectionTextureContainer> & generatedCorrectionDistortionMaps, const TArray<FDistortionCorrectionTextureContainer> & generatedUnCorrectionDistortionMaps);
+
 	UFUNCTION(BlueprintImplementableEvent, Category="Lens Calibrator")
 	void OnDistortedImageCorrected (UTexture2D * correctedDistortedImage);
 };
\ No newline at end of file
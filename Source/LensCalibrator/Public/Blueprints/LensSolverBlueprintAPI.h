@@ -32,6 +32,7 @@
 
 #include "ILensSolverEventReceiver.h"
 #include "JobInfo.h"
+#include "PipelineLatencySnapshot.h"
 
 #include "LensSolverBlueprintAPI.generated.h"
 
@@ -66,6 +67,13 @@ public:
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 		FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams);
 
+	/* Generate the distortion correction maps of many sets of coefficients, such as every zoom level of a lens, in one submission 
+	and receive all of them at once through ILensSolverEventReceiver::OnGeneratedDistortionMapBatch. */
+	UFUNCTION(BlueprintCallable, Category = "Lens Calibrator")
+	static void GenerateDistortionCorrectionMaps(
+		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
+		TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams);
+
 	UFUNCTION(BlueprintCallable, Category = "Lens Calibrator")
 	static void DistortTextureWithTexture(
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
@@ -81,6 +89,15 @@ public:
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 		FDistortTextureWithCoefficientsParams distortionCorrectionParams);
 
+	/* Generate the distortion correction maps of a zoom stack straight into a floating point 16bit (half) 3D volume texture, 
+	one slice per set of coefficients. This skips reading back, writing and packing intermediate textures, editor only. 
+	Set generateUncorrectionMaps for maps that apply the distortion instead of correcting it. */
+	UFUNCTION(BlueprintCallable, Category = "Lens Calibrator")
+	static bool GenerateDistortionCorrectionMapsIntoVolumeTexture(
+		TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+		bool generateUncorrectionMaps,
+		UVolumeTexture * volumeTexture);
+
 	/* Input array of textures and pack them into a floating point 16bit (half) 3D volume texture. */
 	UFUNCTION(BlueprintCallable, Category = "Lens Calibrator")
 	static bool PackArrayOfDistortionCorrectionMapsIntoVolumeTexture(
@@ -107,6 +124,19 @@ public:
 		int calibrateWorkerCount,
 		bool shutDownWorkersAfterCompletingTasks = true);
 
+	/* Process images and calibrate on the engine's task graph, which is sized to the core count, instead of a fixed number of workers. */
+	UFUNCTION(BlueprintCallable, Category="Lens Calibrator")
+	static void StartTaskGraphImageProcessors(
+		bool shutDownWorkersAfterCompletingTasks = true);
+
 	UFUNCTION(BlueprintCallable, Category="Lens Calibrator")
 	static void StopBackgroundImageprocessors();
+
+	/* Get the latency of each stage of the calibration pipeline recorded since startup or the last reset. */
+	UFUNCTION(BlueprintCallable, Category="Lens Calibrator")
+	static void GetPipelineLatencySnapshot(
+		FPipelineLatencySnapshot & outputSnapshot);
+
+	UFUNCTION(BlueprintCallable, Category="Lens Calibrator")
+	static void ResetPipelineLatency();
 };
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Commandlets/Commandlet.h"
+
+#include "JobInfo.h"
+#include "SolvedPoints.h"
+
+#include "LensCalibratorBenchmarkCommandlet.generated.h"
+
+/* Headless throughput benchmark that calibrates a set of image folders and reports images per second, per stage 
+latency and peak memory as JSON so runs on a build box can be compared against each other. Example:
+
+UE4Editor-Cmd <Project>.uproject -run=LensCalibratorBenchmark -folders="D:/Zoom0;D:/Zoom1" -findCornersWorkers=8 -calibrateWorkers=2 -output="D:/Benchmark.json" -nullrhi -unattended
+
+-calibrateWorkers defaults to one per folder up to half the cores, -findCornersWorkers to one less than the cores.
+
+Optional arguments: -taskGraph, -cornerCountX=, -cornerCountY=, -squareSizeMM=, -resolutionX=, -resolutionY=,
+-resizePercentage=, -coarseToFine, -prefilter, -maxViews=, -timeout= (seconds).
+
+The corner search settings and each final calibration (views used, field of view, principal point and distortion)
+are written next to the timings, so the cost and accuracy of a search option can be compared by running the same
+folders twice, once with and once without the option, e.g: -coarseToFine. */
+UCLASS()
+class ULensCalibratorBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+private:
+	bool jobFinished;
+	FJobInfo finishedJobInfo;
+	TArray<FCalibrationResult> calibrationResults;
+
+	void OnFinishedJob(const FJobInfo & jobInfo);
+	void OnCalibrationResult(const FCalibrationResult & calibrationResult);
+
+public:
+	ULensCalibratorBenchmarkCommandlet();
+
+	virtual int32 Main(const FString & params) override;
+};
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Commandlets/Commandlet.h"
+
+#include "LensCalibratorContentionBenchmarkCommandlet.generated.h"
+
+/* Headless microbenchmark of the synchronization on the work distribution hot path, it sweeps the thread count from one up to the 
+requested count in powers of two and reports operations per second and lock contentions as JSON. The find corner work queues are 
+compared against the locked deque and work unit count they replaced, and the work distributor's job and worker shards against the 
+single lock that guarded both before. Example:
+
+UE4Editor-Cmd <Project>.uproject -run=LensCalibratorContentionBenchmark -threads=64 -operations=200000 -output="D:/ContentionBenchmark.json" -nullrhi -unattended */
+UCLASS()
+class ULensCalibratorContentionBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULensCalibratorContentionBenchmarkCommandlet();
+
+	virtual int32 Main(const FString & params) override;
+};
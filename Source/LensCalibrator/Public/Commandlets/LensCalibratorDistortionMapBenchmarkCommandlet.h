@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Commandlets/Commandlet.h"
+
+#include "LensCalibratorDistortionMapBenchmarkCommandlet.generated.h"
+
+/* Headless benchmark of distortion correction maps generated on the CPU at 1080p and 4K and of packing a zoom stack 
+of them into volume texture slices, reports maps and slices per second as JSON. Each iteration generates a correction 
+and an inverse correction map. Example:
+
+UE4Editor-Cmd <Project>.uproject -run=LensCalibratorDistortionMapBenchmark -iterations=20 -slices=64 -output="D:/DistortionMapBenchmark.json" -nullrhi -unattended */
+UCLASS()
+class ULensCalibratorDistortionMapBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULensCalibratorDistortionMapBenchmarkCommandlet();
+
+	virtual int32 Main(const FString & params) override;
+};
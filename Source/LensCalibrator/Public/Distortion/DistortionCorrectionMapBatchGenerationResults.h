@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+#include "DistortionCorrectionMapGenerationResults.h"
+
+#include "DistortionCorrectionMapBatchGenerationResults.generated.h"
+
+/* The distortion correction maps of every set of coefficients submitted together in one batch. */
+USTRUCT(BlueprintType)
+struct FDistortionCorrectionMapBatchGenerationResults
+{
+	GENERATED_BODY()
+	/* The associated job ID. */
+	FString id;
+
+	/* Results in the order the parameters were submitted in. */
+	TArray<FDistortionCorrectionMapGenerationResults> results;
+};
@@ -52,6 +52,16 @@ struct FDistortionCorrectionMapGenerationResults
 	/* Array of pixels to distort an image.*/
 	TArray<FFloat16Color> inverseDistortionCorrectionPixels;
 
+	/* Largest distance in pixels between a pixel of the inverse map distorted again and the pixel itself, infinite if any pixel failed. */
+	float maxInverseRoundTripErrorPixels;
+
+	/* Pixels of the inverse map without a solution, past where the lens model folds over itself. */
+	int inverseFailedPixelCount;
+
+	/* Files the maps are written to once their textures are created, empty if they were already written. */
+	FString correctionFilePath;
+	FString inverseCorrectionFilePath;
+
 	FDistortionCorrectionMapGenerationResults()
 	{
 		width = 0;
@@ -68,5 +78,8 @@ struct FDistortionCorrectionMapGenerationResults
 		k4 = 0.0f;
 		k5 = 0.0f;
 		k6 = 0.0f;
+
+		maxInverseRoundTripErrorPixels = 0.0f;
+		inverseFailedPixelCount = 0;
 	}
 };
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+#include "DistortionCorrectionMapGenerationParameters.h"
+
+/* Generates distortion correction maps on the CPU for machines without a GPU, the maps match the
+ones rendered with DistortionCorrectionMapGeneration.usf up to the rounding of half floats. */
+class DistortionCorrectionMapGenerator
+{
+public:
+	/* Generate the correction map, or when generateInverseMap is set the inverse map, which is solved per pixel with 
+	Newton's method. Inverse pixels without a solution keep their own UV and have an alpha of 0. Rows are generated in parallel and four pixels of a row at a time with SIMD, the output is 
+	ordered top row first like a readback of the render target. */
+	static void GenerateMap(
+		const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+		bool generateInverseMap,
+		TArray<FFloat16Color> & outputPixels);
+
+	/* Same as above into memory that is already allocated for outputMapResolution pixels, such as a slice of a volume texture. */
+	static void GenerateMap(
+		const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+		bool generateInverseMap,
+		FFloat16Color * outputPixels);
+
+	/* Distort every pixel of an inverse map with the lens model and return the largest distance in output map pixels 
+	from where it should land. This includes the rounding of the map to half floats. Pixels flagged without a solution 
+	or that don't land anywhere finite are counted in outputFailedPixelCount, the error is infinite if there are any. */
+	static float MeasureInverseRoundTripError(
+		const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+		const TArray<FFloat16Color> & inversePixels,
+		int & outputFailedPixelCount);
+};
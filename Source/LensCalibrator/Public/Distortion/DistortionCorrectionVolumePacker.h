@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+/* Packs equally sized half float distortion correction maps into the slices of a volume texture. */
+class DistortionCorrectionVolumePacker
+{
+public:
+	/* Copy each map into its slice of outputVoxels keeping the R and G channels and clearing B and A. 
+	Slices are packed in parallel, two voxels at a time with SIMD. */
+	static void PackSlices(
+		const TArray<const FFloat16Color*> & slices,
+		int width,
+		int height,
+		FFloat16Color * outputVoxels);
+};
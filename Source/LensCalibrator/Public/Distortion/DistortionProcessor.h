@@ -16,9 +16,11 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "CoreTypes.h"
+#include "Engine/VolumeTexture.h"
 
 #include "DistortionCorrectionMapGenerationParameters.h"
 #include "DistortionCorrectionMapGenerationResults.h"
+#include "DistortionCorrectionMapBatchGenerationResults.h"
 #include "DistortTextureWithCoefficientsParams.h"
 #include "DistortTextureWithTextureFileParams.h"
 #include "DistortTextureWithTextureParams.h"
@@ -36,22 +38,58 @@ class LENSCALIBRATOR_API UDistortionProcessor : public UObject
 private:
 
 	TQueue<FDistortionCorrectionMapGenerationResults, EQueueMode::Mpsc> queuedDistortionCorrectionMapResults;
+	TQueue<FDistortionCorrectionMapBatchGenerationResults, EQueueMode::Mpsc> queuedDistortionCorrectionMapBatchResults;
 	TQueue<FCorrectedDistortedImageResults, EQueueMode::Mpsc> queuedCorrectedDistortedImageResults;
 	TMap<FString, DistortionJob> cachedEvents;
 
+	/* Writes of CPU generated maps to file that haven't completed yet, only accessed on the game thread. */
+	TArray<TFuture<bool>> pendingFileWrites;
+
 	void GenerateDistortionCorrectionMapRenderThread(
 		FRHICommandListImmediate& RHICmdList,
 		FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams,
 		const FString correctionFilePath,
 		const FString inverseCorrectionFilePath);
 
+	/* Generate both maps of a set of coefficients on the CPU, the files are written on the game thread once the textures are created. */
+	void GenerateDistortionCorrectionMapResultsCPU(
+		const FDistortionCorrectionMapGenerationParameters & distortionCorrectionMapGenerationParams,
+		const FString & correctionFilePath,
+		const FString & inverseCorrectionFilePath,
+		FDistortionCorrectionMapGenerationResults & outputResults);
+
+	/* Same as GenerateDistortionCorrectionMapRenderThread without the GPU, runs on the thread pool. */
+	void GenerateDistortionCorrectionMapCPU(
+		FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams,
+		const FString correctionFilePath,
+		const FString inverseCorrectionFilePath);
+
+	/* Generate the maps of every set of coefficients in a batch on the thread pool and queue the batch once they are all generated. */
+	void GenerateDistortionCorrectionMapBatchCPU(
+		const FString id,
+		const TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+		const TArray<FString> correctionFilePaths,
+		const TArray<FString> inverseCorrectionFilePaths);
+
+	/* Create the textures of a generated correction and uncorrection map on the game thread. */
+	bool CreateDistortionCorrectionTextureContainers(
+		const FDistortionCorrectionMapGenerationResults & result,
+		FDistortionCorrectionTextureContainer & outputCorrectionTextureContainer,
+		FDistortionCorrectionTextureContainer & outputUncorrectionTextureContainer);
+
+	/* After it's textures are created a result's maps are no longer needed, so they are moved into 
+	the image write queue instead of being copied. Does nothing if the result has no file paths. */
+	void WriteDistortionCorrectionMapFiles(FDistortionCorrectionMapGenerationResults & result);
+
 	void UndistortImageRenderThread(
 		FRHICommandListImmediate& RHICmdList,
 		FDistortTextureWithTextureParams distortionCorrectionParams,
 		const FString generatedOutputPath);
 
 	void PollDistortionCorrectionMapGenerationResults();
+	void PollDistortionCorrectionMapBatchGenerationResults();
 	void PollCorrectedDistortedImageResults();
+	void PollFileWrites();
 
 public:
 
@@ -62,6 +100,20 @@ public:
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 		FDistortionCorrectionMapGenerationParameters distortionCorrectionMapGenerationParams);
 
+	/* Generate the maps of many sets of coefficients, such as every zoom level of a lens, in one submission.
+	The maps are generated on the CPU and ILensSolverEventReceiver::OnGeneratedDistortionMapBatch is called once with all of them. */
+	void GenerateDistortionCorrectionMaps(
+		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
+		TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams);
+
+	/* Generate the maps of a zoom stack straight into the source of a volume texture, one slice per set of coefficients 
+	in the order they are passed in. Each slice is the correction map, or with generateUncorrectionMaps the uncorrection map, 
+	picked from the forward and inverse map by the sign of it's k1. All maps need the same resolution, this is only available in the editor. */
+	bool GenerateDistortionCorrectionMapsIntoVolumeTexture(
+		TArray<FDistortionCorrectionMapGenerationParameters> distortionCorrectionMapGenerationParams,
+		bool generateUncorrectionMaps,
+		UVolumeTexture * volumeTexture);
+
 	void DistortTextureWithTexture(
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 		FDistortTextureWithTextureParams distortionCorrectionParams);
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Stats/Stats.h"
+
+/* Stats for the calibration pipeline, view them in the editor or a 
+packaged build with the console command: "stat LensCalibrator". */
+DECLARE_STATS_GROUP(TEXT("LensCalibrator"), STATGROUP_LensCalibrator, STATCAT_Advanced);
+
+/* Time between a producer queuing work to an idle worker and that worker waking up. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Worker Wakeup Latency (ms)"), STAT_LensCalibratorWorkerWakeupLatency, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Worker Wakeups"), STAT_LensCalibratorWorkerWakeups, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Work stealing between find corner workers. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("FindCorners Work Units Processed"), STAT_LensCalibratorFindCornersWorkUnitsProcessed, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("FindCorners Work Units Stolen"), STAT_LensCalibratorWorkUnitsStolen, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Images of continuous jobs dropped, and images of one time jobs that had to wait, because the work queues of all find corner workers were full. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("FindCorners Work Units Dropped"), STAT_LensCalibratorFindCornersWorkUnitsDropped, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("FindCorners Queue Full Waits"), STAT_LensCalibratorFindCornersQueueFullWaits, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Corner detection and calibration tasks dispatched to the task graph that have not completed yet. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Task Graph Tasks In Flight"), STAT_LensCalibratorTaskGraphTasksInFlight, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Contention on the work distributor's lock shards. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Jobs Lock Contentions"), STAT_LensCalibratorJobsLockContentions, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Streams Lock Contentions"), STAT_LensCalibratorStreamsLockContentions, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Workers Lock Wait Time (ms)"), STAT_LensCalibratorWorkersLockWaitTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Media stream backpressure, snapshots are skipped while a stream has too many snapshots in flight. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Media Stream Snapshots In Flight"), STAT_LensCalibratorMediaStreamSnapshotsInFlight, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Media Stream Frames Dropped"), STAT_LensCalibratorMediaStreamFramesDropped, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Media stream snapshots read back from the GPU through the staging texture ring or with a blocking readback. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Async Snapshot Readbacks"), STAT_LensCalibratorAsyncSnapshotReadbacks, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Blocking Snapshot Readbacks"), STAT_LensCalibratorBlockingSnapshotReadbacks, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Pixel buffers allocated by the pool and filled for media stream snapshots, each snapshot should cost one copy 
+and allocations should stop growing once the pool is warm. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pixel Buffer Allocations"), STAT_LensCalibratorPixelBufferAllocations, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pixel Buffer Copies"), STAT_LensCalibratorPixelBufferCopies, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Pixel buffer pool reuse and the most memory it has held at once. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pixel Buffer Pool Hits"), STAT_LensCalibratorPixelBufferPoolHits, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pixel Buffer Pool Misses"), STAT_LensCalibratorPixelBufferPoolMisses, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pixel Buffer Pool High Water Mark"), STAT_LensCalibratorPixelBufferPoolHighWaterMark, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Folder scanning and reading texture files ahead of the find corner workers. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Files Prefetched"), STAT_LensCalibratorFilesPrefetched, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("File Prefetch Stall Time (ms)"), STAT_LensCalibratorFilePrefetchStallTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Folder Scan Time (ms)"), STAT_LensCalibratorFolderScanTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Throughput of each stage of the texture file pipeline, read, decode and corner detection. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("File Read Time (ms)"), STAT_LensCalibratorFileReadTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Files Decoded"), STAT_LensCalibratorFilesDecoded, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Decode Time (ms)"), STAT_LensCalibratorDecodeTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Detections"), STAT_LensCalibratorCornerDetections, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Detection Time (ms)"), STAT_LensCalibratorCornerDetectionTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Coarse to fine searches and the full resolution sub pixel refinement of their corners. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Coarse To Fine Searches"), STAT_LensCalibratorCoarseToFineSearches, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Refinement Time (ms)"), STAT_LensCalibratorCornerRefinementTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Corners Refined"), STAT_LensCalibratorCornersRefined, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Corners Not Refined"), STAT_LensCalibratorCornersNotRefined, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Coarse To Fine Fallbacks"), STAT_LensCalibratorCoarseToFineFallbacks, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Media stream snapshots whose corners were tracked from the previous snapshot instead of detected. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Snapshots Tracked"), STAT_LensCalibratorSnapshotsTracked, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Tracking Failures"), STAT_LensCalibratorCornerTrackingFailures, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Tracking Time (ms)"), STAT_LensCalibratorCornerTrackingTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Images rejected by the prefilter without a corner search versus images it passed on to the full search. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Prefilter Rejected"), STAT_LensCalibratorPrefilterRejected, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Prefilter Passed"), STAT_LensCalibratorPrefilterPassed, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Prefilter Time (ms)"), STAT_LensCalibratorPrefilterTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Views of the calibration pattern passed to the solver and views left out as redundant. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Calibration Views Selected"), STAT_LensCalibratorViewsSelected, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Calibration Views Discarded"), STAT_LensCalibratorViewsDiscarded, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("View Selection Time (ms)"), STAT_LensCalibratorViewSelectionTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Solves with the views found so far before all images of a calibration are processed. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Provisional Solves"), STAT_LensCalibratorProvisionalSolves, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Provisional Solves Skipped"), STAT_LensCalibratorProvisionalSolvesSkipped, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Provisional Solve Time (ms)"), STAT_LensCalibratorProvisionalSolveTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Time spent in final calibration solves summed across calibration workers. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Calibration Solve Time (ms)"), STAT_LensCalibratorCalibrationSolveTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Distortion correction maps generated on the CPU instead of rendered on the GPU. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("CPU Distortion Maps Generated"), STAT_LensCalibratorCPUDistortionMapsGenerated, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("CPU Distortion Map Generation Time (ms)"), STAT_LensCalibratorCPUDistortionMapGenerationTime, STATGROUP_LensCalibrator, LENSCALIBRATOR_API);
+
+/* Per stage latency of the calibration pipeline, view them with the console command: "stat LensCalibratorLatency". 
+Histograms and percentiles of the same stages are available from ULensSolverBlueprintAPI::GetPipelineLatencySnapshot. */
+DECLARE_STATS_GROUP(TEXT("LensCalibratorLatency"), STATGROUP_LensCalibratorLatency, STATCAT_Advanced);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Read And Decode (ms)"), STAT_LensCalibratorReadAndDecodeLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Queue Wait (ms)"), STAT_LensCalibratorQueueWaitLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Corner Detection (ms)"), STAT_LensCalibratorCornerDetectionLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Latch Wait (ms)"), STAT_LensCalibratorLatchWaitLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Calibrate Queue Wait (ms)"), STAT_LensCalibratorCalibrateQueueWaitLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Solve (ms)"), STAT_LensCalibratorSolveLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Delivery (ms)"), STAT_LensCalibratorDeliveryLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("End To End (ms)"), STAT_LensCalibratorEndToEndLatency, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Calibrations Delivered"), STAT_LensCalibratorCalibrationsDelivered, STATGROUP_LensCalibratorLatency, LENSCALIBRATOR_API);
@@ -41,6 +41,9 @@
 
 #include "LensSolver.generated.h"
 
+DECLARE_MULTICAST_DELEGATE_OneParam(OnFinishedJobNativeDel, const FJobInfo &)
+DECLARE_MULTICAST_DELEGATE_OneParam(OnCalibrationResultNativeDel, const FCalibrationResult &)
+
 /* This is where lens calibration starts from. */
 UCLASS()
 class LENSCALIBRATOR_API ULensSolver : public UObject
@@ -76,11 +79,21 @@ private:
 	/* Build path to output debug images. */
 	FString PrepareDebugOutputPath (const FString & debugOutputPath);
 
+	void ConfigureWorkDistributor(bool shutDownWorkersAfterCompletingTasks);
+
 public:
 
 	ULensSolver() {}
 	~ULensSolver() {}
 
+	/* Native listeners for finished jobs, broadcasted on the game thread alongside
+	ILensSolverEventReceiver::OnFinishedJob for callers that cannot implement blueprint events. */
+	OnFinishedJobNativeDel onFinishedJobNativeDel;
+
+	/* Native listeners for provisional and final calibration results, broadcasted on the game thread
+	alongside the ILensSolverEventReceiver calibration result events. */
+	OnCalibrationResultNativeDel onCalibrationResultNativeDel;
+
 	/* Start calibration from a set of folders each containing a set of textures
 	representing the calibration pattern at a particular zoom level, then pass in corner 
 	search parameters, calibration parameters and media stream texture 
@@ -103,6 +116,7 @@ public:
 		FJobInfo& ouptutJobInfo);
 
 	void StartBackgroundImageProcessors(int findCornersWorkerCount, int calibrateWorkerCount, bool shutDownWorkersAfterCompletingTasks);
+	void StartTaskGraphImageProcessors(bool shutDownWorkersAfterCompletingTasks);
 	void StopBackgroundImageprocessors();
 
 	void Poll ();
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+/* A cheap test for whether an image may contain a chessboard, used to skip the full corner search on 
+images without one. It counts chessboard like corners with a ChESS style response on a coarse grid 
+that takes a fixed number of taps per sample, so it's cost doesn't grow with the image resolution. */
+class LensSolverBoardPrefilter
+{
+public:
+	/* Returns false if there are too few chessboard like corners in the image for it to contain a board with 
+	cornerCountX by cornerCountY corners. Pixels are either BGRA (stride 4) or grayscale (stride 1). */
+	static bool MayContainBoard(
+		const uint8 * pixels,
+		int width,
+		int height,
+		int stride,
+		int cornerCountX,
+		int cornerCountY,
+		int & outputCornerResponseCount);
+};
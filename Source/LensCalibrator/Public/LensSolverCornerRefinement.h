@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+/* Sub pixel refinement of chessboard corners, this is used by the coarse to fine search to bring corners 
+found in a downscaled image back to the accuracy of a full resolution search. */
+class LensSolverCornerRefinement
+{
+public:
+	/* Refine interleaved X/Y corner positions in place in an 8 bit grayscale image, using the same gradient 
+	orthogonality criteria as OpenCV's cornerSubPix. Corners that don't converge inside their window keep 
+	their estimate. Returns the number of corners that were refined. */
+	static int RefineCorners(
+		const uint8 * pixels,
+		int width,
+		int height,
+		float * corners,
+		int cornerCount,
+		int windowRadius);
+
+	/* The shortest distance between two neighbouring corners of the chessboard. */
+	static float MinCornerSpacing(
+		const float * corners,
+		int cornerCountX,
+		int cornerCountY);
+
+	/* The largest window that does not reach over to the neighbouring corners of the chessboard. */
+	static int MaxWindowRadius(
+		const float * corners,
+		int cornerCountX,
+		int cornerCountY);
+
+private:
+	/* Returns false and leaves the corner untouched if the solution does not settle within refinementEpsilon 
+	before running out of iterations, or if it settles outside of the window. */
+	static bool RefineCorner(
+		const uint8 * pixels,
+		int width,
+		int height,
+		const TArray<float> & weights,
+		int windowRadius,
+		float & cornerX,
+		float & cornerY);
+};
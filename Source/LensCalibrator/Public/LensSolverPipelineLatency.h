@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "HAL/CriticalSection.h"
+
+#include "PipelineLatencySnapshot.h"
+
+/* Aggregates the time work units spend between the hops of the calibration pipeline into a histogram 
+per stage. Stages are recorded from any thread as work units pass through, this class is a singleton. */
+class LensSolverPipelineLatency
+{
+public:
+	/* Get the singleton instance of this class. */
+	static LensSolverPipelineLatency & Get()
+	{
+		static LensSolverPipelineLatency pipelineLatency;
+		return pipelineLatency;
+	}
+
+	LensSolverPipelineLatency(LensSolverPipelineLatency const&) = delete;
+	void operator=(LensSolverPipelineLatency const&) = delete;
+
+	/* Record the time between two timestamps from FPipelineTimestamps, nothing is recorded if either hop was not passed. */
+	void Record(UPipelineStage stage, double startSeconds, double endSeconds);
+
+	void GetSnapshot(FPipelineLatencySnapshot & outputSnapshot);
+	void Reset();
+
+private:
+	LensSolverPipelineLatency();
+
+	static const int stageCount = (int)UPipelineStage::Prefilter + 1;
+
+	/* Bucket 0 holds samples below a quarter of a millisecond and each following bucket doubles the bound. */
+	static const int bucketCount = 20;
+
+	struct FStageHistogram
+	{
+		int sampleCount;
+		double sumMS;
+		float minMS;
+		float maxMS;
+		int buckets[bucketCount];
+	};
+
+	FCriticalSection latencyLock;
+	FStageHistogram histograms[stageCount];
+	double resetSeconds;
+
+	static int GetBucket(float milliseconds);
+	static float GetBucketUpperBound(int bucket);
+	static float GetPercentile(const FStageHistogram & histogram, float percentile);
+};
@@ -42,6 +42,41 @@ public:
 	static bool ValidateFilePath(FString& path, const FString& backupFolder, const FString & backupName, const FString & backupExtension);
 	static bool GetImageFilesInFolder(const FString& folder, TArray<FString>& files);
 
+	/* Decode an image file already loaded in memory into 8 bit BGRA pixels. */
+	static bool DecodeImage(
+		const TArray<uint8> & fileData,
+		const FString & absoluteFilePath,
+		TArray64<uint8> & outputPixels,
+		int & outputWidth,
+		int & outputHeight);
+
+	/* The red, green and blue weights of the blit shader's grayscale conversion, and the ones OpenCV converts 
+	with which the wrapper used when it read and converted texture files itself. */
+	static const FVector blitShaderLumaWeights;
+	static const FVector openCVLumaWeights;
+
+	/* Resample 8 bit BGRA pixels into 8 bit grayscale with the given luma weights and the same flipping as the blit shader. Downscales 
+	average the area each output pixel covers so fine detail such as the squares of a far away board doesn't alias, upscales are bilinear. */
+	static void ResampleToGrayscale(
+		const uint8 * sourcePixels,
+		int sourceWidth,
+		int sourceHeight,
+		uint8 * outputPixels,
+		int outputWidth,
+		int outputHeight,
+		bool flipX,
+		bool flipY,
+		const FVector & lumaWeights);
+
+	/* Area average 8 bit grayscale pixels down to a smaller size. */
+	static void DownsampleGrayscale(
+		const uint8 * sourcePixels,
+		int sourceWidth,
+		int sourceHeight,
+		uint8 * outputPixels,
+		int outputWidth,
+		int outputHeight);
+
 	static FString GenerateGenericOutputPath(const FString & subFolder);
 	static FString GenerateGenericDistortionCorrectionMapOutputPath(const FString & subFolder);
 
@@ -68,4 +103,12 @@ public:
 		int width,
 		int height,
 		TUniquePtr<TImagePixelData<FFloat16Color>> data);
+
+	/* Queue writing a half float texture to an EXR without waiting for it, writes queued 
+	this way are performed concurrently. The returned future is invalid if nothing was queued. */
+	static TFuture<bool> WriteTexture16Async(
+		FString absoluteTexturePath,
+		int width,
+		int height,
+		TUniquePtr<TImagePixelData<FFloat16Color>> data);
 };
\ No newline at end of file
@@ -58,4 +58,24 @@ struct FDistortionCorrectionMapGenerationParameters
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	float k3;
+
+	/* Generate the maps on the CPU instead of rendering them, this is always the case when running without a GPU (-nullrhi). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool generateOnCPU;
+
+	FDistortionCorrectionMapGenerationParameters()
+	{
+		zoomLevel = 0.0f;
+		sourceResolution = FIntPoint(1920, 1080);
+		sourcePrincipalPixelPoint = FVector2D(960.0f, 540.0f);
+		outputMapResolution = FIntPoint(1920, 1080);
+
+		k1 = 0.0f;
+		k2 = 0.0f;
+		p1 = 0.0f;
+		p2 = 0.0f;
+		k3 = 0.0f;
+
+		generateOnCPU = false;
+	}
 };
\ No newline at end of file
@@ -23,6 +23,29 @@
 
 #include "LensSolverWorkerParameters.generated.h"
 
+/* FPlatformTime::Seconds() at which a work unit passed each hop of the calibration pipeline, 0 if it has not passed that hop. */
+struct FPipelineTimestamps
+{
+	double queued;
+	double decoded;
+	double dequeued;
+	double cornersFound;
+	double latched;
+	double solved;
+	double delivered;
+
+	FPipelineTimestamps()
+	{
+		queued = 0.0;
+		decoded = 0.0;
+		dequeued = 0.0;
+		cornersFound = 0.0;
+		latched = 0.0;
+		solved = 0.0;
+		delivered = 0.0;
+	}
+};
+
 USTRUCT(BlueprintType)
 struct FBaseParameters
 {
@@ -38,6 +61,9 @@ struct FBaseParameters
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	float zoomLevel;
 
+	/* Travels with the work unit so the time between hops can be recorded, see LensSolverPipelineLatency. */
+	FPipelineTimestamps pipelineTimestamps;
+
 	FBaseParameters () 
 	{
 		jobID = "";
@@ -80,6 +106,16 @@ struct FCalibrationParameters
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	bool useRationalModel;
 
+	/* The most views of the calibration pattern to solve with, when more images are found the most diverse views by position, 
+	size and tilt of the pattern are picked since near identical views slow down the solve without improving it. 0 uses all views. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	int maxCalibrationViewCount;
+
+	/* Solve provisionally each time this many more images of a calibration have been processed, each provisional solve
+	starts from the intrinsics of the previous one and is sent to OnReceiveProvisionalCalibrationResult. 0 disables provisional solves. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	int provisionalSolveInterval;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	bool writeCalibrationResultsToFile;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
@@ -101,6 +137,8 @@ struct FCalibrationParameters
 		fixRadialDistortionCoefficientK5 = false;
 		fixRadialDistortionCoefficientK6 = false;
 		useRationalModel = false;
+		maxCalibrationViewCount = 0;
+		provisionalSolveInterval = 0;
 
 		writeCalibrationResultsToFile = false;
 		calibrationResultsOutputPath = "";
@@ -129,6 +167,20 @@ struct FTextureSearchParameters
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	FIntPoint checkerBoardCornerCount;
 
+	/* Search for the corners in a copy of the image downscaled by resizePercentage, then refine them to sub pixel 
+	accuracy in the full resolution image in a small window around each estimate. Images are kept at full resolution. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool coarseToFineSearch;
+
+	/* Half the size in pixels of the full resolution window corners are refined in, 0 picks one from the resize percentage. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	int cornerRefinementWindowRadius;
+
+	/* Run a cheap test for chessboard like corners before the corner search and skip the search on images without enough of them, 
+	this saves the full search cost on frames where the board is out of view or occluded. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool prefilterImagesWithoutBoard;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	bool writePreCornerDetectionTextureToFile;
 
@@ -149,6 +201,9 @@ struct FTextureSearchParameters
 		exhaustiveSearch = false;
 		checkerBoardSquareSizeMM = 12.7f;
 		checkerBoardCornerCount = FIntPoint(12, 8);
+		coarseToFineSearch = false;
+		cornerRefinementWindowRadius = 0;
+		prefilterImagesWithoutBoard = false;
 		writeCornerVisualizationTextureToFile = false;
 		cornerVisualizationTextureOutputPath = "";
 	}
@@ -184,6 +239,25 @@ struct FMediaStreamParameters
 	float streamSnapshotIntervalFrequencyInSeconds;
 	int64 previousSnapshotTime;
 
+	/* The maximum number of snapshots of this stream that can be waiting on the render thread or the find corner workers, 
+	snapshots are skipped while this limit is reached so memory stays flat if the workers fall behind. 0 disables the limit. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	int maxInFlightSnapshots;
+
+	/* The blit shader already converts the stream to grayscale, so snapshots can be rendered, read back and searched 
+	as a single 8 bit channel instead of BGRA, which is a quarter of the memory and bandwidth per snapshot. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool grayscaleSnapshot;
+
+	/* Seed the corner search of each snapshot with the corners found in the previous snapshot and refine them in a small 
+	window, a full detection only runs when tracking is lost. This suits locked off cameras where the board barely moves. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool trackCorners;
+
+	/* Force a full detection after this many consecutive tracked snapshots so tracking can't drift, 0 never forces one. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	int maxConsecutiveTrackedSnapshots;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	float zoomLevel;
 
@@ -205,6 +279,11 @@ struct FMediaStreamParameters
 		expectedStreamSnapshotCount = 50;
 		currentStreamSnapshotCount = 0;
 		streamSnapshotIntervalFrequencyInSeconds = 2.0f;
+		previousSnapshotTime = 0;
+		maxInFlightSnapshots = 4;
+		grayscaleSnapshot = true;
+		trackCorners = false;
+		maxConsecutiveTrackedSnapshots = 10;
 		zoomLevel = 0.0f;
 
 		writePreBlitRenderTextureToFile = false;
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+
+#include "PipelineLatencySnapshot.generated.h"
+
+/* The hops of the calibration pipeline that latency is measured between. */
+UENUM(BlueprintType)
+enum class UPipelineStage : uint8
+{
+	/* From queuing an image file to it being read and decoded. */
+	ReadAndDecode UMETA(DisplayName = "Read And Decode"),
+	/* From queuing an image, or decoding it, to a find corner worker picking it up. */
+	QueueWait UMETA(DisplayName = "Queue Wait"),
+	/* From a find corner worker picking up an image to it's corners being found. */
+	CornerDetection UMETA(DisplayName = "Corner Detection"),
+	/* From an image's corners being found to the calibration it belongs to being latched. */
+	LatchWait UMETA(DisplayName = "Latch Wait"),
+	/* From a calibration being latched to a calibration worker picking it up. */
+	CalibrateQueueWait UMETA(DisplayName = "Calibrate Queue Wait"),
+	/* Solving a calibration. */
+	Solve UMETA(DisplayName = "Solve"),
+	/* From a calibration being solved to it's result being sent to the event receiver. */
+	Delivery UMETA(DisplayName = "Delivery"),
+	/* From queuing the first image of a calibration to it's final result being sent to the event receiver. */
+	EndToEnd UMETA(DisplayName = "End To End"),
+	/* Testing an image for a chessboard before the corner search, only recorded when prefiltering is enabled. */
+	Prefilter UMETA(DisplayName = "Prefilter")
+};
+
+/* Latency of a single stage of the calibration pipeline. */
+USTRUCT(BlueprintType)
+struct FPipelineStageLatency
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	TEnumAsByte<UPipelineStage> stage;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	int sampleCount;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float averageMS;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float minMS;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float maxMS;
+
+	/* Percentiles are estimated from the histogram, so they are the upper bound of the bucket the percentile falls in. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float p50MS;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float p95MS;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float p99MS;
+
+	/* Sample count per bucket, see FPipelineLatencySnapshot::histogramBucketUpperBoundsMS. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	TArray<int> histogram;
+
+	FPipelineStageLatency()
+	{
+		stage = UPipelineStage::ReadAndDecode;
+		sampleCount = 0;
+		averageMS = 0.0f;
+		minMS = 0.0f;
+		maxMS = 0.0f;
+		p50MS = 0.0f;
+		p95MS = 0.0f;
+		p99MS = 0.0f;
+	}
+};
+
+/* Latency of every stage of the calibration pipeline recorded since the last reset. */
+USTRUCT(BlueprintType)
+struct FPipelineLatencySnapshot
+{
+	GENERATED_BODY()
+
+	/* One entry per stage in the order of UPipelineStage. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	TArray<FPipelineStageLatency> stages;
+
+	/* The upper bound in milliseconds of each histogram bucket, the last bucket holds everything above the previous bound. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	TArray<float> histogramBucketUpperBoundsMS;
+
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	float secondsSinceReset;
+
+	FPipelineLatencySnapshot()
+	{
+		secondsSinceReset = 0.0f;
+	}
+};
@@ -81,6 +81,14 @@ struct FCalibrationResult
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	int imageCount;
 
+	/* Whether this result was solved before all the images of the calibration were processed. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	bool provisional;
+
+	/* Milliseconds the calibration worker spent solving this result. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
+	float solveTimeMS;
+
 	FCalibrationResult()
 	{
 		success = false;
@@ -103,5 +111,7 @@ struct FCalibrationResult
 		k6 = 0.0f;
 
 		imageCount = 0;
+		provisional = false;
+		solveTimeMS = 0.0f;
 	}
 };
@@ -37,12 +37,52 @@ struct FLensSolverTextureWorkUnit
 	}
 };
 
+/* Pixel buffers are shared between work unit copies so queuing, stealing and dispatching a work unit never copies the pixels. */
+typedef TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> FLensSolverPixelBufferPtr;
+
 struct FPixelArrayParameters
 {
-	TArray<FColor> pixels;
+	/* Tightly packed rows of pixels, either BGRA (stride 4) or grayscale (stride 1). */
+	FLensSolverPixelBufferPtr pixels;
+
+	/* Bytes per pixel. */
+	int stride;
+
 	FPixelArrayParameters()
 	{
-		pixels = TArray<FColor>();
+		pixels = nullptr;
+		stride = 4;
+	}
+};
+
+/* Plugin side corner search options that the wrapper's search parameters don't carry. The coarse to fine search finds the corners 
+in a downscaled copy of the image and refines them at full resolution, tracking refines the corners of the previous snapshot 
+and the prefilter skips the search on images that can't contain a board. */
+struct FCornerSearchParameters
+{
+	bool coarseToFine;
+
+	/* Scale of the downscaled copy the corners are initially searched in. */
+	float coarseSearchPercentage;
+
+	/* Half the size in pixels of the full resolution refinement window, 0 picks one from the coarse search percentage. */
+	int windowRadius;
+
+	bool trackCorners;
+
+	/* Force a full detection after this many consecutive tracked snapshots, 0 never forces one. */
+	int maxConsecutiveTrackedSnapshots;
+
+	bool prefilter;
+
+	FCornerSearchParameters()
+	{
+		coarseToFine = false;
+		coarseSearchPercentage = 0.5f;
+		windowRadius = 0;
+		trackCorners = false;
+		maxConsecutiveTrackedSnapshots = 0;
+		prefilter = false;
 	}
 };
 
@@ -52,6 +92,7 @@ struct FLensSolverPixelArrayWorkUnit
 	FChessboardSearchParameters textureSearchParameters;
 	FResizeParameters resizeParameters;
 	FPixelArrayParameters pixelArrayParameters;
+	FCornerSearchParameters cornerSearchParameters;
 
 	FLensSolverPixelArrayWorkUnit() 
 	{
@@ -63,6 +104,7 @@ struct FLensSolverTextureFileWorkUnit
 	FBaseParameters baseParameters;
 	FChessboardSearchParameters textureSearchParameters;
 	FTextureFileParameters textureFileParameters;
+	FCornerSearchParameters cornerSearchParameters;
 
 	FLensSolverTextureFileWorkUnit() 
 	{
@@ -90,14 +132,32 @@ struct FLensSolverCalibrationPointsWorkUnit
 	FLensSolverCalibrationPointsWorkUnit() {}
 };
 
+/* Views are shared between the latches of a calibration so each provisional solve copies pointers instead of every view's corners. */
+typedef TSharedPtr<const FLensSolverCalibrationPointsWorkUnit, ESPMode::ThreadSafe> FLensSolverCalibrationViewPtr;
+
 struct FCalibrateLatch
 {
 	FBaseParameters baseParameters;
 	FCalibrationParameters calibrationParameters;
 	FResizeParameters resizeParameters;
 
+	/* The views of the calibration pattern found for this calibration, they are accumulated by the 
+	work distributor so the latch can be solved by whichever calibration worker is free. */
+	TArray<FLensSolverCalibrationViewPtr> views;
+
+	/* Solve with the views found so far, the work distributor keeps them for the next solve of the same calibration. */
+	bool provisional;
+
+	/* Start a provisional solve from the principal point of the previous provisional solve of this calibration, 
+	this is never set on the final latch so the final result doesn't depend on the provisional solves. */
+	bool warmStart;
+	FVector2D warmStartPrincipalPixelPoint;
+
 	FCalibrateLatch()
 	{
+		provisional = false;
+		warmStart = false;
+		warmStartPrincipalPixelPoint = FVector2D(0, 0);
 	}
 };
 
@@ -106,4 +166,5 @@ struct FMediaStreamWorkUnit
 	FBaseParameters baseParameters;
 	FChessboardSearchParameters textureSearchParameters;
 	FMediaStreamParameters mediaStreamParameters;
+	FCornerSearchParameters cornerSearchParameters;
 };
@@ -19,6 +19,7 @@
 #include "CoreMinimal.h"
 #include "CoreTypes.h"
 #include "Engine.h"
+#include "Templates/Atomic.h"
 
 /* The purpose of this class is to flag to workers various global states
 happening in the plugin such as a shutdown. This class is a singleton. */
@@ -38,14 +39,12 @@ private:
 		isShuttingDown = false;
 	}
 
-	/* The lock for workers to access the global state. */
-	FCriticalSection threadLock;
+	/* When workers are initialized, they will call count/uncount methods in this class. These are atomics 
+	since every worker polls the shutdown flag on each iteration of it's loop. */
+	TAtomic<int32> findCornerWorkerCount { 0 };
+	TAtomic<int32> calibrateWorkerCount { 0 };
 
-	/* When workers are initialized, they will call count/uncount methods in this class. */
-	int findCornerWorkerCount = 0;
-	int calibrateWorkerCount = 0;
-
-	bool isShuttingDown;
+	TAtomic<bool> isShuttingDown;
 
 public:
 	WorkerRegistry(WorkerRegistry const&) = delete;
@@ -54,82 +53,54 @@ public:
 	/* This method is called on the main thread to flag to workers to exit their loops. */
 	void FlagExitAllShutdown ()
 	{
-		threadLock.Lock();
 		isShuttingDown = true;
-		threadLock.Unlock();
 	}
 
 	/* Workwers call this method to determine whether they should exit their loops. */
 	bool ShouldExitAll ()
 	{
-		bool shuttingDown;
-
-		threadLock.Lock();
-		shuttingDown = isShuttingDown;
-		threadLock.Unlock();
-
-		return shuttingDown;
+		return isShuttingDown.Load();
 	}
 
 	/* When a calibration worker is initialized, this method will be called by that worker. */
 	void CountCalibrateWorker() 
 	{
-		threadLock.Lock();
-		calibrateWorkerCount++; 
-		threadLock.Unlock();
+		++calibrateWorkerCount; 
 	}
 
 	/* When a calibration worker is de-initialized, this method will be called by that worker. */
 	void UncountCalibrateWorker() 
 	{
-		threadLock.Lock();
-		calibrateWorkerCount--; 
-		threadLock.Unlock();
+		--calibrateWorkerCount; 
 	}
 
 	/* This is called by the main thread to determine if we still have calibration workers running. */
 	bool CalibrateWorkersRunning()
 	{
-		bool running = false;
-		threadLock.Lock();
-		running = calibrateWorkerCount > 0;
-		threadLock.Unlock();
-		return running;
+		return calibrateWorkerCount.Load() > 0;
 	}
 
 	/* When a find corner worker is initialized, this method will be called by that worker.*/
 	void CountFindCornerWorker() 
 	{
-		threadLock.Lock();
-		findCornerWorkerCount++; 
-		threadLock.Unlock();
+		++findCornerWorkerCount; 
 	}
 
 	/* When a find corner worker is de-initialized, this method will be called by that worker.*/
 	void UncountFindCornerWorker() 
 	{
-		threadLock.Lock();
-		findCornerWorkerCount--; 
-		threadLock.Unlock();
+		--findCornerWorkerCount; 
 	}
 
 	/* This is called by the main thread to determine if we still have find corner workers running. */
 	bool FindCornersWorkersRunning()
 	{
-		bool running = false;
-		threadLock.Lock();
-		running = findCornerWorkerCount > 0;
-		threadLock.Unlock();
-		return running;
+		return findCornerWorkerCount.Load() > 0;
 	}
 
 	/* This is called by the main thread to determine if any workers are running. */
 	bool WorkersRunning()
 	{
-		bool running = false;
-		threadLock.Lock();
-		running = findCornerWorkerCount  > 0 && calibrateWorkerCount > 0;
-		threadLock.Unlock();
-		return running;
+		return findCornerWorkerCount.Load() > 0 && calibrateWorkerCount.Load() > 0;
 	}
 };
\ No newline at end of file
@@ -21,6 +21,7 @@
 
 #include "ILensSolverEventReceiver.h"
 #include "JobInfo.h"
+#include "LensSolverWorkUnit.h"
 
 #include "Job.generated.h"
 
@@ -68,5 +69,11 @@ struct FJob
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Lens Calibrator")
 	TMap<FString, FExpectedAndCurrentImageCount> expectedAndCurrentImageCounts;
 
+	/* Views of the calibration pattern found so far keyed by calibration ID, they are handed to whichever calibration worker solves the calibration. */
+	TMap<FString, TArray<FLensSolverCalibrationViewPtr>> calibrationViews;
+
+	/* The principal point of the latest provisional solve keyed by calibration ID, the next solve of that calibration starts from it. */
+	TMap<FString, FVector2D> provisionalPrincipalPixelPoints;
+
 	int64 startTime;
 };
@@ -38,4 +38,22 @@ struct FJobInfo
 	/* A job can contain multiple calibrations essentially 1 per zoom level. */
 	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
 	TArray<FString> calibrationIDs;
+
+	/* The number of media stream snapshots skipped because too many snapshots were still being processed. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	int droppedFrameCount;
+
+	/* Milliseconds spent solving each calibration keyed by calibration ID, calibrations of different zoom levels are solved in parallel. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	TMap<FString, float> calibrationSolveTimesMS;
+
+	/* The job ended without producing calibration results, for example because one of it's folders contained no images. */
+	UPROPERTY(BlueprintReadWrite, Category="Lens Calibrator")
+	bool failed;
+
+	FJobInfo()
+	{
+		droppedFrameCount = 0;
+		failed = false;
+	}
 };
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Templates/Atomic.h"
+
+/* Bounded lock free queue that supports multiple producers and multiple consumers, based on Dmitry Vyukov's 
+bounded MPMC queue. Each cell carries a sequence number that tells producers and consumers whether the cell 
+is free to write or ready to read, so enqueuing and dequeuing only contend on a single compare exchange. The 
+capacity is rounded up to a power of two and Enqueue returns false instead of blocking when the queue is full. */
+template<typename ElementType>
+class TLensSolverBoundedQueue
+{
+private:
+	struct FCell
+	{
+		TAtomic<uint64> sequence;
+		ElementType data;
+	};
+
+	FCell * cells;
+	uint64 capacityMask;
+
+	/* Keep the producer and consumer positions on separate cache lines to avoid false sharing. */
+	alignas(PLATFORM_CACHE_LINE_SIZE) TAtomic<uint64> enqueuePosition;
+	alignas(PLATFORM_CACHE_LINE_SIZE) TAtomic<uint64> dequeuePosition;
+
+public:
+	TLensSolverBoundedQueue(uint32 inputCapacity)
+	{
+		uint32 capacity = FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(inputCapacity, 2));
+
+		cells = new FCell[capacity];
+		capacityMask = capacity - 1;
+
+		for (uint32 i = 0; i < capacity; i++)
+			cells[i].sequence.Store(i, EMemoryOrder::Relaxed);
+
+		enqueuePosition.Store(0, EMemoryOrder::Relaxed);
+		dequeuePosition.Store(0, EMemoryOrder::Relaxed);
+	}
+
+	~TLensSolverBoundedQueue()
+	{
+		delete[] cells;
+	}
+
+	TLensSolverBoundedQueue(TLensSolverBoundedQueue const&) = delete;
+	void operator=(TLensSolverBoundedQueue const&) = delete;
+
+	/* Returns false if the queue is full. */
+	bool Enqueue(ElementType && item)
+	{
+		FCell * cell;
+		uint64 position = enqueuePosition.Load(EMemoryOrder::Relaxed);
+
+		while (true)
+		{
+			cell = &cells[position & capacityMask];
+			int64 difference = (int64)cell->sequence.Load() - (int64)position;
+
+			/* The cell is free, try to claim it. */
+			if (difference == 0)
+			{
+				if (enqueuePosition.CompareExchange(position, position + 1))
+					break;
+			}
+
+			/* The cell still holds an element that a consumer has not dequeued yet, so we are full. */
+			else if (difference < 0)
+				return false;
+
+			/* Another producer claimed the cell first. */
+			else position = enqueuePosition.Load(EMemoryOrder::Relaxed);
+		}
+
+		cell->data = MoveTemp(item);
+		cell->sequence.Store(position + 1);
+
+		return true;
+	}
+
+	bool Enqueue(const ElementType & item)
+	{
+		ElementType copy = item;
+		return Enqueue(MoveTemp(copy));
+	}
+
+	/* Returns false if the queue is empty. */
+	bool Dequeue(ElementType & outputItem)
+	{
+		FCell * cell;
+		uint64 position = dequeuePosition.Load(EMemoryOrder::Relaxed);
+
+		while (true)
+		{
+			cell = &cells[position & capacityMask];
+			int64 difference = (int64)cell->sequence.Load() - (int64)(position + 1);
+
+			/* The cell has been written, try to claim it. */
+			if (difference == 0)
+			{
+				if (dequeuePosition.CompareExchange(position, position + 1))
+					break;
+			}
+
+			/* The cell has not been written yet, so we are empty. */
+			else if (difference < 0)
+				return false;
+
+			/* Another consumer claimed the cell first. */
+			else position = dequeuePosition.Load(EMemoryOrder::Relaxed);
+		}
+
+		outputItem = MoveTemp(cell->data);
+		cell->sequence.Store(position + capacityMask + 1);
+
+		return true;
+	}
+
+	/* This is only a snapshot since producers and consumers may be modifying the queue concurrently. */
+	bool IsEmpty() const
+	{
+		return dequeuePosition.Load() >= enqueuePosition.Load();
+	}
+
+	uint32 Capacity() const
+	{
+		return (uint32)(capacityMask + 1);
+	}
+};
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Templates/Atomic.h"
+#include "Templates/SharedPointer.h"
+
+#include "LensSolverWorkUnit.h"
+
+/* Feeds texture file work units to the find corner workers through two stages. The read stage loads the files into 
+memory a few files ahead of the workers, and the decode stage decodes them into grayscale pixel arrays on the thread 
+pool, so storage, decoding and corner detection all overlap. A file occupies one of the read ahead slots until it is 
+decoded, so at most the prefetch count of files are read or decoded at once. The decoded frames are bounded separately 
+to the find corner worker count plus the prefetch count, a decoded frame counts until the worker is done with it's pixels. */
+class FLensSolverFilePrefetcher : public TSharedFromThis<FLensSolverFilePrefetcher, ESPMode::ThreadSafe>
+{
+public:
+	FLensSolverFilePrefetcher(int inputPrefetchCount);
+	~FLensSolverFilePrefetcher();
+
+	/* Read, decode and queue the work units to the work distributor, this blocks while all read 
+	ahead slots are in use so it should be called from a background thread. It stops early once 
+	the job is no longer registered or the workers are flagged to exit. */
+	void QueueWorkUnits(TArray<FLensSolverTextureFileWorkUnit> & workUnits);
+
+	/* The number of files to read ahead from the console variable: "LensCalibrator.FilePrefetchCount". */
+	static int GetPrefetchCountSetting();
+
+private:
+	int prefetchCount;
+	TAtomic<int32> inFlightCount;
+
+	int maxDecodedFrameCount;
+	TAtomic<int32> decodedFrameCount;
+
+	/* Triggered whenever a file is decoded or a worker releases the pixels of a decoded frame. */
+	FEvent * slotReleasedEvent;
+
+	/* The job's remaining files are neither read nor decoded once this is true. */
+	bool ShouldStop(const FString & jobID);
+
+	bool ReadFile(const FString & absoluteFilePath, TArray<uint8> & outputFileData);
+	void DecodeWorkUnit(FLensSolverTextureFileWorkUnit & workUnit, TArray<uint8> & fileData);
+	void ReleaseSlot();
+	void ReleaseDecodedFrame();
+};
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2020 - LensCalibrator contributors, see Contributors.txt at the root of the project.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreTypes.h"
+#include "Templates/SharedPointer.h"
+
+#include "LensSolverWorkUnit.h"
+
+/* Pool of pixel buffers bucketed by size, so the media stream snapshots and decoded frames of a long running calibration 
+reuse the same few allocations instead of allocating and freeing a full frame for every image. Buffers are handed out as 
+shared pointers that return themselves to the pool when the last reference is released. */
+class FLensSolverPixelBufferPool : public TSharedFromThis<FLensSolverPixelBufferPool, ESPMode::ThreadSafe>
+{
+public:
+	FLensSolverPixelBufferPool();
+	~FLensSolverPixelBufferPool();
+
+	/* Get a buffer of byteCount bytes, the contents are uninitialized. */
+	FLensSolverPixelBufferPtr Acquire(int32 byteCount);
+
+	/* Free all buffers that are not currently in use. */
+	void Trim();
+
+	/* The number of buffers handed out and how many of those had to be allocated, these are counted even when stats are compiled out. */
+	int64 GetAcquiredBufferCount();
+	int64 GetAllocatedBufferCount();
+
+private:
+	/* Buffer sizes are rounded up to this so frames of slightly different sizes share a bucket. */
+	static const int32 bucketGranularity = 64 * 1024;
+
+	/* Upper limit of idle buffers kept per bucket, anything released beyond this is freed. */
+	static const int maxPooledBuffersPerBucket = 8;
+
+	FCriticalSection threadLock;
+
+	/* Idle buffers keyed by bucket size. */
+	TMap<int32, TArray<TArray<uint8>*>> freeBuffers;
+
+	/* Bytes allocated by the pool, both idle and in use, and the most that has been allocated at once. */
+	int64 allocatedBytes;
+	int64 highWaterMarkBytes;
+
+	int64 acquiredBufferCount;
+	int64 allocatedBufferCount;
+
+	void Release(TArray<uint8> * buffer, int32 bucketSize);
+
+	void Lock();
+	void Unlock();
+};
@@ -15,12 +15,14 @@
 
 #pragma once
 #include "Engine.h"
+#include "Async/TaskGraphInterfaces.h"
 
 #include "LensSolverWorker.h"
 #include "LensSolverWorkerFindCorners.h"
 #include "LensSolverWorkerCalibrate.h"
 #include "LensSolverWorkUnit.h"
 #include "LensSolverWorkerInterfaceContainer.h"
+#include "LensSolverPixelBufferPool.h"
 #include "FindCornerWorkerParameters.h"
 #include "CalibrationWorkerParameters.h"
 #include "MediaAssets/Public/MediaTexture.h"
@@ -30,18 +32,73 @@
 #include "QueueContainers.h"
 #include "ILensSolverEventReceiver.h"
 
+/* The corners last found in a media stream's snapshots, the next snapshot's corner search starts from these. */
+struct FTrackedCorners
+{
+	TArray<float> corners;
+	int width;
+	int height;
+	int consecutiveTrackedSnapshots;
+
+	FTrackedCorners()
+	{
+		width = 0;
+		height = 0;
+		consecutiveTrackedSnapshots = 0;
+	}
+};
+
+/* A staging texture that a media stream snapshot is copied into, the pixels are mapped once the fence written after the copy 
+has been passed by the GPU. These are only ever accessed on the render thread. */
+struct FMediaStreamSnapshotReadback
+{
+	FTexture2DRHIRef stagingTexture;
+	FGPUFenceRHIRef fence;
+	FMediaStreamWorkUnit mediaStreamWorkUnit;
+	int width;
+	int height;
+	int stride;
+	bool inUse;
+
+	FMediaStreamSnapshotReadback()
+	{
+		width = 0;
+		height = 0;
+		stride = 4;
+		inUse = false;
+	}
+};
+
+class FLensSolverPixelBufferOneCopyPerFrameTest;
+
 /* This is really where the bulk of the work preparation and distribution occurs for the workers, data is feed in from ULensSolver
 and this class handles queuing all the work units, manages the workers and receives the results from the calibration. This class follows
 the singleton pattern, so there should only be one throughout the lifetime of the UE4 instance. */
 class LensSolverWorkDistributor
 {
 private:
-	LensSolverWorkDistributor() {}
+	LensSolverWorkDistributor() 
+	{
+		useTaskGraph = false;
+		pendingSnapshotReadbackCount = 0;
+		pixelBufferPool = MakeShared<FLensSolverPixelBufferPool, ESPMode::ThreadSafe>();
+	}
+
+	/* Drives a snapshot through a distributor of it's own with find corner workers whose queues it owns. */
+	friend class FLensSolverPixelBufferOneCopyPerFrameTest;
 
-	FCriticalSection threadLock;
+	/* The shared state is split into three shards so that media stream snapshots, job bookkeeping and 
+	work distribution don't serialize on one lock. Never hold more than one shard at a time.
+	- jobsLock: jobs and the calibration views accumulated in them, cachedCalibrationParameters.
+	- workersLock: worker maps, work load sorted worker IDs, useTaskGraph and the task graph executors.
+	- streamsLock: mediaTextureJobLUT, mediaStreamInFlightSnapshotCounts, trackedCorners. */
+	FCriticalSection jobsLock;
+	FRWLock workersLock;
+	FCriticalSection streamsLock;
 
 	QueueCalibrationResultOutputDel queueCalibrationResultOutputDel;
 	QueueCalibrateWorkUnitInputDel queueCalibrateWorkUnitInputDel;
+	StealFindCornersWorkUnitOutputDel stealFindCornersWorkUnitOutputDel;
 
 	QueueFinishedJobOutputDel queueFinishedJobOutputDel;
 	QueueLogOutputDel queueLogOutputDel;
@@ -60,20 +117,46 @@ private:
 	/* Calibration workers keyed via worker ID. */
 	TMap<FString, FWorkerCalibrateInterfaceContainer> calibrateWorkers;
 
+	/* In task graph mode each image is dispatched as a corner detection task and each calibration ID's latch is dispatched as 
+	a calibration task once all it's images are processed. The executors are workers that never run their own loop, they and the 
+	interface containers their delegates are bound in are shared with in flight tasks so they outlive StopTaskGraphExecutors until 
+	the last task referencing them completes, the distributor only ever drops it's references to them. */
+	bool useTaskGraph;
+	TSharedPtr<FLensSolverWorkerFindCorners, ESPMode::ThreadSafe> findCornersTaskExecutor;
+	TSharedPtr<FLensSolverWorkerCalibrate, ESPMode::ThreadSafe> calibrateTaskExecutor;
+	TSharedPtr<FWorkerFindCornersInterfaceContainer, ESPMode::ThreadSafe> findCornersTaskExecutorInterfaceContainer;
+	TSharedPtr<FWorkerCalibrateInterfaceContainer, ESPMode::ThreadSafe> calibrateTaskExecutorInterfaceContainer;
+
 	bool shutDownWorkersAfterCompletedTasks;
 
 	/* Array of find corner worker IDs sorted each frame by work load. */
 	TArray<FString> workLoadSortedFindCornerWorkers;
 
-	/* Array of calibration worker IDs sorted each frame by work load. */
-	TArray<FString> workLoadSortedCalibrateWorkers;
-
 	/* Job ID and job mapping. */
 	TMap<FString, FJob> jobs;
 
-	TMap<FString, const FString> workerCalibrationIDLUT;
 	TMap<FString, FMediaStreamWorkUnit> mediaTextureJobLUT;
 
+	/* Number of snapshots per media stream job ID that have been queued to the render thread but have not finished corner detection. */
+	TMap<FString, int> mediaStreamInFlightSnapshotCounts;
+
+	/* Corners to track into the next snapshot keyed by calibration ID. */
+	TMap<FString, FTrackedCorners> trackedCorners;
+
+	void ClearTrackedCorners(const TArray<FString> & calibrationIDs);
+
+	/* Ring of staging textures for asynchronous snapshot readback, this is only accessed on the render thread. The pending count
+	is read on the game thread so we only queue a render command to poll the ring when there is something to pick up. */
+	static const int snapshotReadbackRingSize = 3;
+	FMediaStreamSnapshotReadback snapshotReadbacks[snapshotReadbackRingSize];
+	TAtomic<int32> pendingSnapshotReadbackCount;
+
+	/* The staging texture snapshots are copied into when they are read back blocking, this is only accessed on the render thread. */
+	FMediaStreamSnapshotReadback blockingSnapshotReadback;
+
+	/* Frame sized buffers for snapshots and decoded images are recycled through this pool, it is thread safe. */
+	TSharedPtr<FLensSolverPixelBufferPool, ESPMode::ThreadSafe> pixelBufferPool;
+
 	/* After the calibration workers complete their work units, the 
 	results are queued in this structure. Here we also need to
 	explicitly state that we are declaring a queue with multiple
@@ -88,28 +171,54 @@ private:
 		const FString workerID,
 		FWorkerFindCornersInterfaceContainer *& outputInterfaceContainerPtr);
 
-	/* This returns an interface to a calibration worker via worker ID. */
-	bool GetCalibrateWorkerInterfaceContainerPtr(
-		const FString calibrationID,
+	/* This returns interfaces to the find corner workers ordered by work load, call while holding the workers read lock and only use them until it is released. */
+	void GetWorkLoadSortedFindCornersContainerInterfacePtrs(
+		TArray<FWorkerFindCornersInterfaceContainer*> & outputInterfaceContainerPtrs);
+
+	/* This returns an interface to the least loaded calibration worker, call while holding the workers read lock and only use it until it is released. */
+	bool GetLeastLoadedCalibrateWorkerInterfaceContainerPtr(
 		FWorkerCalibrateInterfaceContainer *& outputInterfaceContainerPtr);
 
-	/* After corners are found by the find corner workers, the results are polled, put 
-	into a calibrate work unit and queued to calibration background workers for processing. */
+	/* After corners are found by the find corner workers, the results are accumulated with their 
+	job and latched to a calibration worker once all the images of a calibration are processed. */
 	void QueueCalibrateWorkUnit(FLensSolverCalibrationPointsWorkUnit calibrateWorkUnit);
 
+	/* Called when no find corner worker has room for an image, drops a continuous job's image or waits and returns true to retry a one time job's image. */
+	bool BackOffOrDropFindCornersWorkUnit(
+		const FString & jobID,
+		const FBaseParameters & baseParameters,
+		const FChessboardSearchParameters & textureSearchParameters,
+		int & retryCount);
+
+	/* Queue an empty result for an image that could not be queued to any find corner worker. */
+	void QueueEmptyCalibrateWorkUnit(const FBaseParameters & baseParameters, const FChessboardSearchParameters & textureSearchParameters);
+
 	void LatchCalibrateWorker(const FCalibrateLatch& latchData);
 
+	/* Called by an idle find corner worker to move the oldest work unit from the busiest peer's bounded queue into it's own. */
+	bool StealFindCornersWorkUnit(const FString thiefWorkerID);
+
 	/* When calibration is complete, calibration background workers will queue the results back onto the main thread in this class. */
 	void QueueCalibrationResult(const FCalibrationResult calibrationResult);
 
-	bool IterateImageCount(const FString & jobID, const FString& calibrationID);
+	/* Add the view to it's job and iterate the processed image count, returns true with the latch to dispatch when a solve is due. */
+	bool AccumulateCalibrationView(
+		FLensSolverCalibrationPointsWorkUnit & calibrateWorkUnit,
+		FCalibrateLatch & outputLatchData,
+		bool & outputHitExpectedImageCount);
+
+	/* Called once a media stream snapshot has finished corner detection or was discarded, so the stream can take another snapshot. */
+	void ReleaseMediaStreamSnapshot(const FString & jobID);
 
-	void SortFindCornersWorkersByWorkLoad();
-	void SortCalibrateWorkersByWorkLoad();
+	/* Add media stream snapshots that were skipped due to backpressure to the job's dropped frame count. */
+	void AddDroppedFrames(const FString & jobID, int droppedFrameCount);
 
 	void PollShutdownFindCornerWorkersIfNecessary();
 	void PollShutdownAllWorkersIfNecessary();
 
+	/* Log per worker diagnostics such as wakeup latency. */
+	void LogWorkerStats();
+
 	bool ValidateMediaTexture(const UMediaTexture* inputTexture);
 
 	void PrepareFindCornerWorkers(
@@ -119,19 +228,62 @@ private:
 
 	void StopFindCornerWorkers();
 	void StopCalibrationWorkers();
+	void StopTaskGraphExecutors();
+
+	void DispatchTextureFileWorkUnitTask(FLensSolverTextureFileWorkUnit textureFileWorkUnit);
+	void DispatchPixelArrayWorkUnitTask(FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit);
+	void DispatchCalibrateTask(const FCalibrateLatch & latchData);
+
+	/* Lock access to the jobs shard, locks may occur on the main thread or the worker's threads. */
+	void LockJobs();
+	void UnlockJobs();
 
-	/* Lock access to the variables within this class, locks 
-	may occur on the main thread or the worker's threads. */
-	void Lock();
+	/* The worker registry is read on every queued work unit and only written when workers 
+	start or stop, so readers share the lock. */
+	void ReadLockWorkers();
+	void ReadUnlockWorkers();
+	void WriteLockWorkers();
+	void WriteUnlockWorkers();
 
-	/* Unlock access to the variables within this class. */
-	void Unlock();
+	/* Lock access to the media stream shard. */
+	void LockStreams();
+	void UnlockStreams();
 
 	int64 GetTickNow();
 	void MediaTextureRenderThread(
 		FRHICommandListImmediate& RHICmdList,
 		const FMediaStreamWorkUnit mediaStreamParameters);
 
+	/* Should snapshots be read back asynchronously, the null RHI has no GPU to read back from so it always uses the blocking path. */
+	bool UseAsyncSnapshotReadback();
+
+	/* Copy the blitted snapshot into a free staging texture in the ring and fence it, returns false if no staging texture is free. */
+	bool EnqueueSnapshotReadback(
+		FRHICommandListImmediate& RHICmdList,
+		FRHITexture2D* snapshotTexture,
+		const FMediaStreamWorkUnit & mediaStreamWorkUnit,
+		int width,
+		int height,
+		int stride);
+
+	/* Create the readback's staging texture unless it already has one of the snapshot's size and format. */
+	void PrepareSnapshotReadbackStagingTexture(
+		FMediaStreamSnapshotReadback & readback,
+		int width,
+		int height,
+		int stride);
+
+	/* Map the staging textures whose copies the GPU has completed and queue their pixels for corner detection. */
+	void PollSnapshotReadbacks(FRHICommandListImmediate& RHICmdList);
+
+	/* Optionally write the snapshot to file then queue it to the find corner workers. */
+	void QueueMediaStreamSnapshotPixels(
+		const FMediaStreamWorkUnit & mediaStreamWorkUnit,
+		FLensSolverPixelBufferPtr surfaceData,
+		int width,
+		int height,
+		int stride);
+
 protected:
 public:
 
@@ -162,19 +314,68 @@ public:
 		int calibrateWorkerCount
 	);
 
+	/* Use the engine's task graph instead of a fixed number of find corner and calibration workers, the 
+	task graph is sized to the core count so the corner and calibration phases can each use the whole machine. */
+	void PrepareTaskGraph();
+
 	void StopBackgroundWorkers();
 
 	int GetFindCornerWorkerCount();
 	int GetCalibrateCount();
 
+	/* Are there workers or task graph executors available to process jobs? */
+	bool WorkersAvailable();
+
 	FJobInfo RegisterJob (
 		TScriptInterface<ILensSolverEventReceiver> eventReceiver,
 		const TArray<int> & expectedImageCounts,
 		const int expectedResultCount,
 		const UJobType jobType);
 
+	/* Jobs whose image counts are only known after their folders are scanned in the background are registered with placeholder 
+	counts so the job info can be returned right away, the real counts are set here before any of the job's images are queued. */
+	bool SetExpectedImageCounts(const FString & jobID, const TArray<int> & expectedImageCounts);
+
+	/* Remove a job that failed before any of it's images were queued and report it as finished with FJobInfo::failed 
+	set, so listeners waiting for the job to finish don't wait forever. */
+	void FailJob(const FString & jobID);
+
+	/* Whether the job is still registered, it no longer is once it finished or failed or the workers were stopped. */
+	bool IsJobRegistered(const FString & jobID);
+
 	void SetCalibrateWorkerParameters(FCalibrationParameters calibrationParameters);
 	void QueueTextureArrayWorkUnit(const FString & jobID, FLensSolverPixelArrayWorkUnit pixelArrayWorkUnit);
+
+	/* Get a pixel buffer of byteCount bytes from the pool, it returns to the pool when the last reference is released. */
+	FLensSolverPixelBufferPtr AcquirePixelBuffer(int32 byteCount);
+
+	/* Copy a mapped staging texture with rows rowPitchInPixels apart into a tightly packed pixel buffer from the pool. */
+	static FLensSolverPixelBufferPtr CopyMappedSnapshot(
+		FLensSolverPixelBufferPool & pool,
+		const void * data,
+		int rowPitchInPixels,
+		int width,
+		int height,
+		int stride);
+
+	/* Get the corners last found in a calibration's snapshots of the same size, returns false if 
+	there are none or they were tracked maxConsecutiveTrackedSnapshots times in a row. */
+	bool GetTrackedCorners(
+		const FString & calibrationID,
+		int width,
+		int height,
+		int maxConsecutiveTrackedSnapshots,
+		TArray<float> & outputCorners);
+
+	/* Store the corners found in a calibration's snapshot either by tracking or by a full detection. */
+	void SetTrackedCorners(
+		const FString & calibrationID,
+		int width,
+		int height,
+		const TArray<float> & corners,
+		bool tracked);
+
+	void ClearTrackedCorners(const FString & calibrationID);
 	void QueueTextureFileWorkUnit(const FString & jobID, FLensSolverTextureFileWorkUnit textureFileWorkUnit);
 	void QueueMediaStreamWorkUnit(const FMediaStreamWorkUnit mediaStreamWorkUnit);
 
@@ -19,6 +19,8 @@
 #include "CoreMinimal.h"
 #include "Engine.h"
 #include "Async/AsyncWork.h"
+#include "HAL/Event.h"
+#include "Templates/Atomic.h"
 #include "SolvedPoints.h"
 
 #include "JobInfo.h"
@@ -31,21 +33,64 @@ DECLARE_DELEGATE_OneParam(QueueFinishedJobOutputDel, FinishedJobQueueContainer)
 DECLARE_DELEGATE_RetVal(int, GetWorkLoadOutputDel)
 DECLARE_DELEGATE_RetVal(bool, IsClosingOutputDel)
 
+/* Per worker counters that the work distributor can query for diagnostics. */
+struct FLensSolverWorkerStats
+{
+	FString workerID;
+
+	/* The number of times this worker was woken up by a producer queuing work. */
+	int wakeupCount;
+
+	/* Time between work being queued to this idle worker and the worker waking up. */
+	float lastWakeupLatencyMS;
+	float averageWakeupLatencyMS;
+	float maxWakeupLatencyMS;
+
+	/* The number of ticks where the worker had work to process and how long it spent processing them. */
+	int processedTickCount;
+	float busyTimeMS;
+
+	/* Fraction of time since the worker started that it spent processing work. */
+	float utilisation;
+
+	/* Work units this worker took from busier peers and work units peers took from this worker. */
+	int stolenWorkUnitCount;
+	int lostWorkUnitCount;
+
+	FLensSolverWorkerStats()
+	{
+		wakeupCount = 0;
+		lastWakeupLatencyMS = 0.0f;
+		averageWakeupLatencyMS = 0.0f;
+		maxWakeupLatencyMS = 0.0f;
+		processedTickCount = 0;
+		busyTimeMS = 0.0f;
+		utilisation = 0.0f;
+		stolenWorkUnitCount = 0;
+		lostWorkUnitCount = 0;
+	}
+};
+
+DECLARE_DELEGATE_RetVal(FLensSolverWorkerStats, GetWorkerStatsOutputDel)
+
 struct FLensSolverWorkerParameters 
 {
 	QueueLogOutputDel * inputQueueLogOutputDel;
 	IsClosingOutputDel * inputIsClosingOutputDel;
 	GetWorkLoadOutputDel * inputGetWorkOutputLoadDel;
+	GetWorkerStatsOutputDel * inputGetWorkerStatsOutputDel;
 	FString inputWorkerID;
 
 	FLensSolverWorkerParameters(
 		QueueLogOutputDel* inQueueLogOutputDel,
 		IsClosingOutputDel* inIsClosingOutputDel,
 		GetWorkLoadOutputDel* inGetWorkOutputLoadDel,
+		GetWorkerStatsOutputDel* inGetWorkerStatsOutputDel,
 		FString inWorkerID) :
 		inputQueueLogOutputDel(inQueueLogOutputDel),
 		inputIsClosingOutputDel(inIsClosingOutputDel),
 		inputGetWorkOutputLoadDel(inGetWorkOutputLoadDel),
+		inputGetWorkerStatsOutputDel(inGetWorkerStatsOutputDel),
 		inputWorkerID(inWorkerID)
 	{
 	}
@@ -64,7 +109,18 @@ private:
 	FCriticalSection threadLock;
 
 	FString workerID;
-	bool flagToExit;
+	TAtomic<bool> flagToExit;
+
+	/* Signaled by producers when work is queued so an idle worker wakes up immediately instead of polling. */
+	FEvent * workEvent;
+
+	/* Is the worker currently blocked on the work event, and when was it signaled while blocked. These are
+	atomics so that producers can signal the worker without taking the lock in the enqueue hot path. */
+	TAtomic<bool> isWaitingForWork;
+	TAtomic<uint64> workSignaledCycles;
+
+	/* When DoWork started, used to calculate utilisation. */
+	uint64 startCycles;
 
 	QueueLogOutputDel* queueLogOutputDel;
 	IsClosingOutputDel * isClosingOutputDel;
@@ -72,10 +128,15 @@ private:
 
 	bool Exit ();
 
+	/* Block until work is signaled or the idle timeout elapses, then record how long the wakeup took. */
+	void WaitForWork();
+
+	FLensSolverWorkerStats GetWorkerStats();
+
 public:
 	static FString JobDataToString(const FBaseParameters & baseParameters);
 	FLensSolverWorker(FLensSolverWorkerParameters & inputParameters);
-	virtual ~FLensSolverWorker() {};
+	virtual ~FLensSolverWorker();
 
 	FORCEINLINE TStatId GetStatId() const
 	{
@@ -86,10 +147,16 @@ public:
 
 	void DoWork();
 
+	/* Workers executing task graph tasks never run DoWork, so they are flagged to exit and de-initialized with this instead. */
+	void ExitTaskExecutor();
+
 protected:
 
 	const FString calibrationVisualizationOutputPath;
 	const FString workerMessage;
+
+	/* Diagnostics for this worker, access between Lock and Unlock. */
+	FLensSolverWorkerStats workerStats;
 	
 	bool ShouldExit();
 	bool Debug();
@@ -103,7 +170,13 @@ protected:
 	/* Queue log message to main thread so that it can be dequeued and printed to the console on the main thread. */
 	void QueueLog(FString log);
 
+	/* Wake up the worker thread, derived classes call this after queuing work. */
+	void NotifyWork();
+
 	virtual void Tick() {};
 	virtual int GetWorkLoad() { return 0; };
+
+	/* Whether Tick has anything to process, by default this is whether we have any work load. */
+	virtual bool IsReadyToTick() { return GetWorkLoad() > 0; };
 	virtual void NotifyShutdown () {};
 };
\ No newline at end of file
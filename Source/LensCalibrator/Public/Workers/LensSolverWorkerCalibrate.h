@@ -30,7 +30,6 @@ public:
 
 	FLensSolverWorkerCalibrate(
 		FLensSolverWorkerParameters & inputParameters,
-		QueueCalibrateWorkUnitInputDel* inputQueueCalibrateWorkUnitDel,
 		QueueLatchInputDel* inputSignalLatch,
 		QueueCalibrationResultOutputDel* inputOnSolvePointsDel);
 
@@ -38,14 +37,31 @@ public:
 	{
 	};
 
+	/* Calibrate on the calling thread, used by Tick and by task graph tasks. */
+	void Calibrate(const FCalibrateLatch & latchData);
+
+	/* Describe a view of the calibration pattern by it's position, size, tilt and rotation in the image. */
+	static TArray<float> DescribeView(
+		const FLensSolverCalibrationPointsWorkUnit & calibrateWorkUnit,
+		int cornerCountX,
+		int cornerCountY);
+
+	/* Greedily pick the maxViewCount views farthest from the views already picked, starting with the largest view. 
+	The indices of the picked views are output in the order the views were captured. */
+	static void SelectDiverseViews(
+		const TArray<FLensSolverCalibrationViewPtr> & views,
+		int cornerCountX,
+		int cornerCountY,
+		int maxViewCount,
+		TArray<int> & outputSelectedViews);
+
 private:
+	/* The number of latches queued or being solved. */
 	mutable int workUnitCount;
 
-	QueueCalibrateWorkUnitInputDel* queueCalibrateWorkUnitDel;
 	QueueLatchInputDel* signalLatch;
 	const QueueCalibrationResultOutputDel * onSolvePointsDel;
 
-	TMap<FString, TQueue<FLensSolverCalibrationPointsWorkUnit>*> workQueue;
 	TQueue<FCalibrateLatch, EQueueMode::Mpsc> latchQueue;
 
 	FMatrix GeneratePerspectiveMatrixFromFocalLength(const FIntPoint& imageSize, const FVector2D& principlePoint, const float focalLength);
@@ -57,8 +73,9 @@ private:
 	void QueueLatch(const FCalibrateLatch latchData);
 	void DequeueLatch(FCalibrateLatch & latchDataPtr);
 
-	bool DequeueAllWorkUnits(
-		const FString calibrationID, 
+	/* Check the latch's views were found with the same calibration pattern and pack the corners of the views to solve with. */
+	bool GatherCorners(
+		const FCalibrateLatch & latchData,
 		TArray<float> & corners,
 		int & cornerCountX, int & cornerCountY,
 		float & chessboardSquareSizeMM,
@@ -66,10 +83,9 @@ private:
 
 	bool LatchInQueue();
 
-	void QueueWorkUnit(FLensSolverCalibrationPointsWorkUnit calibrateWorkUnit);
-
 protected:
 	virtual void Tick() override;
 	virtual int GetWorkLoad() override;
+	virtual bool IsReadyToTick() override;
 	virtual void NotifyShutdown () override;
 };
\ No newline at end of file
@@ -17,11 +17,16 @@
 
 #include "CoreMinimal.h"
 #include "CoreTypes.h"
+#include "Templates/Atomic.h"
 #include "LensSolverWorker.h"
+#include "LensSolverBoundedQueue.h"
 
-DECLARE_DELEGATE_OneParam(QueueTextureFileWorkUnitInputDel, FLensSolverTextureFileWorkUnit)
-DECLARE_DELEGATE_OneParam(QueuePixelArrayWorkUnitInputDel, FLensSolverPixelArrayWorkUnit)
+DECLARE_DELEGATE_RetVal_OneParam(bool, QueueTextureFileWorkUnitInputDel, FLensSolverTextureFileWorkUnit)
+DECLARE_DELEGATE_RetVal_OneParam(bool, QueuePixelArrayWorkUnitInputDel, FLensSolverPixelArrayWorkUnit)
 DECLARE_DELEGATE_OneParam(QueueFindCornerResultOutputDel, FLensSolverCalibrationPointsWorkUnit)
+DECLARE_DELEGATE_RetVal_OneParam(bool, StealTextureFileWorkUnitInputDel, FLensSolverTextureFileWorkUnit&)
+DECLARE_DELEGATE_RetVal_OneParam(bool, StealPixelArrayWorkUnitInputDel, FLensSolverPixelArrayWorkUnit&)
+DECLARE_DELEGATE_RetVal_OneParam(bool, StealFindCornersWorkUnitOutputDel, const FString)
 
 /* The purpose of this worker is to provide an parallel asynchronous method of solving 
 for the corners in a calibration pattern. */
@@ -33,26 +38,79 @@ public:
 		FLensSolverWorkerParameters & inputParameters,
 		QueueTextureFileWorkUnitInputDel* inputQueueTextureFileWorkUnitInputDel,
 		QueuePixelArrayWorkUnitInputDel* inputQueuePixelArrayWorkUnitInputDel,
-		QueueFindCornerResultOutputDel* inputQueueFindCornerResultOutputDel);
+		StealTextureFileWorkUnitInputDel* inputStealTextureFileWorkUnitInputDel,
+		StealPixelArrayWorkUnitInputDel* inputStealPixelArrayWorkUnitInputDel,
+		QueueFindCornerResultOutputDel* inputQueueFindCornerResultOutputDel,
+		StealFindCornersWorkUnitOutputDel* inputStealFindCornersWorkUnitOutputDel);
 
 	~FLensSolverWorkerFindCorners() {};
 
+	/* Process a single work unit on the calling thread, used by Tick and by task graph tasks. */
+	void ProcessTextureFileWorkUnit(FLensSolverTextureFileWorkUnit & textureFileWorkUnit);
+	void ProcessPixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit);
+
 private:
-	mutable int workUnitCount;
+	TAtomic<int32> workUnitCount;
 
-	TQueue<FLensSolverPixelArrayWorkUnit, EQueueMode::Mpsc> pixelArrayWorkQueue;
-	TQueue<FLensSolverTextureFileWorkUnit, EQueueMode::Mpsc> textureFileWorkQueue;
+	/* Bounded lock free work queues, this worker and idle peers stealing work both dequeue from them. */
+	TLensSolverBoundedQueue<FLensSolverPixelArrayWorkUnit> pixelArrayWorkQueue;
+	TLensSolverBoundedQueue<FLensSolverTextureFileWorkUnit> textureFileWorkQueue;
 
 	FResizeParameters CalculateResizeParameters (const FChessboardSearchParameters & textureSearchParameters);
 
+	/* Search the whole image at the resolution of the pixels. */
+	bool FindCorners(
+		FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+		const FResizeParameters & resizeParameters,
+		TArray<float> & corners);
+
+	/* Search a downscaled copy of the pixels, then refine the corners in the full resolution pixels. If any 
+	corner fails to refine the image is searched again at full resolution with FindCorners. */
+	bool FindCornersCoarseToFine(
+		FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+		const FResizeParameters & resizeParameters,
+		TArray<float> & corners);
+
+	/* Refine the corners found in the previous snapshot of the same calibration in these pixels, returns false if tracking was lost. */
+	bool TrackCorners(
+		FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+		const FResizeParameters & resizeParameters,
+		TArray<float> & corners);
+
+	/* Returns false if the pixels can't contain the calibration pattern and the corner search can be skipped. */
+	bool PassesPrefilter(
+		const FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+		const FResizeParameters & resizeParameters);
+
+	/* Corner refinement works on a single channel, returns the pixels themselves if they are already grayscale. */
+	FLensSolverPixelBufferPtr GetGrayscalePixels(
+		const FLensSolverPixelArrayWorkUnit & texturePixelArrayUnit,
+		int width,
+		int height);
+
 	QueueTextureFileWorkUnitInputDel* queueTextureFileWorkUnitInputDel;
 	QueuePixelArrayWorkUnitInputDel* queuePixelArrayWorkUnitInputDel;
 	const QueueFindCornerResultOutputDel* queueFindCornerResultOutputDel;
+	const StealFindCornersWorkUnitOutputDel* stealFindCornersWorkUnitOutputDel;
+
+	bool DequeueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit);
+	bool DequeuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & workUnit);
+	/* Returns false if the work queue is full. */
+	bool QueueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit workUnit);
+	bool QueuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit workUnit);
+
+	/* Called by the work distributor on behalf of an idle peer to take the oldest work unit from this worker. */
+	bool StealTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit);
+	bool StealPixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit& workUnit);
+
+	/* Ask the work distributor to move a work unit from the busiest peer to this worker. */
+	bool StealWorkUnitFromPeer();
 
-	void DequeueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit& workUnit);
-	void DequeuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit & workUnit);
-	void QueueTextureFileWorkUnit(FLensSolverTextureFileWorkUnit workUnit);
-	void QueuePixelArrayWorkUnit(FLensSolverPixelArrayWorkUnit workUnit);
+	void QueueFoundCorners(
+		const FBaseParameters & baseParameters,
+		const FChessboardSearchParameters & textureSearchParameters,
+		const FResizeParameters & resizeParameters,
+		const TArray<float> & corners);
 
 	void QueueCalibrationPointsWorkUnit(const FLensSolverCalibrationPointsWorkUnit & calibrationPointsWorkUnit);
 	void QueueEmptyCalibrationPointsWorkUnit(const FBaseParameters & baseParameters, const FResizeParameters & resizeParameters);
@@ -61,5 +119,6 @@ protected:
 
 	virtual void Tick() override;
 	virtual int GetWorkLoad() override;
+	virtual bool IsReadyToTick() override;
 	virtual void NotifyShutdown () override;
 };
@@ -30,6 +30,7 @@ struct FWorkerInterfaceContainer
 
 	GetWorkLoadOutputDel getWorkLoadDel;
 	IsClosingOutputDel isClosingDel;
+	GetWorkerStatsOutputDel getWorkerStatsDel;
 };
 
 struct FWorkerFindCornersInterfaceContainer
@@ -39,6 +40,9 @@ struct FWorkerFindCornersInterfaceContainer
 
 	QueuePixelArrayWorkUnitInputDel queuePixelArrayWorkUnitInputDel;
 	QueueTextureFileWorkUnitInputDel queueTextureFileWorkUnitInputDel;
+
+	StealPixelArrayWorkUnitInputDel stealPixelArrayWorkUnitInputDel;
+	StealTextureFileWorkUnitInputDel stealTextureFileWorkUnitInputDel;
 };
 
 struct FWorkerCalibrateInterfaceContainer
@@ -47,5 +51,4 @@ struct FWorkerCalibrateInterfaceContainer
 	FWorkerInterfaceContainer baseContainer;
 
 	QueueLatchInputDel signalLatch;
-	QueueCalibrateWorkUnitInputDel queueCalibrateWorkUnitDel;
 };